@@ -0,0 +1,370 @@
+#include <benchmark.h>
+
+#include <core/window_frame.h>
+#include <core/job_system.h>
+#include <core/render_thread.h>
+#include <graphics/renderer.h>
+#include <graphics/gl_state_cache.h>
+#include <graphics/program_binary_cache.h>
+#include <graphics/gpu_memory_tracker.h>
+#include <graphics/frustum_culler.h>
+#include <util/frame_stats.h>
+#include <util/logging_system.h>
+#include <util/formatted_exception.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace BenchmarkParams
+{
+    // The size of the window (or offscreen surface) which the scene is rendered into.
+    constexpr int windowWidth = 1280, windowHeight = 720;
+
+    // The distance between neighbouring objects in the scene's grid.
+    constexpr float objectSpacing = 2.0f;
+
+    // The height of the camera above the scene, as a fraction of the scene's radius.
+    constexpr float cameraHeightFactor = 0.5f;
+
+    // The number of times the culling batch is culled with each thread count, the median time is reported.
+    constexpr uint32_t cullingSampleCount = 15;
+
+    // The half size of the cube which the culling boxes are scattered through.
+    constexpr float cullingVolumeExtent = 500.0f;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Benchmark::Benchmark(const Config& config) :
+    m_config(config), m_sceneCentre(0.0f), m_sceneRadius(1.0f), m_jobScalingResults(nlohmann::json::array())
+{}
+
+void Benchmark::CreateScene()
+{
+    const uint32_t gridSize = std::max(1u, (uint32_t)std::ceil(std::sqrt((double)m_config.m_objectCount)));
+    const float gridExtent = (float)(gridSize - 1) * BenchmarkParams::objectSpacing;
+
+    m_sceneCentre = { gridExtent * 0.5f, 0.0f, -gridExtent * 0.5f };
+    m_sceneRadius = std::max(gridExtent * 0.75f, 5.0f);
+
+    m_sceneGeometry.clear();
+    m_sceneGeometry.reserve(m_config.m_objectCount);
+
+    for (uint32_t objectIndex = 0; objectIndex < m_config.m_objectCount; objectIndex++)
+    {
+        Geometry::Transform transform;
+        transform.m_position = { (float)(objectIndex % gridSize) * BenchmarkParams::objectSpacing, 0.0f,
+            -(float)(objectIndex / gridSize) * BenchmarkParams::objectSpacing };
+
+        // Give each object a different color so that merged draws still have to change the per-object uniforms
+        Geometry::Material material;
+        material.m_diffuseColor = { 0.3f + 0.7f * (float)((objectIndex * 37) % 101) / 100.0f, 
+            0.3f + 0.7f * (float)((objectIndex * 59) % 103) / 102.0f, 0.3f + 0.7f * (float)((objectIndex * 83) % 107) / 106.0f, 1.0f };
+
+        switch (objectIndex % 3)
+        {
+        case 0:
+            m_sceneGeometry.push_back(std::make_unique<Square>(transform, material));
+            break;
+        case 1:
+            m_sceneGeometry.push_back(std::make_unique<Triangle>(transform, material));
+            break;
+        default:
+            m_sceneGeometry.push_back(std::make_unique<Circle>(transform, material));
+            break;
+        }
+    }
+}
+
+void Benchmark::PlaceCamera(Camera3D& camera, float pathFraction) const
+{
+    const float angle = glm::radians(pathFraction * 360.0f);
+    const glm::vec3 position = m_sceneCentre + glm::vec3(std::cos(angle) * m_sceneRadius, 
+        m_sceneRadius * BenchmarkParams::cameraHeightFactor, std::sin(angle) * m_sceneRadius);
+
+    const glm::vec3 direction = glm::normalize(m_sceneCentre - position);
+    camera.SetPosition(position);
+    camera.SetRotation(glm::degrees(std::atan2(direction.z, direction.x)), glm::degrees(std::asin(direction.y)));
+}
+
+void Benchmark::MeasureJobScaling()
+{
+    // Scatter the boxes through a cube around the camera, so that some are culled and some aren't
+    FrustumCuller culler;
+    std::mt19937 randomEngine(1234);
+    std::uniform_real_distribution<float> centreDistribution(-BenchmarkParams::cullingVolumeExtent, 
+        BenchmarkParams::cullingVolumeExtent);
+    std::uniform_real_distribution<float> extentDistribution(0.5f, 2.0f);
+
+    for (uint32_t boxIndex = 0; boxIndex < m_config.m_cullingBoxCount; boxIndex++)
+    {
+        const glm::vec3 centre = { centreDistribution(randomEngine), centreDistribution(randomEngine), centreDistribution(randomEngine) };
+        const glm::vec3 extents = glm::vec3(extentDistribution(randomEngine));
+        culler.AddBoundingBox({ centre - extents, centre + extents });
+    }
+
+    Camera3D camera({ 0.0f, 0.0f, 0.0f }, { (float)BenchmarkParams::windowWidth, (float)BenchmarkParams::windowHeight });
+    camera.SetClipPlanes(0.1f, BenchmarkParams::cullingVolumeExtent * 2.0f);
+    const std::array<glm::vec4, 6> planes = camera.ComputeFrustumPlanes();
+
+    // Measure with each power of two number of threads, up to and including the number of hardware threads
+    const uint32_t hardwareThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threadCount = 1; threadCount < hardwareThreadCount; threadCount *= 2)
+        threadCounts.push_back(threadCount);
+
+    threadCounts.push_back(hardwareThreadCount);
+
+    double singleThreadMilliseconds = 0.0;
+    for (uint32_t threadCount : threadCounts)
+    {
+        // With the job system shut down, the culling runs entirely on the calling thread
+        JobSystem::GetInstance().Shutdown();
+        if (threadCount > 1)
+            JobSystem::GetInstance().Init(threadCount - 1);
+
+        culler.Cull(planes); // Warm up the caches and wake the workers
+
+        std::vector<double> samples;
+        for (uint32_t sampleIndex = 0; sampleIndex < BenchmarkParams::cullingSampleCount; sampleIndex++)
+        {
+            culler.Cull(planes);
+            samples.push_back(culler.GetLastStatistics().m_elapsedMilliseconds);
+        }
+
+        const double medianMilliseconds = Benchmark::ComputePercentile(samples, 0.5);
+        if (threadCount == 1)
+            singleThreadMilliseconds = medianMilliseconds;
+
+        const double speedup = medianMilliseconds > 0.0 ? singleThreadMilliseconds / medianMilliseconds : 0.0;
+        m_jobScalingResults.push_back({ { "threads", threadCount }, { "medianCullMs", medianMilliseconds }, { "speedup", speedup } });
+
+        LoggingSystem::GetInstance().Output("Culled %u boxes with %u threads in %.3f ms (%.2fx).", LoggingSystem::Severity::INFO,
+            m_config.m_cullingBoxCount, threadCount, medianMilliseconds, speedup);
+    }
+
+    JobSystem::GetInstance().Shutdown();
+}
+
+double Benchmark::ComputePercentile(std::vector<double> values, double percentile)
+{
+    if (values.empty())
+        return 0.0;
+
+    // Nearest-rank percentile
+    const size_t rank = (size_t)std::ceil(percentile * values.size());
+    const size_t index = std::min(values.size() - 1, rank > 0 ? rank - 1 : 0);
+
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+nlohmann::json Benchmark::SummarizeDurations(const std::vector<double>& milliseconds)
+{
+    double totalMilliseconds = 0.0;
+    for (double duration : milliseconds)
+        totalMilliseconds += duration;
+
+    const double meanMilliseconds = milliseconds.empty() ? 0.0 : totalMilliseconds / milliseconds.size();
+
+    return {
+        { "meanMs", meanMilliseconds },
+        { "p50Ms", Benchmark::ComputePercentile(milliseconds, 0.50) },
+        { "p95Ms", Benchmark::ComputePercentile(milliseconds, 0.95) },
+        { "p99Ms", Benchmark::ComputePercentile(milliseconds, 0.99) },
+        { "maxMs", milliseconds.empty() ? 0.0 : *std::max_element(milliseconds.begin(), milliseconds.end()) }
+    };
+}
+
+void Benchmark::Run()
+{
+    WindowFrame::InitLibrary(m_config.m_headless);
+
+    {
+        WindowFrame window("Motorway Benchmark", { BenchmarkParams::windowWidth, BenchmarkParams::windowHeight }, false, false, false,
+            m_config.m_headless);
+
+        window.SetContextActive();
+
+        const std::string openGLVersion = window.GetOpenGLVersion();
+        const std::string openGLRenderer = (const char*)glGetString(GL_RENDERER);
+        LoggingSystem::GetInstance().Output("Benchmarking on %s (OpenGL %s).", LoggingSystem::Severity::INFO, openGLRenderer.c_str(),
+            openGLVersion.c_str());
+
+        if (m_config.m_measureJobScaling)
+            this->MeasureJobScaling();
+
+        // Everything which creates GPU resources has to be done before the render thread takes the OpenGL context
+        JobSystem::GetInstance().Init();
+        Renderer::GetInstance().Init();
+        this->CreateScene();
+
+        Camera3D camera({ 0.0f, 0.0f, 0.0f }, { (float)BenchmarkParams::windowWidth, (float)BenchmarkParams::windowHeight });
+        camera.SetClipPlanes(0.1f, m_sceneRadius * 4.0f);
+
+        const uint32_t totalFrameCount = m_config.m_warmupFrameCount + m_config.m_frameCount;
+        m_frameMilliseconds.clear();
+        m_frameMilliseconds.reserve(m_config.m_frameCount);
+        m_renderedFrames.assign((size_t)totalFrameCount + 1, RenderedFrame());
+
+        RenderThread renderThread;
+        renderThread.Start(window, [this](const FramePacket& packet)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+
+            Renderer::GetInstance().RenderPacket(packet);
+            Renderer::GetInstance().EndFrame();
+            GLStateCache::GetInstance().EndFrame();
+
+            if (packet.m_frameIndex < m_renderedFrames.size())
+            {
+                RenderedFrame& renderedFrame = m_renderedFrames[packet.m_frameIndex];
+                renderedFrame.m_renderMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - 
+                    startTime).count();
+                renderedFrame.m_submittedDraws = Renderer::GetInstance().GetLastFrameStatistics().m_submittedDraws;
+                renderedFrame.m_drawCalls = Renderer::GetInstance().GetLastFrameStatistics().m_drawCalls;
+                renderedFrame.m_culledCount = Renderer::GetInstance().GetCullingStatistics().m_culledCount;
+            }
+        });
+
+        // Record every frame along the camera path, the render thread renders each one while the next is being recorded
+        auto previousFrameTime = std::chrono::steady_clock::now();
+        for (uint32_t frameIndex = 0; frameIndex < totalFrameCount; frameIndex++)
+        {
+            this->PlaceCamera(camera, (float)frameIndex / (float)totalFrameCount);
+
+            FramePacket& packet = renderThread.BeginPacket();
+            packet.m_camera = camera;
+            packet.m_clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+
+            for (const std::unique_ptr<Geometry>& geometry : m_sceneGeometry)
+                packet.AddDraw(*geometry);
+
+            renderThread.SubmitPacket();
+
+            const auto currentFrameTime = std::chrono::steady_clock::now();
+            if (frameIndex >= m_config.m_warmupFrameCount)
+            {
+                m_frameMilliseconds.push_back(std::chrono::duration<double, std::milli>(currentFrameTime - previousFrameTime).count());
+                FrameStats::GetInstance().EndFrame((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    currentFrameTime - previousFrameTime).count());
+            }
+
+            previousFrameTime = currentFrameTime;
+        }
+
+        renderThread.Stop();
+        JobSystem::GetInstance().Shutdown();
+
+        // Gather the render thread's measurements of the frames after the warmup (packet indices start from 1)
+        std::vector<double> renderMilliseconds;
+        double totalSubmittedDraws = 0.0, totalDrawCalls = 0.0, totalCulled = 0.0;
+
+        for (size_t packetIndex = (size_t)m_config.m_warmupFrameCount + 1; packetIndex < m_renderedFrames.size(); packetIndex++)
+        {
+            const RenderedFrame& renderedFrame = m_renderedFrames[packetIndex];
+            renderMilliseconds.push_back(renderedFrame.m_renderMilliseconds);
+            totalSubmittedDraws += renderedFrame.m_submittedDraws;
+            totalDrawCalls += renderedFrame.m_drawCalls;
+            totalCulled += renderedFrame.m_culledCount;
+        }
+
+        const double measuredFrameCount = std::max<double>(1.0, (double)renderMilliseconds.size());
+
+        nlohmann::json hitches = nlohmann::json::object();
+        for (uint32_t subsystemIndex = 0; subsystemIndex < (uint32_t)FrameStats::Subsystem::COUNT; subsystemIndex++)
+        {
+            const FrameStats::Subsystem subsystem = (FrameStats::Subsystem)subsystemIndex;
+            hitches[FrameStats::GetSubsystemName(subsystem)] = FrameStats::GetInstance().GetHitchCount(subsystem);
+        }
+
+        double totalFrameMilliseconds = 0.0;
+        for (double duration : m_frameMilliseconds)
+            totalFrameMilliseconds += duration;
+
+        const nlohmann::json results =
+        {
+            { "config", {
+                { "frames", m_config.m_frameCount },
+                { "warmupFrames", m_config.m_warmupFrameCount },
+                { "objects", m_config.m_objectCount },
+                { "headless", m_config.m_headless },
+                { "jobThreads", std::max(1u, std::thread::hardware_concurrency()) },
+                { "glRenderer", openGLRenderer },
+                { "glVersion", openGLVersion }
+            } },
+            { "frameTime", Benchmark::SummarizeDurations(m_frameMilliseconds) },
+            { "averageFps", totalFrameMilliseconds > 0.0 ? (1000.0 * m_frameMilliseconds.size()) / totalFrameMilliseconds : 0.0 },
+            { "renderThreadTime", Benchmark::SummarizeDurations(renderMilliseconds) },
+            { "draws", {
+                { "meanSubmitted", totalSubmittedDraws / measuredFrameCount },
+                { "meanCulled", totalCulled / measuredFrameCount },
+                { "meanDrawCalls", totalDrawCalls / measuredFrameCount }
+            } },
+            { "hitches", hitches },
+            { "shaderBinaryCache", {
+                { "supported", ProgramBinaryCache::GetInstance().IsSupported() },
+                { "hits", ProgramBinaryCache::GetInstance().GetStatistics().m_hitCount },
+                { "misses", ProgramBinaryCache::GetInstance().GetStatistics().m_missCount },
+                { "savedMs", ProgramBinaryCache::GetInstance().GetStatistics().m_secondsSaved * 1000.0 }
+            } },
+            { "gpuMemory", {
+                { "textureBytes", GPUMemoryTracker::GetInstance().GetAllocatedSize(GPUMemoryTracker::Category::TEXTURE) },
+                { "bufferBytes", GPUMemoryTracker::GetInstance().GetAllocatedSize(GPUMemoryTracker::Category::BUFFER) }
+            } },
+            { "jobScaling", m_jobScalingResults }
+        };
+
+        std::ofstream outputFile(m_config.m_outputFilePath);
+        if (!outputFile)
+            throw FormattedException("Failed to open the benchmark output file at path: %s.", m_config.m_outputFilePath.c_str());
+
+        outputFile << results.dump(4) << std::endl;
+
+        LoggingSystem::GetInstance().Output("Rendered %u frames of %u objects, p50 %.2f ms, p99 %.2f ms. Results written to: %s", 
+            LoggingSystem::Severity::INFO, m_config.m_frameCount, m_config.m_objectCount, results["frameTime"]["p50Ms"].get<double>(),
+            results["frameTime"]["p99Ms"].get<double>(), m_config.m_outputFilePath.c_str());
+
+        m_sceneGeometry.clear();
+    }
+
+    glfwTerminate();
+}
+
+Benchmark::Config Benchmark::ParseArguments(int argc, char** argv)
+{
+    Config config;
+
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const char* argument = argv[argIndex];
+        const bool hasValue = argIndex + 1 < argc;
+
+        if (std::strcmp(argument, "--frames") == 0 && hasValue)
+            config.m_frameCount = (uint32_t)std::stoul(argv[++argIndex]);
+        else if (std::strcmp(argument, "--warmup") == 0 && hasValue)
+            config.m_warmupFrameCount = (uint32_t)std::stoul(argv[++argIndex]);
+        else if (std::strcmp(argument, "--objects") == 0 && hasValue)
+            config.m_objectCount = (uint32_t)std::stoul(argv[++argIndex]);
+        else if (std::strcmp(argument, "--culling-boxes") == 0 && hasValue)
+            config.m_cullingBoxCount = (uint32_t)std::stoul(argv[++argIndex]);
+        else if (std::strcmp(argument, "--output") == 0 && hasValue)
+            config.m_outputFilePath = argv[++argIndex];
+        else if (std::strcmp(argument, "--windowed") == 0)
+            config.m_headless = false;
+        else if (std::strcmp(argument, "--no-job-scaling") == 0)
+            config.m_measureJobScaling = false;
+        else
+            throw FormattedException("Unknown or incomplete benchmark argument: %s", argument);
+    }
+
+    return config;
+}
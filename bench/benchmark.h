@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <graphics/geometry.h>
+#include <graphics/camera_3d.h>
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Renders a generated scene of simple geometry along a scripted camera path for a fixed number of frames, and measures how long
+// the frames took. The job system's scaling is measured as well, by frustum culling a large batch of boxes with different 
+// numbers of threads. The results are written to a JSON file so that they can be compared between builds and machines.
+class Benchmark
+{
+public:
+	struct Config
+	{
+		uint32_t m_frameCount = 600;
+		uint32_t m_warmupFrameCount = 30; // Frames rendered before the measurements start, these aren't counted
+		uint32_t m_objectCount = 10000;
+		uint32_t m_cullingBoxCount = 1000000; // The number of boxes culled when measuring the job system's scaling
+		bool m_headless = true;
+		bool m_measureJobScaling = true;
+		std::string m_outputFilePath = "bench_results.json";
+	};
+private:
+	// The measurements taken on the render thread for a single frame.
+	struct RenderedFrame
+	{
+		double m_renderMilliseconds = 0.0;
+		uint32_t m_submittedDraws = 0, m_drawCalls = 0, m_culledCount = 0;
+	};
+
+	Config m_config;
+	std::vector<std::unique_ptr<Geometry>> m_sceneGeometry;
+	glm::vec3 m_sceneCentre;
+	float m_sceneRadius;
+
+	std::vector<double> m_frameMilliseconds;
+	std::vector<RenderedFrame> m_renderedFrames; // Indexed by frame packet index, only written by the render thread
+	nlohmann::json m_jobScalingResults;
+
+	// Fills the scene with the configured number of objects, laid out in a grid.
+	void CreateScene();
+
+	// Sets the camera's position and direction for the frame at the given fraction (between 0 and 1) of the way along the path.
+	// The camera circles the scene, looking down at its centre.
+	void PlaceCamera(Camera3D& camera, float pathFraction) const;
+
+	// Measures how long frustum culling a batch of boxes takes with the job system running on different numbers of threads.
+	void MeasureJobScaling();
+
+	// Returns the given percentile (between 0 and 1) of the values.
+	static double ComputePercentile(std::vector<double> values, double percentile);
+
+	// Returns the mean, percentiles and maximum of the given durations as a JSON object.
+	static nlohmann::json SummarizeDurations(const std::vector<double>& milliseconds);
+public:
+	explicit Benchmark(const Config& config);
+	~Benchmark() = default;
+
+	// Runs the benchmark, then writes the results to the configured output file.
+	void Run();
+
+	// Returns the configuration parsed from the given command line arguments.
+	// The arguments supported are: --frames N, --warmup N, --objects N, --culling-boxes N, --output PATH, --windowed and 
+	// --no-job-scaling.
+	static Config ParseArguments(int argc, char** argv);
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include <benchmark.h>
+
+#include <util/formatted_exception.h>
+#include <util/logging_system.h>
+#include <util/profiler.h>
+
+#include <GLFW/glfw3.h>
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		Profiler::GetInstance().SetThreadName("Main");
+
+		Benchmark benchmark(Benchmark::ParseArguments(argc, argv));
+		benchmark.Run();
+	}
+	catch (std::exception& e)
+	{
+		FormattedException* formattedException = dynamic_cast<FormattedException*>(&e); // Check if the exception thrown is formatted
+
+		if (formattedException)
+			LoggingSystem::GetInstance().Output(formattedException->what(), LoggingSystem::Severity::FATAL, formattedException->GetArgs());
+		else
+			LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::FATAL);
+
+		glfwTerminate();
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
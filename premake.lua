@@ -28,6 +28,10 @@ project "motorway"
     filter "system:macosx"
         defines "_PLATFORM_MACOSX"
 
+    -- Turn mismatched logging macro format strings and arguments into errors (MSVC checks them with /analyze instead)
+    filter "toolset:not msc*"
+        buildoptions { "-Werror=format" }
+
     -- Project settings with values unique to the Debug/Release configurations
     filter "configurations:debug"
         kind "ConsoleApp"
@@ -58,3 +62,141 @@ project "motorway"
             "copy libs\\irrklang\\bin\\win64\\ikpMP3.dll bin\\release\\ikpMP3.dll" }
 
 ------------------------------------------------------------------------------------------------------------------------------------------------
+
+project "motorway-bench"
+    filename "motorway-bench"
+    kind "ConsoleApp"
+    staticruntime "on"
+    language "C++"
+    cppdialect "C++17"
+
+    targetname "motorway-bench"
+    targetdir "bin/%{cfg.buildcfg}/"
+    objdir "objs/%{prj.name}/%{cfg.buildcfg}/"
+
+    includedirs { "bench", "src", "libs/glad/include", "libs/glfw/include", "libs/json/include", "libs/glm", "libs/stb", }
+
+    -- The benchmark shares all the engine's source files except for the game's entry point
+    files { "bench/**.h", "bench/**.cpp", "src/**.h", "src/**.cpp", "src/**.c", "src/**.tpp" }
+    removefiles { "src/main.cpp" }
+
+    -- Project platform define macro based on identified system
+    filter "system:windows"
+        defines "_PLATFORM_WINDOWS"
+
+    filter "system:macosx"
+        defines "_PLATFORM_MACOSX"
+
+    -- Turn mismatched logging macro format strings and arguments into errors (MSVC checks them with /analyze instead)
+    filter "toolset:not msc*"
+        buildoptions { "-Werror=format" }
+
+    -- The benchmark runs headless on Linux build machines, which need GLFW's X11/EGL dependencies linked explicitly
+    filter "system:linux"
+        links { "dl", "pthread", "X11" }
+
+    -- Project settings with values unique to the Debug/Release configurations
+    filter "configurations:debug"
+        libdirs { "libs/glfw/build/src/Debug", "libs/glfw/build/src" }
+        links { "glfw3" }
+
+        defines { "_DEBUG" }
+        symbols "On"
+
+    filter "configurations:release"
+        libdirs { "libs/glfw/build/src/Release", "libs/glfw/build/src" }
+        links { "glfw3" }
+
+        defines { "NDEBUG" }
+        optimize "Speed"
+
+------------------------------------------------------------------------------------------------------------------------------------------------
+
+project "motorway-pack"
+    filename "motorway-pack"
+    kind "ConsoleApp"
+    staticruntime "on"
+    language "C++"
+    cppdialect "C++17"
+
+    targetname "motorway-pack"
+    targetdir "bin/%{cfg.buildcfg}/"
+    objdir "objs/%{prj.name}/%{cfg.buildcfg}/"
+
+    includedirs { "src", "libs/stb", }
+
+    -- The pack builder only needs the asset pack format and the logging system
+    files { "tools/mpak/**.cpp", "src/util/asset_pack.h", "src/util/asset_pack.cpp", "src/util/asset_id.h", "src/util/stb_image.cpp",
+        "src/util/logging_system.h", "src/util/logging_system.cpp", "src/util/spsc_ring_buffer.h", "src/util/spsc_ring_buffer.tpp",
+        "src/util/formatted_exception.h", "src/util/formatted_exception.cpp", "src/util/time.h", "src/util/time.cpp" }
+
+    -- Project platform define macro based on identified system
+    filter "system:windows"
+        defines "_PLATFORM_WINDOWS"
+
+    filter "system:macosx"
+        defines "_PLATFORM_MACOSX"
+
+    filter "toolset:not msc*"
+        buildoptions { "-Werror=format" }
+
+    filter "system:linux"
+        links { "pthread" }
+
+    -- Project settings with values unique to the Debug/Release configurations
+    filter "configurations:debug"
+        defines { "_DEBUG" }
+        symbols "On"
+
+    filter "configurations:release"
+        defines { "NDEBUG" }
+        optimize "Speed"
+
+------------------------------------------------------------------------------------------------------------------------------------------------
+
+project "motorway-tests"
+    filename "motorway-tests"
+    kind "ConsoleApp"
+    staticruntime "on"
+    language "C++"
+    cppdialect "C++17"
+
+    targetname "motorway-tests"
+    targetdir "bin/%{cfg.buildcfg}/"
+    objdir "objs/%{prj.name}/%{cfg.buildcfg}/"
+
+    includedirs { "tests", "src", "libs/glad/include", "libs/glfw/include", "libs/json/include", "libs/glm", "libs/stb", }
+
+    -- The tests share all the engine's source files except for the game's entry point, none of them need a window
+    files { "tests/**.h", "tests/**.cpp", "src/**.h", "src/**.cpp", "src/**.c", "src/**.tpp" }
+    removefiles { "src/main.cpp" }
+
+    -- Project platform define macro based on identified system
+    filter "system:windows"
+        defines "_PLATFORM_WINDOWS"
+
+    filter "system:macosx"
+        defines "_PLATFORM_MACOSX"
+
+    filter "toolset:not msc*"
+        buildoptions { "-Werror=format" }
+
+    filter "system:linux"
+        links { "dl", "pthread", "X11" }
+
+    -- Project settings with values unique to the Debug/Release configurations
+    filter "configurations:debug"
+        libdirs { "libs/glfw/build/src/Debug", "libs/glfw/build/src" }
+        links { "glfw3" }
+
+        defines { "_DEBUG" }
+        symbols "On"
+
+    filter "configurations:release"
+        libdirs { "libs/glfw/build/src/Release", "libs/glfw/build/src" }
+        links { "glfw3" }
+
+        defines { "NDEBUG" }
+        optimize "Speed"
+
+------------------------------------------------------------------------------------------------------------------------------------------------
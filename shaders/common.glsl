@@ -0,0 +1,26 @@
+// Snippets shared by the shaders, included with #include "common.glsl"
+
+// Per-frame camera data shared by all shaders, see Renderer::CameraBlock
+layout (std140) uniform CameraBlock
+{
+    mat4 m_viewMatrix;
+    mat4 m_projectionMatrix;
+    mat4 m_viewProjectionMatrix;
+    vec4 m_position;
+    vec2 m_clipPlanes; // The near (x) and far (y) clipping plane distances
+} u_camera;
+
+// The scale which takes 16-bit signed normalized integers, passed to the shader unnormalized, to between -1 and 1
+const float snorm16Scale = 1.0f / 32767.0f;
+
+// Returns the unit vector encoded by projecting it onto an octahedron unfolded onto a square, see CookedMesh
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+
+    // Unfold the lower half of the octahedron, which was folded over the upper half
+    if (normal.z < 0.0f)
+        normal.xy = (1.0f - abs(normal.yx)) * vec2(normal.x >= 0.0f ? 1.0f : -1.0f, normal.y >= 0.0f ? 1.0f : -1.0f);
+
+    return normalize(normal);
+}
@@ -1,128 +1,1039 @@
 #include <core/asset_system.h>
+#include <core/job_system.h>
+#include <graphics/texture_array_builder.h>
 #include <util/logging_system.h>
 #include <util/formatted_exception.h>
+#include <util/frame_stats.h>
 
 #include <glad/glad.h>
 #include <stb_image.h>
 
-void AssetSystem::LoadShader(std::string_view nameID, std::string_view vshFilePath, std::string_view fshFilePath)
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include <exception>
+#include <iterator>
+
+namespace AssetSystemParams
 {
-    if (m_storedShaders.find(nameID.data()) == m_storedShaders.end()) // Make sure the ID given isn't already taken
-        m_storedShaders[nameID.data()] = std::make_shared<ShaderProgram>(vshFilePath, fshFilePath);
+    // The number of vertices and indices the geometry pool has space for when it is first created.
+    constexpr uint32_t initialPoolVertexCapacity = 65536;
+    constexpr uint32_t initialPoolIndexCapacity = 196608;
+
+    // The number of frames an asset has to go without being used before it can be evicted, which covers the frames that may 
+    // still be waiting to be rendered when it was last used.
+    constexpr uint64_t evictionFrameDelay = 4;
+}
+
+// Returns the number of bytes of the geometry pool taken up by the mesh.
+static size_t GetGeometrySize(const AssetSystem::GeometryData& geometryData)
+{
+    return (size_t)geometryData.m_allocation.m_vertexCount * geometryData.m_pool->GetVertexSize() + 
+        (size_t)geometryData.m_allocation.m_indexCount * geometryData.m_pool->GetIndexSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void AssetSystem::RegisterAssetName(std::string_view nameID)
+{
+#ifdef _DEBUG
+    auto nameIterator = m_assetNames.find(AssetID::Hash(nameID));
+    if (nameIterator != m_assetNames.end() && nameIterator->second != nameID)
+    {
+        throw FormattedException("The asset IDs \"%s\" and \"%s\" have the same hash.", nameIterator->second.c_str(), 
+            std::string(nameID).c_str());
+    }
+
+    m_assetNames[AssetID::Hash(nameID)] = std::string(nameID);
+#else
+    (void)nameID;
+#endif
+}
+
+void AssetSystem::MountPack(const std::string& filePath)
+{
+    m_mountedPacks.push_back(std::make_unique<AssetPack>(filePath));
+    LOG_INFO("Mounted the asset pack at path: %s, containing %llu files.", filePath.c_str(), 
+        (unsigned long long)m_mountedPacks.back()->GetEntryCount());
+}
+
+bool AssetSystem::FindPackedFile(std::string_view filePath, std::vector<uint8_t>& decompressedData, ByteView& data) const
+{
+    for (auto packIterator = m_mountedPacks.rbegin(); packIterator != m_mountedPacks.rend(); ++packIterator)
+    {
+        const AssetPack::Entry* entry = (*packIterator)->FindEntry(filePath);
+        if (entry)
+        {
+            data = (*packIterator)->GetData(*entry, decompressedData);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AssetSystem::LoadShader(std::string_view nameID, std::string_view vshFilePath, std::string_view fshFilePath, 
+    const std::vector<std::string>& featureDefines)
+{
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    const AssetID id(nameID);
+    RegisterAssetName(nameID);
+
+    if (!m_shaderSources.Find(id.GetHash())) // Make sure the ID given isn't already taken
+    {
+        if (featureDefines.size() > 32)
+            throw FormattedException("The shader \"%s\" has more than 32 feature defines.", std::string(nameID).c_str());
+
+        ShaderSource source;
+        source.m_vshFilePath = vshFilePath;
+        source.m_fshFilePath = fshFilePath;
+        source.m_featureDefines = featureDefines;
+        source.m_compiledFeatureMasks.push_back(0);
+
+        m_storedShaders.Insert(id.GetHash(), this->CompileShaderPermutation(source, 0));
+        m_shaderSources.Insert(id.GetHash(), source);
+    }
     else
     {
-        LoggingSystem::GetInstance().Output("Skipped shader load operation, the ID \"%s\" has already been used.",
-            LoggingSystem::Severity::WARNING, nameID.data());
+        LOG_WARNING("Skipped shader load operation, the ID \"%s\" has already been used.", nameID.data());
+    }
+}
+
+uint64_t AssetSystem::GetPermutationKey(AssetID id, uint32_t featureMask)
+{
+    // Spread the mask over the key's bits, so the keys of a shader's permutations are still well distributed
+    return id.GetHash() ^ ((uint64_t)featureMask * 0x9E3779B97F4A7C15ull);
+}
+
+ShaderProgramPtr AssetSystem::CompileShaderPermutation(const ShaderSource& source, uint32_t featureMask) const
+{
+    std::vector<std::string> defines;
+    for (uint32_t featureIndex = 0; featureIndex < source.m_featureDefines.size(); featureIndex++)
+    {
+        if (featureMask & (1u << featureIndex))
+            defines.push_back(source.m_featureDefines[featureIndex]);
     }
+
+    // Read the shader files (and the files they include) straight from the mapped packs if they contain them
+    const ShaderProgram::FileReader readFile = [this](const std::string& filePath)
+    {
+        std::vector<uint8_t> decompressedData;
+        ByteView data;
+
+        if (this->FindPackedFile(filePath, decompressedData, data))
+            return std::string(data.AsString());
+
+        return ShaderProgram::ReadFile(filePath);
+    };
+
+    return std::make_shared<ShaderProgram>(ShaderProgram::FromFiles(source.m_vshFilePath, source.m_fshFilePath, defines, readFile));
 }
 
 void AssetSystem::LoadTexture(std::string_view nameID, std::string_view imageFilePath, bool flipOnLoad, bool srgb)
 {
-    if (m_storedTextures.find(nameID.data()) == m_storedTextures.end()) // Check to make sure ID isn't already taken
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    const AssetID id(nameID);
+    RegisterAssetName(nameID);
+
+    if (!m_textureSources.Find(id.GetHash())) // Check to make sure ID isn't already taken, including by evicted textures
+    {
+        // Load the cooked texture of the image file, then setup and store the texture buffer
+        const CookedTexture image = this->LoadCookedTexture(std::string(imageFilePath), flipOnLoad, srgb);
+        m_storedTextures.Insert(id.GetHash(), std::make_shared<Texture2D>(image.CreateTexture()));
+        m_textureSources.Insert(id.GetHash(), { std::string(imageFilePath), flipOnLoad, srgb, m_frameIndex });
+    }
+    else
+    {
+        LOG_WARNING("Skipped texture image load operation, the ID \"%s\" has already been used.", nameID.data());
+    }
+}
+
+void AssetSystem::LoadTextureArray(std::string_view nameID, const std::vector<std::string>& imageFilePaths, bool flipOnLoad, 
+    bool srgb)
+{
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    const AssetID id(nameID);
+    RegisterAssetName(nameID);
+
+    if (m_storedTextureArrays.Find(id.GetHash())) // Check to make sure ID isn't already taken
+    {
+        LOG_WARNING("Skipped texture array load operation, the ID \"%s\" has already been used.", nameID.data());
+        return;
+    }
+
+    // Cook the layers in parallel, the exceptions of any which fail are kept to be thrown on this thread
+    std::vector<CookedTexture> layers(imageFilePaths.size());
+    std::vector<std::exception_ptr> layerErrors(imageFilePaths.size());
+
+    JobSystem::GetInstance().ParallelFor(imageFilePaths.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t layerIndex = begin; layerIndex < end; layerIndex++)
+        {
+            try
+            {
+                layers[layerIndex] = this->LoadCookedTexture(imageFilePaths[layerIndex], flipOnLoad, srgb);
+            }
+            catch (...)
+            {
+                layerErrors[layerIndex] = std::current_exception();
+            }
+        }
+    });
+
+    TextureArrayBuilder builder;
+    for (size_t layerIndex = 0; layerIndex < layers.size(); layerIndex++)
+    {
+        if (layerErrors[layerIndex])
+            std::rethrow_exception(layerErrors[layerIndex]);
+
+        builder.AddLayer(std::move(layers[layerIndex]), imageFilePaths[layerIndex]);
+    }
+
+    m_storedTextureArrays.Insert(id.GetHash(), std::make_shared<Texture2DArray>(builder.Build()));
+}
+
+Texture2DPtr AssetSystem::LoadTextureAsync(std::string_view nameID, std::string_view imageFilePath, bool flipOnLoad, bool srgb)
+{
+    const AssetID id(nameID);
+    RegisterAssetName(nameID);
+
+    if (m_textureSources.Find(id.GetHash())) // Check to make sure ID isn't already taken, including by evicted textures
+    {
+        LOG_WARNING("Skipped texture image load operation, the ID \"%s\" has already been used.", nameID.data());
+        return this->GetTexture(id);
+    }
+
+    const Texture2DPtr texture = this->QueueTextureLoad(std::string(imageFilePath), flipOnLoad, srgb);
+    m_storedTextures.Insert(id.GetHash(), texture);
+    m_textureSources.Insert(id.GetHash(), { std::string(imageFilePath), flipOnLoad, srgb, m_frameIndex });
+
+    return texture;
+}
+
+Texture2DPtr AssetSystem::QueueTextureLoad(const std::string& imageFilePath, bool flipOnLoad, bool srgb)
+{
+    // The texture buffers can only be created on the thread with the OpenGL context, so the texture starts off empty and its 
+    // placeholder is created by the next call to UploadPendingTextures()
+    Texture2DPtr texture = std::make_shared<Texture2D>();
+
+    {
+        std::lock_guard<std::mutex> lock(m_textureUploadMutex);
+        m_placeholderRequests.push_back(texture);
+    }
+
+    m_pendingTextureCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Without any workers the job would only run once something waits on the job system, so decode the image now instead
+    std::weak_ptr<Texture2D> weakTexture = texture;
+    if (JobSystem::GetInstance().GetThreadCount() > 1)
+    {
+        JobSystem::GetInstance().Submit([this, weakTexture, filePath = imageFilePath, flipOnLoad, srgb]()
+            { this->DecodeTexture(weakTexture, filePath, flipOnLoad, srgb); });
+    }
+    else
+        this->DecodeTexture(weakTexture, imageFilePath, flipOnLoad, srgb);
+
+    return texture;
+}
+
+void AssetSystem::DecodeTexture(std::weak_ptr<Texture2D> texture, const std::string& imageFilePath, bool flipOnLoad, bool srgb)
+{
+    PendingTextureUpload upload;
+    upload.m_texture = std::move(texture);
+
+    try
+    {
+        upload.m_image = this->LoadCookedTexture(imageFilePath, flipOnLoad, srgb);
+        upload.m_loaded = true;
+    }
+    catch (FormattedException& e)
+    {
+        // Jobs can't throw, so the failure is logged and the upload is queued without an image, leaving the placeholder
+        LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::WARNING, e.GetArgs());
+    }
+    catch (std::exception& e)
+    {
+        LOG_WARNING("Failed to load the texture image at path: %s, %s", imageFilePath.c_str(), e.what());
+    }
+
+    std::lock_guard<std::mutex> lock(m_textureUploadMutex);
+    m_loadedTextures.push_back(std::move(upload));
+}
+
+CookedTexture AssetSystem::LoadCookedTexture(const std::string& imageFilePath, bool flipOnLoad, bool srgb) const
+{
+    const bool compress = m_textureCompressionEnabled.load(std::memory_order_relaxed) && CookedTexture::IsCompressionSupported();
+    const std::string cookedFilePath = CookedTexture::GetCookedFilePath(imageFilePath);
+
+    // Look for the cooked texture and the image in the mounted packs first, a cooked texture in a pack is used in place
+    std::vector<uint8_t> packedCookedData, packedImageData;
+    ByteView packedCookedFile, packedImageFile;
+    const bool imagePacked = this->FindPackedFile(imageFilePath, packedImageData, packedImageFile);
+
+    if (this->FindPackedFile(cookedFilePath, packedCookedData, packedCookedFile))
+    {
+        // A corrupt cooked texture is cooked again from the image, the same as a corrupt cooked texture file below
+        try
+        {
+            CookedTexture cookedTexture = packedCookedData.empty() ? CookedTexture::FromView(packedCookedFile, cookedFilePath) :
+                CookedTexture::FromData(std::move(packedCookedData), cookedFilePath);
+
+            std::error_code error;
+            if ((!imagePacked && !std::filesystem::exists(imageFilePath, error)) || (cookedTexture.IsFlipped() == flipOnLoad && 
+                cookedTexture.IsSRGB() == srgb && (!cookedTexture.IsCompressed() || CookedTexture::IsCompressionSupported())))
+            {
+                return cookedTexture;
+            }
+        }
+        catch (FormattedException& e)
+        {
+            LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::WARNING, e.GetArgs());
+        }
+    }
+
+    // Use the cooked texture file if it's newer than the image, or if there's no image (when only cooked files are shipped)
+    std::error_code error;
+    if (!imagePacked && std::filesystem::exists(cookedFilePath, error))
+    {
+        const bool imageExists = std::filesystem::exists(imageFilePath, error);
+        if (!imageExists || 
+            std::filesystem::last_write_time(cookedFilePath, error) >= std::filesystem::last_write_time(imageFilePath, error))
+        {
+            try
+            {
+                CookedTexture cookedTexture = CookedTexture::Load(cookedFilePath);
+
+                // Cook it again if it was cooked with different settings, unless there's no image to cook it from
+                if (!imageExists || (cookedTexture.IsFlipped() == flipOnLoad && cookedTexture.IsSRGB() == srgb && 
+                    (!cookedTexture.IsCompressed() || CookedTexture::IsCompressionSupported())))
+                {
+                    return cookedTexture;
+                }
+            }
+            catch (FormattedException& e)
+            {
+                LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::WARNING, e.GetArgs());
+            }
+        }
+    }
+
+    // Decode the image file, the image loader's flip setting is global so images are flipped here instead to allow decoding on 
+    // several threads at once
+    int width = 0, height = 0, channels = 0;
+    const std::unique_ptr<uint8_t, ImageDeleter> pixels(imagePacked ? 
+        stbi_load_from_memory(packedImageFile.m_data, (int)packedImageFile.m_size, &width, &height, &channels, 0) :
+        stbi_load(imageFilePath.c_str(), &width, &height, &channels, 0));
+
+    if (!pixels) // Check that the image was loaded successfully
+        throw FormattedException("Failed to load the texture image at path: %s.", imageFilePath.c_str());
+
+    if (channels != 3 && channels != 4)
+        throw FormattedException("The channel format for the texture image at path: %s, is not supported.", imageFilePath.c_str());
+
+    if (flipOnLoad)
+    {
+        const size_t rowSize = (size_t)width * channels;
+        for (int row = 0; row < height / 2; row++)
+        {
+            std::swap_ranges(pixels.get() + row * rowSize, pixels.get() + (row + 1) * rowSize, 
+                pixels.get() + (height - row - 1) * rowSize);
+        }
+    }
+
+    CookedTexture cookedTexture = CookedTexture::Cook(pixels.get(), { width, height }, channels, srgb, flipOnLoad, compress);
+
+    // Failing to write the cooked texture file only means the image will be decoded again next time
+    // Images from packs aren't cooked to files, their cooked textures should be added to the pack instead
+    if (!imagePacked)
+    {
+        try
+        {
+            cookedTexture.Save(cookedFilePath);
+        }
+        catch (FormattedException& e)
+        {
+            LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::WARNING, e.GetArgs());
+        }
+    }
+
+    return cookedTexture;
+}
+
+void AssetSystem::UploadPendingTextures(size_t byteBudget)
+{
+    // Delete the textures which have been evicted, which can only be done on this thread
+    if (m_evictedTextureCount.load(std::memory_order_relaxed) != 0)
+    {
+        std::vector<Texture2DPtr> evictedTextures;
+        {
+            std::lock_guard<std::mutex> lock(m_textureUploadMutex);
+            evictedTextures.swap(m_evictedTextures);
+            m_evictedTextureCount.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    if (m_pendingTextureCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    SubsystemTimer uploadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    // Take the placeholder requests and the newly loaded images
+    std::vector<std::weak_ptr<Texture2D>> placeholderRequests;
+    {
+        std::lock_guard<std::mutex> lock(m_textureUploadMutex);
+        placeholderRequests.swap(m_placeholderRequests);
+
+        for (PendingTextureUpload& upload : m_loadedTextures)
+            m_textureUploads.push_back(std::move(upload));
+
+        m_loadedTextures.clear();
+    }
+
+    // Give the newly loading textures a single white pixel to show until they're uploaded
+    const uint8_t placeholderPixel[4] = { 255, 255, 255, 255 };
+    for (const std::weak_ptr<Texture2D>& weakTexture : placeholderRequests)
+    {
+        const Texture2DPtr texture = weakTexture.lock();
+        if (texture && texture->GetID() == 0)
+        {
+            Texture2D placeholder(placeholderPixel, { 1, 1 }, GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA);
+            texture->Swap(placeholder);
+        }
+    }
+
+    if (m_textureUploads.empty())
+        return;
+
+    // The rows of uncompressed levels are tightly packed, rather than aligned to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    size_t uploadedByteCount = 0;
+    while (!m_textureUploads.empty() && uploadedByteCount < byteBudget)
+    {
+        PendingTextureUpload& upload = m_textureUploads.front();
+        const CookedTexture& image = upload.m_image;
+
+        const Texture2DPtr texture = upload.m_texture.lock();
+        if (!texture || !upload.m_loaded) // The texture was removed before it finished loading, or its image failed to load
+        {
+            m_textureUploads.pop_front();
+            m_pendingTextureCount.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (!upload.m_uploadTexture)
+            upload.m_uploadTexture = std::make_unique<Texture2D>(image.GetSize(), image.GetLevelCount());
+
+        // Allocate the level before uploading its first rows
+        const uint32_t levelIndex = upload.m_uploadedLevelCount;
+        const CookedTexture::Level& level = image.GetLevel(levelIndex);
+
+        if (upload.m_uploadedRowCount == 0)
+        {
+            if (image.IsCompressed())
+            {
+                upload.m_uploadTexture->SetCompressedLevelData(levelIndex, nullptr, (size_t)level.m_dataSize, 
+                    image.GetInternalFormat());
+            }
+            else
+            {
+                upload.m_uploadTexture->SetLevelData(levelIndex, nullptr, GL_UNSIGNED_BYTE, image.GetInternalFormat(), 
+                    image.GetFormat());
+            }
+        }
+
+        // Upload as many rows (rows of blocks, if compressed) as fit in what's left of the budget, at least one so that every 
+        // upload makes progress
+        const uint32_t rowBlockHeight = image.GetRowBlockHeight();
+        const size_t rowSize = image.GetLevelRowSize(levelIndex);
+        const uint32_t uploadedBlockRowCount = upload.m_uploadedRowCount / rowBlockHeight;
+        const uint32_t blockRowCount = std::clamp((uint32_t)((byteBudget - uploadedByteCount) / rowSize), 1u, 
+            (level.m_height + rowBlockHeight - 1) / rowBlockHeight - uploadedBlockRowCount);
+
+        const glm::ivec2 offset = { 0, (int)upload.m_uploadedRowCount };
+        const glm::ivec2 size = { (int)level.m_width, 
+            (int)std::min(blockRowCount * rowBlockHeight, level.m_height - upload.m_uploadedRowCount) };
+        const uint8_t* data = image.GetLevelData(levelIndex) + uploadedBlockRowCount * rowSize;
+
+        if (image.IsCompressed())
+        {
+            upload.m_uploadTexture->ModifyCompressedData(data, blockRowCount * rowSize, offset, size, image.GetInternalFormat(), 
+                levelIndex);
+        }
+        else
+            upload.m_uploadTexture->ModifyData(data, offset, size, GL_UNSIGNED_BYTE, image.GetFormat(), levelIndex);
+
+        upload.m_uploadedRowCount += size.y;
+        uploadedByteCount += blockRowCount * rowSize;
+
+        if (upload.m_uploadedRowCount == level.m_height)
+        {
+            upload.m_uploadedLevelCount++;
+            upload.m_uploadedRowCount = 0;
+        }
+
+        // Once complete, swap the uploaded texture buffer into the texture, the placeholder is deleted along with the upload
+        if (upload.m_uploadedLevelCount == image.GetLevelCount())
+        {
+            texture->Swap(*upload.m_uploadTexture);
+            m_textureUploads.pop_front();
+            m_pendingTextureCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void AssetSystem::UploadPendingGeometry()
+{
+    if (m_pendingGeometryCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    SubsystemTimer uploadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    std::vector<PendingGeometryUpload> uploads;
+    std::vector<GeometryData> evictedGeometry;
     {
-        // Load the pixel data from the image file
-        int width = 0, height = 0, channels = 0;
-        stbi_set_flip_vertically_on_load(flipOnLoad);
-        const uint8_t* pixelData = stbi_load(imageFilePath.data(), &width, &height, &channels, 0);
+        std::lock_guard<std::mutex> lock(m_geometryUploadMutex);
+        uploads.swap(m_geometryUploads);
+        evictedGeometry.swap(m_evictedGeometry);
+        m_pendingGeometryCount.store(0, std::memory_order_relaxed);
+    }
+
+    // Free the evicted meshes first, so that their space can be reused by the meshes being copied back
+    for (const GeometryData& geometryData : evictedGeometry)
+        geometryData.m_pool->Free(geometryData.m_allocation);
 
-        if (pixelData) // Check that the image was loaded successfully
+    for (PendingGeometryUpload& upload : uploads)
+    {
+        if (!upload.m_loaded)
+            continue;
+
+        // Cooked meshes don't keep a copy of their vertices, they were loaded into the upload instead
+        if (upload.m_vertices.empty())
+        {
+            upload.m_geometryData = this->UploadCookedMesh(upload.m_mesh);
+            upload.m_mesh = CookedMesh();
+        }
+        else
         {
-            // Figure out how to store the pixel data (the internal format) and how the pixel data given is formatted (the format)
-            uint32_t internalFormat = 0, format = 0;
-            switch (channels)
+            GeometryPool& geometryPool = this->GetGeometryPool();
+            upload.m_geometryData.m_pool = &geometryPool;
+            upload.m_geometryData.m_allocation = geometryPool.Allocate(upload.m_vertices.data(), 
+                (uint32_t)upload.m_vertices.size(), upload.m_indices.data(), (uint32_t)upload.m_indices.size());
+
+            upload.m_vertices = {};
+            upload.m_indices = {};
+        }
+    }
+
+    if (!uploads.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_geometryUploadMutex);
+        m_uploadedGeometry.insert(m_uploadedGeometry.end(), std::make_move_iterator(uploads.begin()), 
+            std::make_move_iterator(uploads.end()));
+    }
+}
+
+uint32_t AssetSystem::GetPendingTextureCount() const
+{
+    return m_pendingTextureCount.load(std::memory_order_relaxed);
+}
+
+void AssetSystem::SetTextureCompressionEnabled(bool enabled)
+{
+    m_textureCompressionEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void AssetSystem::SetMemoryBudget(size_t byteBudget)
+{
+    m_memoryBudget = byteBudget;
+}
+
+size_t AssetSystem::GetResidentAssetSize() const
+{
+    size_t residentSize = 0;
+    m_storedTextures.ForEach([&residentSize](uint64_t, const Texture2DPtr& texture)
+        { residentSize += texture->GetAllocatedSize(); });
+
+    m_storedGeometry.ForEach([&residentSize](uint64_t, const GeometryData& geometryData)
+        { residentSize += GetGeometrySize(geometryData); });
+
+    return residentSize;
+}
+
+void AssetSystem::EndFrame()
+{
+    // Textures are in use for as long as anything else holds on to them, such as the materials of the geometry being drawn
+    m_storedTextures.ForEach([this](uint64_t key, const Texture2DPtr& texture)
+    {
+        TextureSource* source = m_textureSources.Find(key);
+        if (source && texture.use_count() > 1)
+            source->m_lastUsedFrame = m_frameIndex;
+    });
+
+    this->StoreUploadedGeometry();
+    this->FreeRemovedGeometry();
+    this->EnforceMemoryBudget();
+    m_frameIndex++;
+}
+
+void AssetSystem::StoreUploadedGeometry()
+{
+    std::vector<PendingGeometryUpload> uploadedGeometry;
+    {
+        std::lock_guard<std::mutex> lock(m_geometryUploadMutex);
+        uploadedGeometry.swap(m_uploadedGeometry);
+    }
+
+    for (const PendingGeometryUpload& upload : uploadedGeometry)
+    {
+        // The mesh may have been removed (or replaced by another with the same ID) while it was being copied back
+        EvictableGeometry* geometry = m_evictableGeometry.Find(upload.m_key);
+        if (geometry && geometry->m_uploadQueued)
+        {
+            // A cooked mesh which failed to load is removed, rather than trying to load it again every time it's looked up
+            if (upload.m_loaded)
             {
-            case 4:
-                internalFormat = srgb ? GL_SRGB_ALPHA : GL_RGBA;
-                format = GL_RGBA;
-                break;
-            case 3:
-                internalFormat = srgb ? GL_SRGB : GL_RGB;
-                format = GL_RGB;
-                break;
-            default:
-                throw FormattedException("The channel format for the texture image at path: %s, is not supported.", 
-                    imageFilePath.data());
-                break;
+                m_storedGeometry.Insert(upload.m_key, upload.m_geometryData);
+                geometry->m_uploadQueued = false;
             }
+            else
+                m_evictableGeometry.Erase(upload.m_key);
+        }
+        else if (upload.m_loaded)
+            this->QueueGeometryFree(upload.m_geometryData);
+    }
+}
+
+void AssetSystem::QueueGeometryFree(const GeometryData& geometryData)
+{
+    std::lock_guard<std::mutex> lock(m_geometryUploadMutex);
+    m_evictedGeometry.push_back(geometryData);
+    m_pendingGeometryCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AssetSystem::FreeRemovedGeometry()
+{
+    auto freedBegin = std::partition(m_removedGeometry.begin(), m_removedGeometry.end(), [this](const RemovedGeometry& geometry)
+        { return geometry.m_removedFrame + AssetSystemParams::evictionFrameDelay > m_frameIndex; });
+
+    for (auto geometry = freedBegin; geometry != m_removedGeometry.end(); geometry++)
+        this->QueueGeometryFree(geometry->m_geometryData);
+
+    m_removedGeometry.erase(freedBegin, m_removedGeometry.end());
+}
+
+void AssetSystem::EnforceMemoryBudget()
+{
+    size_t residentSize = this->GetResidentAssetSize();
+    if (residentSize <= m_memoryBudget)
+        return;
+
+    // An asset which can be evicted, since it hasn't been in use for long enough
+    struct EvictionCandidate
+    {
+        uint64_t m_key;
+        uint64_t m_lastUsedFrame;
+        bool m_texture; // Otherwise the candidate is a mesh
+    };
+
+    std::vector<EvictionCandidate> candidates;
+    m_storedTextures.ForEach([this, &candidates](uint64_t key, const Texture2DPtr& texture)
+    {
+        const TextureSource* source = m_textureSources.Find(key);
+        if (source && texture.use_count() == 1 && source->m_lastUsedFrame + AssetSystemParams::evictionFrameDelay <= m_frameIndex)
+            candidates.push_back({ key, source->m_lastUsedFrame, true });
+    });
 
-            // Setup and store the texture buffer
-            m_storedTextures[nameID.data()] = std::make_shared<Texture2D>(pixelData, glm::ivec2(width, height), GL_UNSIGNED_BYTE, 
-                internalFormat, format);
+    m_storedGeometry.ForEach([this, &candidates](uint64_t key, const GeometryData&)
+    {
+        const EvictableGeometry* geometry = m_evictableGeometry.Find(key);
+        if (geometry && geometry->m_lastUsedFrame + AssetSystemParams::evictionFrameDelay <= m_frameIndex)
+            candidates.push_back({ key, geometry->m_lastUsedFrame, false });
+    });
+
+    // Evict the least recently used assets first, until the rest fit in the budget
+    std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate& lhs, const EvictionCandidate& rhs)
+        { return lhs.m_lastUsedFrame < rhs.m_lastUsedFrame; });
+
+    std::vector<Texture2DPtr> evictedTextures;
+    for (const EvictionCandidate& candidate : candidates)
+    {
+        if (residentSize <= m_memoryBudget)
+            break;
+
+        if (candidate.m_texture)
+        {
+            // The texture buffer is deleted by the thread with the OpenGL context, the next time it uploads textures
+            Texture2DPtr* texture = m_storedTextures.Find(candidate.m_key);
+            residentSize -= (*texture)->GetAllocatedSize();
+
+            evictedTextures.push_back(std::move(*texture));
+            m_storedTextures.Erase(candidate.m_key);
         }
         else
-            throw FormattedException("Failed to load the texture image at path: %s.", imageFilePath.data());
+        {
+            // The range is freed by the thread with the OpenGL context, which is the only one to allocate from the pool
+            const GeometryData* geometryData = m_storedGeometry.Find(candidate.m_key);
+            residentSize -= GetGeometrySize(*geometryData);
+
+            this->QueueGeometryFree(*geometryData);
+            m_storedGeometry.Erase(candidate.m_key);
+        }
+    }
+
+    if (!evictedTextures.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_textureUploadMutex);
+        m_evictedTextures.insert(m_evictedTextures.end(), std::make_move_iterator(evictedTextures.begin()), 
+            std::make_move_iterator(evictedTextures.end()));
+
+        m_evictedTextureCount.store((uint32_t)m_evictedTextures.size(), std::memory_order_relaxed);
+    }
+
+    if (residentSize > m_memoryBudget)
+    {
+        LOG_WARNING_RATE_LIMITED("The stored assets take up %zu bytes, over the memory budget of %zu bytes, with no more assets "
+            "which can be evicted.", residentSize, m_memoryBudget);
+    }
+}
+
+void AssetSystem::StoreGeometry(std::string_view nameID, const GeometryPool::Vertex* vertices, uint32_t vertexCount, 
+    const uint32_t* indices, uint32_t indexCount, bool evictable)
+{
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    if (!vertices || !indices)
+        throw FormattedException("No vertex or index data was given for geometry assigned with ID \"%s\".", nameID.data());
+
+    const AssetID id(nameID);
+    RegisterAssetName(nameID);
+
+    // Make sure the ID given isn't already taken, including by evicted meshes
+    if (!m_storedGeometry.Find(id.GetHash()) && !m_evictableGeometry.Find(id.GetHash()))
+    {
+        GeometryPool& geometryPool = this->GetGeometryPool();
+        m_storedGeometry.Insert(id.GetHash(), { &geometryPool, geometryPool.Allocate(vertices, vertexCount, indices, indexCount) });
+
+        if (evictable)
+        {
+            EvictableGeometry geometry;
+            geometry.m_vertices.assign(vertices, vertices + vertexCount);
+            geometry.m_indices.assign(indices, indices + indexCount);
+            geometry.m_lastUsedFrame = m_frameIndex;
+
+            m_evictableGeometry.Insert(id.GetHash(), geometry);
+        }
     }
     else
     {
-        LoggingSystem::GetInstance().Output("Skipped texture image load operation, the ID \"%s\" has already been used.",
-            LoggingSystem::Severity::WARNING, nameID.data());
+        LOG_WARNING("Skipped geometry storage operation, the ID \"%s\" has already been used.", nameID.data());
+    }
+}
+
+CookedMesh AssetSystem::LoadCookedMesh(const std::string& meshFilePath) const
+{
+    std::vector<uint8_t> packedData;
+    ByteView packedFile;
+    if (this->FindPackedFile(meshFilePath, packedData, packedFile))
+    {
+        return packedData.empty() ? CookedMesh::FromView(packedFile, meshFilePath) : 
+            CookedMesh::FromData(std::move(packedData), meshFilePath);
     }
+
+    return CookedMesh::Load(meshFilePath);
 }
 
-void AssetSystem::StoreGeometryBuffers(std::string_view nameID, VertexBufferPtr vertexBuffer, IndexBufferPtr indexBuffer)
+AssetSystem::GeometryData AssetSystem::UploadCookedMesh(const CookedMesh& mesh)
 {
-    if (!vertexBuffer)
-        throw FormattedException("No vertex buffer was given for geometry assigned with ID \"%s\".", nameID.data());
+    GeometryData geometryData;
+    geometryData.m_pool = &this->GetQuantizedGeometryPool(mesh.GetIndexSize());
+    geometryData.m_allocation = geometryData.m_pool->AllocateData(mesh.GetVertexData(), mesh.GetVertexCount(), 
+        mesh.GetIndexData(), mesh.GetIndexCount());
 
-    if (m_storedGeometryBuffers.find(nameID.data()) == m_storedGeometryBuffers.end()) // Make sure the ID given isn't already taken
-        m_storedGeometryBuffers[nameID.data()] = { vertexBuffer, indexBuffer };
+    geometryData.m_positionScale = mesh.GetPositionScale();
+    geometryData.m_positionOffset = mesh.GetPositionOffset();
+    return geometryData;
+}
+
+void AssetSystem::StoreMesh(std::string_view nameID, const CookedMesh& mesh)
+{
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    const AssetID id(nameID);
+    RegisterAssetName(nameID);
+
+    // Make sure the ID given isn't already taken, including by evicted meshes
+    if (!m_storedGeometry.Find(id.GetHash()) && !m_evictableGeometry.Find(id.GetHash()))
+    {
+        m_storedGeometry.Insert(id.GetHash(), this->UploadCookedMesh(mesh));
+    }
     else
     {
-        LoggingSystem::GetInstance().Output("Skipped geometry buffer objects storage operation, the ID \"%s\" has already been used.",
-            LoggingSystem::Severity::WARNING, nameID.data());
+        LOG_WARNING("Skipped geometry storage operation, the ID \"%s\" has already been used.", nameID.data());
     }
 }
 
-void AssetSystem::RemoveShader(std::string_view nameID)
+void AssetSystem::LoadMesh(std::string_view nameID, const std::string& meshFilePath, bool evictable)
 {
-    m_storedShaders.erase(nameID.data());
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    const AssetID id(nameID);
+    RegisterAssetName(nameID);
+
+    if (m_storedGeometry.Find(id.GetHash()) || m_evictableGeometry.Find(id.GetHash()))
+    {
+        LOG_WARNING("Skipped geometry storage operation, the ID \"%s\" has already been used.", nameID.data());
+        return;
+    }
+
+    m_storedGeometry.Insert(id.GetHash(), this->UploadCookedMesh(this->LoadCookedMesh(meshFilePath)));
+
+    if (evictable)
+    {
+        EvictableGeometry geometry;
+        geometry.m_meshFilePath = meshFilePath;
+        geometry.m_lastUsedFrame = m_frameIndex;
+
+        m_evictableGeometry.Insert(id.GetHash(), geometry);
+    }
+}
+
+void AssetSystem::RemoveShader(AssetID id)
+{
+    const ShaderSource* source = m_shaderSources.Find(id.GetHash());
+    if (source)
+    {
+        for (uint32_t featureMask : source->m_compiledFeatureMasks)
+            m_storedShaders.Erase(AssetSystem::GetPermutationKey(id, featureMask));
+
+        m_shaderSources.Erase(id.GetHash());
+    }
 }
 
-void AssetSystem::RemoveTexture(std::string_view nameID)
+void AssetSystem::RemoveTexture(AssetID id)
 {
-    m_storedTextures.erase(nameID.data());
+    m_storedTextures.Erase(id.GetHash());
+    m_textureSources.Erase(id.GetHash());
 }
 
-void AssetSystem::RemoveGeometryBuffers(std::string_view nameID)
+void AssetSystem::RemoveTextureArray(AssetID id)
 {
-    m_storedGeometryBuffers.erase(nameID.data());
+    m_storedTextureArrays.Erase(id.GetHash());
 }
 
-ShaderProgramPtr AssetSystem::GetShader(std::string_view nameID) const
+void AssetSystem::RemoveGeometry(AssetID id)
 {
-    auto shaderIterator = m_storedShaders.find(nameID.data());
-    if (shaderIterator == m_storedShaders.end())
+    const GeometryData* geometryData = m_storedGeometry.Find(id.GetHash());
+    if (geometryData)
     {
-        LoggingSystem::GetInstance().Output("No shader exists with the assigned ID \"%s\".", LoggingSystem::Severity::WARNING, 
-            nameID.data());
+        // The range is freed by the thread with the OpenGL context, once the frames which may still draw it have been rendered
+        m_removedGeometry.push_back({ *geometryData, m_frameIndex });
+        m_storedGeometry.Erase(id.GetHash());
+    }
 
+    m_evictableGeometry.Erase(id.GetHash());
+}
+
+ShaderProgramPtr AssetSystem::GetShader(AssetID id) const
+{
+    const ShaderProgramPtr* shader = m_storedShaders.Find(id.GetHash());
+    if (!shader)
+    {
+        // Rate limited since a missing asset is usually requested every frame, the name is only looked up if it's logged
+        LOG_WARNING_RATE_LIMITED("No shader exists with the assigned ID \"%s\".", GetAssetName(id).c_str());
+
+        return nullptr;
+    }
+
+    return *shader;
+}
+
+ShaderProgramPtr AssetSystem::GetShaderPermutation(AssetID id, uint32_t featureMask)
+{
+    const uint64_t permutationKey = AssetSystem::GetPermutationKey(id, featureMask);
+    if (const ShaderProgramPtr* shader = m_storedShaders.Find(permutationKey))
+        return *shader;
+
+    ShaderSource* source = m_shaderSources.Find(id.GetHash());
+    if (!source)
+    {
+        LOG_WARNING_RATE_LIMITED("No shader exists with the assigned ID \"%s\".", GetAssetName(id).c_str());
         return nullptr;
     }
 
-    return shaderIterator->second;
+    if (source->m_featureDefines.size() < 32 && (featureMask >> source->m_featureDefines.size()) != 0)
+    {
+        throw FormattedException("The feature mask 0x%X has bits set which don't correspond to any feature of the shader \"%s\".",
+            featureMask, GetAssetName(id).c_str());
+    }
+
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    const ShaderProgramPtr shader = this->CompileShaderPermutation(*source, featureMask);
+    m_storedShaders.Insert(permutationKey, shader);
+    source->m_compiledFeatureMasks.push_back(featureMask);
+
+    return shader;
 }
 
-Texture2DPtr AssetSystem::GetTexture(std::string_view nameID) const
+Texture2DPtr AssetSystem::GetTexture(AssetID id)
 {
-    auto textureIterator = m_storedTextures.find(nameID.data());
-    if (textureIterator == m_storedTextures.end())
+    TextureSource* source = m_textureSources.Find(id.GetHash());
+    if (source)
+        source->m_lastUsedFrame = m_frameIndex;
+
+    const Texture2DPtr* texture = m_storedTextures.Find(id.GetHash());
+    if (!texture && source)
+    {
+        // The texture was evicted, so load it again
+        const Texture2DPtr reloaded = this->QueueTextureLoad(source->m_imageFilePath, source->m_flipOnLoad, source->m_srgb);
+        m_storedTextures.Insert(id.GetHash(), reloaded);
+
+        return reloaded;
+    }
+    else if (!texture)
     {
-        LoggingSystem::GetInstance().Output("No texture image exists with the assigned ID \"%s\".", LoggingSystem::Severity::WARNING, 
-            nameID.data());
+        // Rate limited since a missing asset is usually requested every frame, the name is only looked up if it's logged
+        LOG_WARNING_RATE_LIMITED("No texture image exists with the assigned ID \"%s\".", GetAssetName(id).c_str());
 
         return nullptr;
     }
 
-    return textureIterator->second;
+    return *texture;
 }
 
-AssetSystem::GeometryData* AssetSystem::GetGeometryBuffers(std::string_view nameID)
+Texture2DArrayPtr AssetSystem::GetTextureArray(AssetID id) const
 {
-    auto geometryDataIterator = m_storedGeometryBuffers.find(nameID.data());
-    if (geometryDataIterator == m_storedGeometryBuffers.end())
+    const Texture2DArrayPtr* textureArray = m_storedTextureArrays.Find(id.GetHash());
+    if (!textureArray)
+    {
+        LOG_WARNING_RATE_LIMITED("No texture array exists with the assigned ID \"%s\".", GetAssetName(id).c_str());
         return nullptr;
+    }
 
-    return &geometryDataIterator->second;
+    return *textureArray;
+}
+
+const AssetSystem::GeometryData* AssetSystem::GetGeometry(AssetID id)
+{
+    EvictableGeometry* geometry = m_evictableGeometry.Find(id.GetHash());
+    if (!geometry)
+        return m_storedGeometry.Find(id.GetHash());
+
+    geometry->m_lastUsedFrame = m_frameIndex;
+
+    const GeometryData* geometryData = m_storedGeometry.Find(id.GetHash());
+    if (geometryData || geometry->m_uploadQueued)
+        return geometryData;
+
+    // The mesh was evicted, so it isn't drawn until the thread with the OpenGL context has copied it back into the pool and 
+    // EndFrame() has stored it again
+    geometry->m_uploadQueued = true;
+
+    // Cooked meshes are loaded from their file again first, without any workers the job would only run once something waits on
+    // the job system, so the file is loaded now instead
+    if (!geometry->m_meshFilePath.empty())
+    {
+        if (JobSystem::GetInstance().GetThreadCount() > 1)
+        {
+            JobSystem::GetInstance().Submit([this, key = id.GetHash(), filePath = geometry->m_meshFilePath]()
+                { this->ReloadCookedMesh(key, filePath); });
+        }
+        else
+            this->ReloadCookedMesh(id.GetHash(), geometry->m_meshFilePath);
+    }
+    else
+    {
+        PendingGeometryUpload upload;
+        upload.m_key = id.GetHash();
+        upload.m_vertices = geometry->m_vertices;
+        upload.m_indices = geometry->m_indices;
+
+        std::lock_guard<std::mutex> lock(m_geometryUploadMutex);
+        m_geometryUploads.push_back(std::move(upload));
+        m_pendingGeometryCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return nullptr;
+}
+
+void AssetSystem::ReloadCookedMesh(uint64_t key, const std::string& meshFilePath)
+{
+    SubsystemTimer loadTimer(FrameStats::Subsystem::ASSET_LOAD);
+
+    PendingGeometryUpload upload;
+    upload.m_key = key;
+
+    try
+    {
+        upload.m_mesh = this->LoadCookedMesh(meshFilePath);
+    }
+    catch (FormattedException& e)
+    {
+        LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::WARNING, e.GetArgs());
+        upload.m_loaded = false;
+    }
+    catch (std::exception& e)
+    {
+        LOG_WARNING("Failed to load the cooked mesh at path: %s, %s", meshFilePath.c_str(), e.what());
+        upload.m_loaded = false;
+    }
+
+    // A mesh which failed to load has nothing to copy into the pool, so it goes straight back to EndFrame() to be removed
+    std::lock_guard<std::mutex> lock(m_geometryUploadMutex);
+    if (upload.m_loaded)
+    {
+        m_geometryUploads.push_back(std::move(upload));
+        m_pendingGeometryCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+        m_uploadedGeometry.push_back(std::move(upload));
+}
+
+GeometryPool& AssetSystem::GetGeometryPool()
+{
+    if (!m_geometryPool)
+    {
+        m_geometryPool = std::make_unique<GeometryPool>(AssetSystemParams::initialPoolVertexCapacity, 
+            AssetSystemParams::initialPoolIndexCapacity);
+    }
+
+    return *m_geometryPool;
+}
+
+GeometryPool& AssetSystem::GetQuantizedGeometryPool(uint32_t indexSize)
+{
+    std::unique_ptr<GeometryPool>& geometryPool = m_quantizedGeometryPools[indexSize == sizeof(uint16_t) ? 0 : 1];
+    if (!geometryPool)
+    {
+        geometryPool = std::make_unique<GeometryPool>(AssetSystemParams::initialPoolVertexCapacity, 
+            AssetSystemParams::initialPoolIndexCapacity, GeometryPool::VertexFormat::QUANTIZED, indexSize);
+    }
+
+    return *geometryPool;
+}
+
+std::string AssetSystem::GetAssetName(AssetID id) const
+{
+#ifdef _DEBUG
+    auto nameIterator = m_assetNames.find(id.GetHash());
+    if (nameIterator != m_assetNames.end())
+        return nameIterator->second;
+#endif
+
+    char hashString[19];
+    std::snprintf(hashString, sizeof(hashString), "0x%016llX", (unsigned long long)id.GetHash());
+    return hashString;
+}
+
+void AssetSystem::ImageDeleter::operator()(uint8_t* pixels) const
+{
+    stbi_image_free(pixels);
 }
 
 VertexBufferPtr AssetSystem::CreateVertexBuffer(const void* data, size_t size, uint32_t usage)
@@ -3,65 +3,329 @@
 
 #include <graphics/shader_program.h>
 #include <graphics/texture_2d.h>
+#include <graphics/texture_2d_array.h>
+#include <graphics/cooked_texture.h>
 #include <graphics/vertex_buffer.h>
 #include <graphics/index_buffer.h>
+#include <graphics/vertex_array.h>
+#include <graphics/geometry_pool.h>
+#include <graphics/cooked_mesh.h>
+#include <util/asset_id.h>
+#include <util/flat_hash_map.h>
+#include <util/asset_pack.h>
 
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <vector>
+#include <deque>
+#include <array>
+#include <mutex>
+#include <atomic>
 
 using ShaderProgramPtr = std::shared_ptr<ShaderProgram>;
 using Texture2DPtr = std::shared_ptr<Texture2D>;
+using Texture2DArrayPtr = std::shared_ptr<Texture2DArray>;
 using VertexBufferPtr = std::shared_ptr<VertexBuffer>;
 using IndexBufferPtr = std::shared_ptr<IndexBuffer>;
+using VertexArrayPtr = std::shared_ptr<VertexArray>;
 
 class AssetSystem
 {
 public:
+	// The range of the geometry pool which holds the vertices and indices of a mesh.
 	struct GeometryData
 	{
-		VertexBufferPtr m_vertexBuffer;
-		IndexBufferPtr m_indexBuffer;
+		GeometryPool* m_pool = nullptr;
+		GeometryPool::Allocation m_allocation;
+		glm::vec3 m_positionScale = glm::vec3(1.0f), m_positionOffset = glm::vec3(0.0f); // Only used by quantized pools
 	};
+
+	// The default number of bytes of texture data uploaded to the GPU by each call to UploadPendingTextures().
+	static constexpr size_t defaultTextureUploadBudget = 4 * 1024 * 1024;
+
+	// The default number of bytes of GPU memory which the stored textures and meshes may take up before the least recently 
+	// used ones are evicted, see SetMemoryBudget().
+	static constexpr size_t defaultMemoryBudget = 512 * 1024 * 1024;
 private:
-	std::unordered_map<std::string, ShaderProgramPtr> m_storedShaders;
-	std::unordered_map<std::string, Texture2DPtr> m_storedTextures;
-	std::unordered_map<std::string, GeometryData> m_storedGeometryBuffers;
+	// Frees pixel data returned by the image loader.
+	struct ImageDeleter
+	{
+		void operator()(uint8_t* pixels) const;
+	};
+
+	// A texture being loaded by LoadTextureAsync(), which is uploaded to the GPU over one or more frames once loaded.
+	struct PendingTextureUpload
+	{
+		std::weak_ptr<Texture2D> m_texture; // The texture returned by LoadTextureAsync(), the upload is dropped if it's removed
+		CookedTexture m_image;
+		bool m_loaded = false; // Left unset if the image failed to load
+		std::unique_ptr<Texture2D> m_uploadTexture; // Created when the first rows are uploaded, then swapped into the texture
+		uint32_t m_uploadedLevelCount = 0, m_uploadedRowCount = 0; // The rows uploaded of the level being uploaded
+	};
+
+	// The source files of a shader loaded by LoadShader(), from which its permutations are compiled.
+	struct ShaderSource
+	{
+		std::string m_vshFilePath, m_fshFilePath;
+		std::vector<std::string> m_featureDefines; // The define enabled by each bit of a permutation's feature mask
+		std::vector<uint32_t> m_compiledFeatureMasks; // The permutations which have been compiled
+	};
+
+	// The image file of a texture loaded by LoadTexture() or LoadTextureAsync(), which it's loaded from again if it's needed 
+	// after being evicted, along with when it was last in use.
+	struct TextureSource
+	{
+		std::string m_imageFilePath;
+		bool m_flipOnLoad = false, m_srgb = false;
+		uint64_t m_lastUsedFrame = 0;
+	};
+
+	// The copy of a mesh stored as evictable, which is copied back into the geometry pool if it's needed after being evicted.
+	// Cooked meshes don't keep a copy, they're loaded from their file again instead.
+	struct EvictableGeometry
+	{
+		std::vector<GeometryPool::Vertex> m_vertices;
+		std::vector<uint32_t> m_indices;
+		std::string m_meshFilePath; // Only set for cooked meshes
+		uint64_t m_lastUsedFrame = 0;
+		bool m_uploadQueued = false; // Set while the evicted mesh is being copied back into the geometry pool
+	};
+
+	// An evicted mesh which is copied back into the geometry pool by UploadPendingGeometry(), then stored again by EndFrame().
+	struct PendingGeometryUpload
+	{
+		uint64_t m_key = 0;
+		std::vector<GeometryPool::Vertex> m_vertices;
+		std::vector<uint32_t> m_indices;
+		CookedMesh m_mesh; // Only used by cooked meshes, which are loaded from their file again by a job
+		bool m_loaded = true; // Unset if a cooked mesh failed to load, in which case it's removed rather than copied back
+		GeometryData m_geometryData; // Set once the mesh has been copied into the pool
+	};
+
+	// A mesh which has been removed, but whose range of the geometry pool may still be drawn by frames waiting to be rendered.
+	struct RemovedGeometry
+	{
+		GeometryData m_geometryData;
+		uint64_t m_removedFrame = 0;
+	};
+
+	FlatHashMap<ShaderProgramPtr> m_storedShaders; // Keyed by the permutation keys, see GetPermutationKey()
+	FlatHashMap<ShaderSource> m_shaderSources;
+	FlatHashMap<Texture2DPtr> m_storedTextures;
+	FlatHashMap<Texture2DArrayPtr> m_storedTextureArrays;
+	FlatHashMap<GeometryData> m_storedGeometry; // Only holds the meshes which are currently in the geometry pool
+	FlatHashMap<TextureSource> m_textureSources;
+	FlatHashMap<EvictableGeometry> m_evictableGeometry;
+
+	size_t m_memoryBudget = defaultMemoryBudget;
+	uint64_t m_frameIndex = 0;
+
+	std::unique_ptr<GeometryPool> m_geometryPool;
+	std::array<std::unique_ptr<GeometryPool>, 2> m_quantizedGeometryPools; // Holding 16-bit and 32-bit indices respectively
+	std::vector<std::unique_ptr<AssetPack>> m_mountedPacks;
+
+	std::mutex m_textureUploadMutex;
+	std::vector<std::weak_ptr<Texture2D>> m_placeholderRequests; // Textures which still need their placeholder created
+	std::vector<PendingTextureUpload> m_loadedTextures; // Loaded by the workers, waiting to be picked up for uploading
+	std::deque<PendingTextureUpload> m_textureUploads; // Only used by the thread which uploads the textures
+	std::vector<Texture2DPtr> m_evictedTextures; // Waiting to be deleted on the thread with the OpenGL context
+	std::atomic<uint32_t> m_pendingTextureCount{ 0 };
+	std::atomic<uint32_t> m_evictedTextureCount{ 0 };
+	std::atomic<bool> m_textureCompressionEnabled{ true };
+
+	std::mutex m_geometryUploadMutex;
+	std::vector<PendingGeometryUpload> m_geometryUploads; // Waiting to be copied into the pool on the thread with the context
+	std::vector<PendingGeometryUpload> m_uploadedGeometry; // Copied into the pool, waiting to be stored again by EndFrame()
+	std::vector<GeometryData> m_evictedGeometry; // Waiting to be freed from the pool on the thread with the OpenGL context
+	std::vector<RemovedGeometry> m_removedGeometry; // Only used by the simulation thread, until it's safe to queue the free
+	std::atomic<uint32_t> m_pendingGeometryCount{ 0 }; // The number of uploads and evictions waiting for that thread
+
+#ifdef _DEBUG
+	std::unordered_map<uint64_t, std::string> m_assetNames; // Maps asset IDs back to their names, for log messages
+#endif
 
 	AssetSystem() = default;
+
+	// Keeps a copy of the name which the asset ID was created from, so it can be returned by GetAssetName().
+	// This only does anything in debug builds, where it also checks that the name's hash doesn't collide with another asset name.
+	// It's called before an asset is stored, so that a colliding name throws without leaving the asset stored under the hash.
+	void RegisterAssetName(std::string_view nameID);
+
+	// Returns the key of the shader permutation with the given feature mask, which for a mask of 0 is the hash of the shader's ID.
+	static uint64_t GetPermutationKey(AssetID id, uint32_t featureMask);
+
+	// Compiles the permutation of the shader with the given feature mask, reading its files from the mounted packs if they 
+	// contain them.
+	ShaderProgramPtr CompileShaderPermutation(const ShaderSource& source, uint32_t featureMask) const;
+
+	// Finds the file with the given path in the mounted packs, searching the most recently mounted first.
+	// Returns FALSE if no pack contains the file, otherwise the file's data is returned through the view. If the file is 
+	// compressed, it's decompressed into the buffer given, which the view then refers to.
+	bool FindPackedFile(std::string_view filePath, std::vector<uint8_t>& decompressedData, ByteView& data) const;
+
+	// Returns the cooked texture of the image file, which is loaded from the cooked texture file next to the image if one exists
+	// and is up to date. Otherwise the image is decoded and cooked, and the cooked texture file is written for next time.
+	// This can be called from any thread.
+	CookedTexture LoadCookedTexture(const std::string& imageFilePath, bool flipOnLoad, bool srgb) const;
+
+	// Returns the cooked mesh file at the given path, reading it from the mounted packs if they contain it.
+	CookedMesh LoadCookedMesh(const std::string& meshFilePath) const;
+
+	// Copies the cooked mesh into the quantized geometry pool for its index size, returning where it was placed.
+	// This must be called on the thread with the OpenGL context.
+	GeometryData UploadCookedMesh(const CookedMesh& mesh);
+
+	// Returns a new texture which is filled with the image once it has been loaded in the background, see LoadTextureAsync().
+	Texture2DPtr QueueTextureLoad(const std::string& imageFilePath, bool flipOnLoad, bool srgb);
+
+	// Loads the image for the texture, then queues it to be uploaded. Called on a worker by LoadTextureAsync().
+	void DecodeTexture(std::weak_ptr<Texture2D> texture, const std::string& imageFilePath, bool flipOnLoad, bool srgb);
+
+	// Loads the evicted cooked mesh from its file again, then queues it to be copied back into the geometry pool.
+	// Called on a worker by GetGeometry().
+	void ReloadCookedMesh(uint64_t key, const std::string& meshFilePath);
+
+	// Stores the evicted meshes which have been copied back into the geometry pool since the last call.
+	void StoreUploadedGeometry();
+
+	// Queues the mesh's range of the geometry pool to be freed by UploadPendingGeometry().
+	void QueueGeometryFree(const GeometryData& geometryData);
+
+	// Queues the ranges of the removed meshes to be freed, once no frame waiting to be rendered can still be drawing them.
+	void FreeRemovedGeometry();
+
+	// Evicts the least recently used textures and meshes which aren't in use until the stored assets fit in the memory budget.
+	void EnforceMemoryBudget();
 public:
 	~AssetSystem() = default;
 
+	// Memory maps the asset pack file at the given path, after which assets are loaded from the pack in preference to the 
+	// individual files whenever it contains the file paths they're loaded from. Packs mounted later take precedence.
+	// Packs must be mounted before any assets are loaded, since assets may be loaded in the background.
+	void MountPack(const std::string& filePath);
+
 	// Loads shader from file and keeps a copy of it, which can be accessed using the GetShader() method.
-	void LoadShader(std::string_view nameID, std::string_view vshFilePath, std::string_view fshFilePath);
+	// The shader can be specialised by the given feature defines, bit N of a permutation's feature mask enabling the Nth define.
+	// The permutation without any features is compiled straight away, others when they're first requested.
+	void LoadShader(std::string_view nameID, std::string_view vshFilePath, std::string_view fshFilePath, 
+		const std::vector<std::string>& featureDefines = {});
 
 	// Loads image from file and keeps copy of it as a texture, which can be accessed using the GetTexture() method.
+	// The first time an image is loaded it's cooked into a .mtex file next to it, with a mip chain (and compressed if enabled), 
+	// which is loaded instead of the image from then on. The cooked file is rebuilt if the image is modified.
 	void LoadTexture(std::string_view nameID, std::string_view imageFilePath, bool flipOnLoad, bool srgb);
 
-	// Stores a copy of the geometry buffer objects given.
-	// Note that a vertex buffer must be passed, however passing an index buffer is optional.
-	void StoreGeometryBuffers(std::string_view nameID, VertexBufferPtr vertexBuffer, IndexBufferPtr indexBuffer = nullptr);
+	// Loads the images from file and packs them into the layers of a texture array, in the order given, which can be accessed 
+	// using the GetTextureArray() method. The images must all have the same size, and are cooked the same way as by 
+	// LoadTexture(), in parallel across the job system's workers.
+	void LoadTextureArray(std::string_view nameID, const std::vector<std::string>& imageFilePaths, bool flipOnLoad, bool srgb);
+
+	// Stores a texture with the given ID and returns it straight away, while the image is loaded from file in the background.
+	// The image is loaded by the job system's workers and uploaded by UploadPendingTextures(), until then the texture holds a 
+	// single white pixel. If the image fails to load, a warning is logged and the texture is left as the placeholder.
+	Texture2DPtr LoadTextureAsync(std::string_view nameID, std::string_view imageFilePath, bool flipOnLoad, bool srgb);
+
+	// Creates the placeholders of newly loading textures, then uploads decoded texture images to the GPU, stopping once the 
+	// given number of bytes have been uploaded. Large images are uploaded a band of rows at a time over several calls.
+	// This must be called once per frame on the thread with the OpenGL context, before any loading textures are rendered.
+	// Textures which have been evicted are deleted here as well.
+	void UploadPendingTextures(size_t byteBudget = defaultTextureUploadBudget);
+
+	// Copies the evicted meshes which have been looked up since the last call back into the geometry pool, and frees the 
+	// ranges of the pool used by meshes which have been evicted.
+	// This must be called once per frame on the thread with the OpenGL context.
+	void UploadPendingGeometry();
+
+	// Returns the number of textures loaded by LoadTextureAsync() which haven't finished loading.
+	uint32_t GetPendingTextureCount() const;
+
+	// Sets whether textures are S3TC compressed when they're cooked, this is enabled by default.
+	// Compression is only used if the OpenGL implementation supports it, and doesn't affect textures which are already cooked
+	// unless they're compressed and it isn't supported, in which case they're cooked again.
+	void SetTextureCompressionEnabled(bool enabled);
+
+	// Sets the number of bytes of GPU memory which the stored textures and meshes may take up. Once they go over the budget, the 
+	// least recently used textures and evictable meshes which aren't in use are evicted by EndFrame() until they fit again.
+	// Texture arrays can't be evicted, so they don't count towards the budget.
+	void SetMemoryBudget(size_t byteBudget);
+
+	// Returns the number of bytes of GPU memory taken up by the stored textures and meshes, which is what the memory budget 
+	// applies to. Texture arrays aren't included.
+	size_t GetResidentAssetSize() const;
+
+	// Marks the end of a frame, after which any assets over the memory budget are evicted.
+	// Textures are in use while anything outside of the asset system holds on to them, and evictable meshes while they're looked
+	// up with GetGeometry() each frame. Assets are only evicted once they haven't been in use for a few frames, so that frames 
+	// still being rendered don't refer to them. Evicted meshes which UploadPendingGeometry() has copied back into the geometry 
+	// pool are stored again here. This must be called once per frame on the thread which looks up the assets.
+	void EndFrame();
+
+	// Copies the given mesh into the geometry pool, which can then be accessed using the GetGeometry() method.
+	// Evictable meshes keep a copy of their vertices and indices in memory, so that they can be evicted from the pool when over 
+	// the memory budget, they're copied back the next time they're looked up.
+	void StoreGeometry(std::string_view nameID, const GeometryPool::Vertex* vertices, uint32_t vertexCount, const uint32_t* indices,
+		uint32_t indexCount, bool evictable = false);
+
+	// Copies the given cooked mesh into the quantized geometry pool for its index size, which can then be accessed using the 
+	// GetGeometry() method. This must be called on the thread with the OpenGL context.
+	void StoreMesh(std::string_view nameID, const CookedMesh& mesh);
+
+	// Loads the cooked mesh (.mmesh) file at the given path with a single read, from the mounted packs if they contain it, and 
+	// copies it straight into a quantized geometry pool, which can then be accessed using the GetGeometry() method.
+	// Evictable meshes are loaded from the file again if they're needed after being evicted.
+	// This must be called on the thread with the OpenGL context.
+	void LoadMesh(std::string_view nameID, const std::string& meshFilePath, bool evictable = false);
 
 	// Removes the stored shader that is attached to the ID specified.
-	void RemoveShader(std::string_view nameID);
+	void RemoveShader(AssetID id);
 
 	// Removes the stored texture that is attached to the ID specified.
-	void RemoveTexture(std::string_view nameID);
+	void RemoveTexture(AssetID id);
 
-	// Removes the stored geometry buffer objects that are attached to the ID specified.
-	void RemoveGeometryBuffers(std::string_view nameID);
+	// Removes the stored texture array that is attached to the ID specified.
+	void RemoveTextureArray(AssetID id);
 
-	// Returns the stored shader that is attached to the ID specified.
+	// Removes the stored mesh that is attached to the ID specified, freeing its space in the geometry pool.
+	// The space is only freed a few frames later, since the frames waiting to be rendered may still draw the mesh.
+	void RemoveGeometry(AssetID id);
+
+	// Returns the stored shader that is attached to the ID specified, the permutation without any features enabled.
+	// If no shader is found with the ID specified, then nullptr will be returned.
+	ShaderProgramPtr GetShader(AssetID id) const;
+
+	// Returns the permutation of the stored shader with the ID specified which has the given features enabled, compiling it if
+	// it's the first time it has been requested. This must be called on the thread with the OpenGL context.
 	// If no shader is found with the ID specified, then nullptr will be returned.
-	ShaderProgramPtr GetShader(std::string_view nameID) const;
+	ShaderProgramPtr GetShaderPermutation(AssetID id, uint32_t featureMask);
 
 	// Returns the stored texture that is attached to the ID specified.
+	// If the texture was evicted, it's loaded again in the background and holds its placeholder until then.
 	// If no texture is found with the ID specified, then nullptr will be returned.
-	Texture2DPtr GetTexture(std::string_view nameID) const;
+	Texture2DPtr GetTexture(AssetID id);
+
+	// Returns the stored texture array that is attached to the ID specified.
+	// If no texture array is found with the ID specified, then nullptr will be returned.
+	Texture2DArrayPtr GetTextureArray(AssetID id) const;
+
+	// Returns the range of the geometry pool holding the mesh that is attached to the ID specified.
+	// If the mesh was evicted, it's queued to be copied back into the pool by UploadPendingGeometry() and nullptr is returned 
+	// until it has been stored again by EndFrame(), so draws of it should be skipped until then. Cooked meshes are loaded from
+	// their file again in the background first.
+	// If no mesh is found with the ID specified, then nullptr is returned. If an evicted cooked mesh fails to load again, a 
+	// warning is logged and it's removed.
+	// Note that the pointer returned is invalidated when any meshes are stored, removed or evicted.
+	const GeometryData* GetGeometry(AssetID id);
+
+	// Returns the geometry pool which holds the stored meshes with standard vertices, creating it on first use.
+	GeometryPool& GetGeometryPool();
+
+	// Returns the geometry pool which holds the stored cooked meshes with the given index size, creating it on first use.
+	GeometryPool& GetQuantizedGeometryPool(uint32_t indexSize);
 
-	// Returns the geometry buffer objects that are attached to the ID specified.
-	// If no geometry buffer objects are found with the ID specified, then nullptr is returned.
-	GeometryData* GetGeometryBuffers(std::string_view nameID);
+	// Returns the name of the asset which the ID specified was created from.
+	// Names are only kept in debug builds, so in release builds (or if the name is unknown) the hash is returned as a string.
+	std::string GetAssetName(AssetID id) const;
 
 	// Returns shared pointer to newly created vertex buffer.
 	static VertexBufferPtr CreateVertexBuffer(const void* data, size_t size, uint32_t usage);
@@ -0,0 +1,102 @@
+#include <core/game_loop.h>
+#include <core/input_system.h>
+#include <util/profiler.h>
+#include <util/frame_stats.h>
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+namespace GameLoopParams
+{
+    // The longest frame duration which is accumulated, so that a long pause (e.g. dragging the window) isn't caught up on.
+    constexpr double maxFrameDuration = 0.25;
+}
+
+GameLoop::GameLoop(double tickRate, uint32_t maxTicksPerFrame) :
+    m_tickDuration(1.0 / tickRate), m_maxTicksPerFrame(std::max(maxTicksPerFrame, 1u)), m_lastFrameDuration(0.0), 
+    m_lastFrameTickCount(0), m_droppedTickCount(0)
+{}
+
+void GameLoop::SetTickRate(double tickRate)
+{
+    m_tickDuration = 1.0 / tickRate;
+}
+
+void GameLoop::SetMaxTicksPerFrame(uint32_t maxTicksPerFrame)
+{
+    m_maxTicksPerFrame = std::max(maxTicksPerFrame, 1u);
+}
+
+void GameLoop::Run(const WindowFrame& frame, const TickFunction& tickFunction, const FrameFunction& frameFunction)
+{
+    auto previousFrameTime = std::chrono::steady_clock::now();
+    double accumulatedTime = 0.0;
+    bool firstFrame = true;
+
+    while (!frame.WasRequestedClose())
+    {
+        // Measure the duration of the whole previous frame, rather than just the time spent rendering it
+        const auto currentFrameTime = std::chrono::steady_clock::now();
+        const auto lastFrameDuration = currentFrameTime - previousFrameTime;
+        m_lastFrameDuration = std::chrono::duration<double>(lastFrameDuration).count();
+        previousFrameTime = currentFrameTime;
+
+        accumulatedTime += std::min(m_lastFrameDuration, GameLoopParams::maxFrameDuration);
+
+        // The first frame has no previous frame to measure
+        if (!firstFrame)
+            FrameStats::GetInstance().EndFrame((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(lastFrameDuration).count());
+
+        firstFrame = false;
+
+        {
+            PROFILE_SCOPE("GameLoop::PollInput");
+            SubsystemTimer inputTimer(FrameStats::Subsystem::INPUT);
+            InputSystem::GetInstance().Update(); // Poll input once per frame, every tick this frame sees the same input
+        }
+
+        // Run the simulation ticks which are due, up to the limit per frame
+        m_lastFrameTickCount = 0;
+        {
+            SubsystemTimer simulationTimer(FrameStats::Subsystem::SIMULATION);
+            while (accumulatedTime >= m_tickDuration && m_lastFrameTickCount < m_maxTicksPerFrame)
+            {
+                tickFunction((float)m_tickDuration);
+
+                accumulatedTime -= m_tickDuration;
+                ++m_lastFrameTickCount;
+            }
+        }
+
+        // Drop any ticks which couldn't be run, so that the simulation doesn't keep falling further behind
+        if (accumulatedTime >= m_tickDuration)
+        {
+            const double droppedTicks = std::floor(accumulatedTime / m_tickDuration);
+            m_droppedTickCount += (uint64_t)droppedTicks;
+            accumulatedTime -= droppedTicks * m_tickDuration;
+        }
+
+        frameFunction((float)(accumulatedTime / m_tickDuration));
+    }
+}
+
+double GameLoop::GetTickDuration() const
+{
+    return m_tickDuration;
+}
+
+double GameLoop::GetLastFrameDuration() const
+{
+    return m_lastFrameDuration;
+}
+
+uint32_t GameLoop::GetLastFrameTickCount() const
+{
+    return m_lastFrameTickCount;
+}
+
+uint64_t GameLoop::GetDroppedTickCount() const
+{
+    return m_droppedTickCount;
+}
@@ -0,0 +1,60 @@
+#ifndef GAME_LOOP_H
+#define GAME_LOOP_H
+
+#include <core/window_frame.h>
+
+#include <functional>
+#include <cstdint>
+
+// Runs the simulation at a fixed tick rate, independently of the rate at which frames are rendered.
+// The time taken by each whole frame is accumulated and consumed in fixed size ticks, so the simulation advances at the same
+// speed regardless of the frame rate. Since the rendered frame usually falls between two ticks, the frame is given an 
+// interpolation alpha which should be used to blend between the previous and current simulation states.
+class GameLoop
+{
+public:
+	// Called for each simulation tick with the fixed duration of the tick in seconds.
+	using TickFunction = std::function<void(float tickDuration)>;
+
+	// Called once per frame with the interpolation alpha, which is how far the frame is between the previous tick (0.0) and the 
+	// current tick (1.0).
+	using FrameFunction = std::function<void(float interpolationAlpha)>;
+private:
+	double m_tickDuration;
+	uint32_t m_maxTicksPerFrame;
+
+	double m_lastFrameDuration;
+	uint32_t m_lastFrameTickCount;
+	uint64_t m_droppedTickCount;
+public:
+	// Creates a loop which runs the simulation at the given number of ticks per second.
+	// At most the given number of ticks are run per frame, if more are due then the simulation falls behind real time instead of
+	// trying to catch up, which would make each frame slower still.
+	GameLoop(double tickRate = 60.0, uint32_t maxTicksPerFrame = 5);
+
+	~GameLoop() = default;
+
+	// Sets the number of simulation ticks per second.
+	void SetTickRate(double tickRate);
+
+	// Sets the maximum number of simulation ticks run in a single frame.
+	void SetMaxTicksPerFrame(uint32_t maxTicksPerFrame);
+
+	// Runs the loop until the given window is requested to close.
+	// Each frame, input is polled once, then any simulation ticks which are due are run, and then the frame function is called.
+	void Run(const WindowFrame& frame, const TickFunction& tickFunction, const FrameFunction& frameFunction);
+
+	// Returns the duration of a simulation tick in seconds.
+	double GetTickDuration() const;
+
+	// Returns the duration of the previous frame in seconds.
+	double GetLastFrameDuration() const;
+
+	// Returns the number of simulation ticks run during the previous frame.
+	uint32_t GetLastFrameTickCount() const;
+
+	// Returns the total number of simulation ticks skipped because the frames took too long to catch up with them.
+	uint64_t GetDroppedTickCount() const;
+};
+
+#endif
@@ -69,7 +69,7 @@ bool InputSystem::WasMouseButtonPressed(MouseCode button) const
 const glm::vec2& InputSystem::GetCursorPosition() const
 {
     if (!m_focusedWindow)
-        LoggingSystem::GetInstance().Output("Cursor position may be invalid, no focused window set.", LoggingSystem::Severity::WARNING);
+        LOG_WARNING_RATE_LIMITED("Cursor position may be invalid, no focused window set.");
 
     return Input::currentCursorPos;
 }
@@ -77,7 +77,7 @@ const glm::vec2& InputSystem::GetCursorPosition() const
 const glm::vec2& InputSystem::GetMouseScrollOffset() const
 {
     if (!m_focusedWindow)
-        LoggingSystem::GetInstance().Output("Mouse scroll offset may be invalid, no focused window set.", LoggingSystem::Severity::WARNING);
+        LOG_WARNING_RATE_LIMITED("Mouse scroll offset may be invalid, no focused window set.");
 
     return Input::mouseScrollOffset;
 }
@@ -0,0 +1,306 @@
+#include <core/job_system.h>
+#include <util/profiler.h>
+#include <util/logging_system.h>
+#include <util/formatted_exception.h>
+
+#include <string>
+#include <algorithm>
+
+namespace Jobs
+{
+    // The number of jobs each thread's deque can hold, any more are put in the shared queue.
+    constexpr size_t dequeCapacity = 4096;
+
+    // The number of times Wait() yields when there are no jobs to run before it sleeps, since the jobs being run by other 
+    // threads often finish within a few time slices.
+    constexpr uint32_t waitSpinCount = 64;
+
+    // The index of the calling thread's deque, or -1 if the thread doesn't have one.
+    static thread_local int32_t threadDequeIndex = -1;
+
+    // The state of the random number generator used to pick which deque to steal from.
+    static thread_local uint32_t stealRandomState = 0x9E3779B9;
+
+    // Returns the next number from a xorshift random number generator.
+    static uint32_t NextStealRandom()
+    {
+        stealRandomState ^= stealRandomState << 13;
+        stealRandomState ^= stealRandomState >> 17;
+        stealRandomState ^= stealRandomState << 5;
+        return stealRandomState;
+    }
+}
+
+JobSystem::JobSystem() :
+    m_parkedJobCount(0), m_queuedJobCount(0), m_sleepingThreadCount(0), m_running(false)
+{}
+
+JobSystem::~JobSystem()
+{
+    this->Shutdown();
+}
+
+void JobSystem::WorkerMain(uint32_t workerIndex)
+{
+    Jobs::threadDequeIndex = (int32_t)workerIndex;
+    Jobs::stealRandomState += workerIndex * 0x6D2B79F5;
+    Profiler::GetInstance().SetThreadName("Worker " + std::to_string(workerIndex));
+
+    while (m_running.load(std::memory_order_acquire))
+    {
+        if (this->RunPendingJob())
+            continue;
+
+        // Sleep until more jobs are queued
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepingThreadCount.fetch_add(1);
+        m_sleepCondition.wait(lock, [this]() { return m_queuedJobCount.load() > 0 || !m_running.load(); });
+        m_sleepingThreadCount.fetch_sub(1);
+    }
+}
+
+void JobSystem::QueueJob(Job* job, bool sharedQueue)
+{
+    const int32_t dequeIndex = Jobs::threadDequeIndex;
+    if (sharedQueue || dequeIndex < 0 || dequeIndex >= (int32_t)m_workerDeques.size() || !m_workerDeques[dequeIndex]->Push(job))
+    {
+        std::lock_guard<std::mutex> lock(m_sharedQueueMutex);
+        m_sharedQueue.push_back(job);
+    }
+
+    // Wake up a sleeping thread to run the job
+    // Both counters are sequentially consistent, so either this thread sees the sleeping thread, or that thread sees the job
+    m_queuedJobCount.fetch_add(1);
+    if (m_sleepingThreadCount.load() > 0)
+    {
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_sleepCondition.notify_one();
+    }
+}
+
+void JobSystem::QueueOrParkJob(Job* job)
+{
+    if (job->m_dependency)
+    {
+        // The parked job count is raised before the dependency is checked, and counters are lowered before the parked job count
+        // is checked (all sequentially consistent), so either the dependency is seen to be complete here or the thread which
+        // completes it sees the parked job and releases it
+        std::lock_guard<std::mutex> lock(m_parkedJobMutex);
+        m_parkedJobCount.fetch_add(1);
+
+        if (job->m_dependency->m_value.load() > 0)
+        {
+            m_parkedJobs.push_back(job);
+            return;
+        }
+
+        m_parkedJobCount.fetch_sub(1);
+    }
+
+    this->QueueJob(job);
+}
+
+void JobSystem::ReleaseParkedJobs()
+{
+    // Parked jobs may be waiting on other counters too, only the ones whose dependencies are complete are released. Only the
+    // dependencies of parked jobs are read, which Submit() requires to stay alive until those jobs have run
+    std::vector<Job*> releasedJobs;
+    {
+        std::lock_guard<std::mutex> lock(m_parkedJobMutex);
+        auto releasedBegin = std::partition(m_parkedJobs.begin(), m_parkedJobs.end(), [](const Job* job)
+            { return job->m_dependency->m_value.load() > 0; });
+
+        releasedJobs.assign(releasedBegin, m_parkedJobs.end());
+        m_parkedJobs.erase(releasedBegin, m_parkedJobs.end());
+        m_parkedJobCount.fetch_sub((uint32_t)releasedJobs.size());
+    }
+
+    for (Job* job : releasedJobs)
+        this->QueueJob(job, true);
+}
+
+JobSystem::Job* JobSystem::TakeJob()
+{
+    Job* job = nullptr;
+
+    // Try the calling thread's own deque first
+    const int32_t dequeIndex = Jobs::threadDequeIndex;
+    if (dequeIndex >= 0 && dequeIndex < (int32_t)m_workerDeques.size())
+        job = m_workerDeques[dequeIndex]->Pop();
+
+    // Then the shared queue
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(m_sharedQueueMutex);
+        if (!m_sharedQueue.empty())
+        {
+            job = m_sharedQueue.front();
+            m_sharedQueue.pop_front();
+        }
+    }
+
+    // Then try stealing from the other deques, starting from a random one so that thieves spread out
+    if (!job && !m_workerDeques.empty())
+    {
+        const uint32_t dequeCount = (uint32_t)m_workerDeques.size();
+        const uint32_t firstVictim = Jobs::NextStealRandom() % dequeCount;
+
+        for (uint32_t offset = 0; offset < dequeCount && !job; offset++)
+        {
+            const uint32_t victimIndex = (firstVictim + offset) % dequeCount;
+            if ((int32_t)victimIndex != dequeIndex)
+                job = m_workerDeques[victimIndex]->Steal();
+        }
+    }
+
+    if (job)
+        m_queuedJobCount.fetch_sub(1);
+
+    return job;
+}
+
+bool JobSystem::RunPendingJob()
+{
+    Job* job = this->TakeJob();
+    if (!job)
+        return false;
+
+    // There's nowhere to rethrow an exception from a job, so it's logged and the job still counts as finished, otherwise
+    // anything waiting on its counter would never return
+    try
+    {
+        job->m_function();
+    }
+    catch (FormattedException& e)
+    {
+        LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::WARNING, e.GetArgs());
+    }
+    catch (std::exception& e)
+    {
+        LOG_WARNING("A job threw an exception: %s", e.what());
+    }
+
+    // Jobs are only queued once their dependencies are complete, so finishing the last job of a counter may release others
+    const bool counterCompleted = job->m_counter && job->m_counter->m_value.fetch_sub(1) == 1;
+    delete job;
+
+    if (counterCompleted && m_parkedJobCount.load() > 0)
+        this->ReleaseParkedJobs();
+
+    // Wake up the threads sleeping in Wait(), in case one of them is waiting on the counter
+    if (counterCompleted && m_sleepingThreadCount.load() > 0)
+    {
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_sleepCondition.notify_all();
+    }
+
+    return true;
+}
+
+void JobSystem::Init(uint32_t workerCount)
+{
+    if (m_running.load())
+        return;
+
+    if (workerCount == JobSystem::hardwareWorkerCount)
+    {
+        const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+        workerCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 0;
+    }
+
+    // The calling thread gets the first deque, so that it can push jobs without contention and run them while waiting
+    for (uint32_t dequeIndex = 0; dequeIndex <= workerCount; dequeIndex++)
+        m_workerDeques.push_back(std::make_unique<WorkStealingDeque<Job>>(Jobs::dequeCapacity));
+
+    Jobs::threadDequeIndex = 0;
+    m_running.store(true);
+
+    for (uint32_t workerIndex = 1; workerIndex <= workerCount; workerIndex++)
+        m_workerThreads.emplace_back(&JobSystem::WorkerMain, this, workerIndex);
+}
+
+void JobSystem::Shutdown()
+{
+    if (!m_running.load())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_running.store(false);
+    }
+
+    m_sleepCondition.notify_all();
+
+    for (std::thread& workerThread : m_workerThreads)
+        workerThread.join();
+
+    m_workerThreads.clear();
+
+    // The workers have stopped, so the jobs left in the deques can be taken from any thread
+    for (std::unique_ptr<WorkStealingDeque<Job>>& workerDeque : m_workerDeques)
+    {
+        while (Job* job = workerDeque->Steal())
+            delete job;
+    }
+
+    m_workerDeques.clear();
+
+    for (Job* job : m_sharedQueue)
+        delete job;
+
+    m_sharedQueue.clear();
+    m_queuedJobCount.store(0);
+
+    for (Job* job : m_parkedJobs)
+        delete job;
+
+    m_parkedJobs.clear();
+    m_parkedJobCount.store(0);
+    Jobs::threadDequeIndex = -1;
+}
+
+void JobSystem::Submit(JobFunction function, JobCounter* counter, const JobCounter* dependency)
+{
+    if (counter)
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+
+    this->QueueOrParkJob(new Job{ std::move(function), counter, dependency });
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+    uint32_t spinCount = 0;
+    while (!counter.IsComplete())
+    {
+        if (this->RunPendingJob())
+        {
+            spinCount = 0;
+            continue;
+        }
+
+        // The remaining jobs are being run by other threads, so spin for a little while in case they finish soon
+        if (spinCount++ < Jobs::waitSpinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Then sleep until the counter completes or more jobs are queued, the counter is read sequentially consistently like
+        // the other counters are, so either this thread sees it complete or the thread which completes it sees this one
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepingThreadCount.fetch_add(1);
+        m_sleepCondition.wait(lock, [this, &counter]() { return m_queuedJobCount.load() > 0 || counter.m_value.load() == 0; });
+        m_sleepingThreadCount.fetch_sub(1);
+    }
+}
+
+uint32_t JobSystem::GetThreadCount() const
+{
+    return (uint32_t)m_workerThreads.size() + 1;
+}
+
+JobSystem& JobSystem::GetInstance()
+{
+    static JobSystem instance;
+    return instance;
+}
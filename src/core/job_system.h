@@ -0,0 +1,132 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <util/work_stealing_deque.h>
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Counts the number of unfinished jobs which were submitted with it, so that other jobs or threads can wait for them.
+class JobCounter
+{
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> m_value;
+public:
+	JobCounter() :
+		m_value(0)
+	{}
+
+	JobCounter(const JobCounter& other) = delete;
+	JobCounter& operator=(const JobCounter& other) = delete;
+
+	// Returns TRUE if every job submitted with the counter has finished.
+	bool IsComplete() const
+	{
+		return m_value.load(std::memory_order_acquire) == 0;
+	}
+};
+
+// Runs jobs across a pool of worker threads, one per CPU core (with the main thread counted as one of them).
+// Each worker has its own work-stealing deque, jobs are pushed and popped there without contention and idle workers steal 
+// from the deques of busy ones. Threads which aren't workers submit their jobs into a shared queue instead.
+class JobSystem
+{
+public:
+	using JobFunction = std::function<void()>;
+private:
+	struct Job
+	{
+		JobFunction m_function;
+		JobCounter* m_counter; // Decremented once the job has finished, may be nullptr
+		const JobCounter* m_dependency; // The job isn't run until this is complete, may be nullptr
+	};
+
+	// The worker threads, along with a deque for each worker and one for the thread which initialized the job system
+	std::vector<std::thread> m_workerThreads;
+	std::vector<std::unique_ptr<WorkStealingDeque<Job>>> m_workerDeques;
+
+	std::mutex m_sharedQueueMutex;
+	std::deque<Job*> m_sharedQueue; // Jobs submitted by threads which don't have their own deque, and released parked jobs
+
+	std::mutex m_parkedJobMutex;
+	std::vector<Job*> m_parkedJobs; // Jobs waiting on a dependency, which aren't queued until it's complete
+	std::atomic<uint32_t> m_parkedJobCount;
+
+	std::mutex m_sleepMutex;
+	std::condition_variable m_sleepCondition;
+	std::atomic<uint32_t> m_queuedJobCount; // The number of jobs which have been submitted but not yet taken by a thread
+	std::atomic<uint32_t> m_sleepingThreadCount; // Both idle workers and threads blocked in Wait()
+	std::atomic<bool> m_running;
+
+	JobSystem();
+
+	// The main function of each worker thread.
+	void WorkerMain(uint32_t workerIndex);
+
+	// Queues the job on the calling thread's deque, or in the shared queue if the thread doesn't have one (or if it's forced to).
+	void QueueJob(Job* job, bool sharedQueue = false);
+
+	// Queues the job straight away if its dependency is complete, otherwise parks it until the dependency completes.
+	void QueueOrParkJob(Job* job);
+
+	// Moves the parked jobs whose dependencies have completed into the shared queue.
+	// Called whenever a counter reaches zero, since any parked job could be waiting on it.
+	void ReleaseParkedJobs();
+
+	// Returns a job which is ready to run, taken from the calling thread's deque, the shared queue or another thread's deque.
+	// Returns nullptr if there are no jobs to run.
+	Job* TakeJob();
+
+	// Runs a single job if one is ready, returns FALSE if there were no jobs to run.
+	bool RunPendingJob();
+public:
+	// Passed to Init() to start one worker for each hardware thread apart from the calling one.
+	static constexpr uint32_t hardwareWorkerCount = UINT32_MAX;
+
+	~JobSystem();
+
+	// Starts the given number of worker threads, in addition to the calling thread which also runs jobs while waiting.
+	// If 0 is given, then no workers are started and every job is run by the calling thread while it waits.
+	void Init(uint32_t workerCount = hardwareWorkerCount);
+
+	// Waits for the worker threads to finish their current jobs and stops them.
+	// Any jobs which haven't started yet, queued or parked, are discarded without being run.
+	void Shutdown();
+
+	// Queues the function to be run by a worker.
+	// If a counter is given, it's incremented now and decremented once the job has finished.
+	// If a dependency is given, the job won't be run until every job submitted with the dependency counter has finished. Until
+	// then the job is parked rather than queued, so threads never pick it up just to put it back.
+	// Note that the dependency counter is read whenever parked jobs are checked, so it must stay alive until the job has run.
+	void Submit(JobFunction function, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr);
+
+	// Runs other jobs until every job submitted with the counter has finished.
+	// If there are none left to run, the calling thread sleeps until the counter completes or more jobs are queued.
+	void Wait(const JobCounter& counter);
+
+	// Calls the function with consecutive ranges [begin, end) covering the indices [0, count), in parallel across the workers.
+	// Each range holds the given batch size of indices (apart from the last) and starts at a multiple of the batch size.
+	// Returns once the function has been called for every range.
+	template<typename Function>
+	void ParallelFor(size_t count, size_t batchSize, Function function);
+
+	// Returns the number of threads which run jobs, including the thread which initialized the job system.
+	uint32_t GetThreadCount() const;
+
+	// Returns singleton instance of the class.
+	static JobSystem& GetInstance();
+};
+
+#include <core/job_system.tpp>
+
+#endif
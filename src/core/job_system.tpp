@@ -0,0 +1,23 @@
+template<typename Function>
+void JobSystem::ParallelFor(size_t count, size_t batchSize, Function function)
+{
+    if (count == 0)
+        return;
+
+    // Run small loops (or all loops if there are no workers) on the calling thread, as it's not worth splitting them
+    if (batchSize == 0 || count <= batchSize || m_workerThreads.empty())
+    {
+        function((size_t)0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = batchSize; begin < count; begin += batchSize)
+    {
+        const size_t end = (count - begin > batchSize) ? begin + batchSize : count;
+        this->Submit([&function, begin, end]() { function(begin, end); }, &counter);
+    }
+
+    function((size_t)0, batchSize); // The calling thread takes the first batch itself
+    this->Wait(counter);
+}
@@ -0,0 +1,185 @@
+#include <core/render_thread.h>
+#include <util/formatted_exception.h>
+#include <util/profiler.h>
+#include <util/frame_stats.h>
+
+#include <GLFW/glfw3.h>
+
+namespace RenderThreadParams
+{
+    // The number of times either thread yields while waiting for a packet to be handed over or taken before it sleeps, since
+    // the other thread is usually only a moment away.
+    constexpr uint32_t handoverSpinCount = 64;
+}
+
+RenderThread::RenderThread() :
+    m_nextFrameIndex(1), m_frame(nullptr), m_running(false), m_renderedFrameCount(0)
+{}
+
+RenderThread::~RenderThread()
+{
+    // Reached without Stop() when an exception unwinds the simulation thread, the context still has to be handed back so that
+    // the GPU resources destroyed afterwards are freed with it current
+    if (m_thread.joinable())
+    {
+        m_running.store(false, std::memory_order_release);
+        this->NotifyHandover();
+
+        m_thread.join();
+        m_frame->SetContextActive();
+    }
+}
+
+void RenderThread::ThreadMain()
+{
+    Profiler::GetInstance().SetThreadName("Render");
+    m_frame->SetContextActive();
+
+    try
+    {
+        uint32_t spinCount = 0;
+        while (m_running.load(std::memory_order_acquire))
+        {
+            // Wait for the simulation thread to hand over the next packet, spinning for a little while before sleeping
+            if (!m_packets.Acquire())
+            {
+                if (spinCount++ < RenderThreadParams::handoverSpinCount)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(m_handoverMutex);
+                m_handoverCondition.wait(lock, [this]() 
+                    { return m_packets.IsPending() || !m_running.load(std::memory_order_acquire); });
+
+                continue;
+            }
+
+            spinCount = 0;
+            this->NotifyHandover(); // The simulation thread may be waiting to hand over its next packet
+
+            // The time is added to the frame the packet was recorded during, rather than the one being simulated now
+            const FramePacket& packet = m_packets.GetFront();
+            {
+                SubsystemTimer renderTimer(FrameStats::Subsystem::RENDER, packet.m_frameIndex);
+                m_renderFunction(packet);
+            }
+
+            {
+                SubsystemTimer swapTimer(FrameStats::Subsystem::SWAP, packet.m_frameIndex);
+                m_frame->Update();
+            }
+
+            m_renderedFrameCount.fetch_add(1, std::memory_order_release);
+        }
+    }
+    catch (...)
+    {
+        m_exception = std::current_exception();
+        m_running.store(false, std::memory_order_release);
+        this->NotifyHandover();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::NotifyHandover()
+{
+    // Taking the lock makes sure the other thread is either asleep already or yet to check whether it should sleep
+    { std::lock_guard<std::mutex> lock(m_handoverMutex); }
+    m_handoverCondition.notify_one();
+}
+
+void RenderThread::RethrowException()
+{
+    // The exception is written before the render thread stops running, so it's only read once the thread has stopped
+    if (m_running.load(std::memory_order_acquire))
+        return;
+
+    // The render thread released the context when it stopped, so it's made current here again like Stop() does
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+        m_frame->SetContextActive();
+    }
+
+    if (m_exception)
+    {
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void RenderThread::Start(const WindowFrame& frame, const RenderFunction& renderFunction)
+{
+    if (m_thread.joinable())
+        throw FormattedException("The render thread has already been started.");
+
+    m_frame = &frame;
+    m_renderFunction = renderFunction;
+
+    glfwMakeContextCurrent(nullptr); // A context can only be current on one thread at a time
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&RenderThread::ThreadMain, this);
+}
+
+void RenderThread::Stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_running.store(false, std::memory_order_release);
+    this->NotifyHandover();
+    m_thread.join();
+
+    m_frame->SetContextActive();
+    this->RethrowException();
+}
+
+FramePacket& RenderThread::BeginPacket()
+{
+    FramePacket& packet = m_packets.GetBack();
+    packet.m_frameIndex = m_nextFrameIndex;
+    packet.m_drawCommands.clear();
+
+    return packet;
+}
+
+void RenderThread::SubmitPacket()
+{
+    PROFILE_SCOPE("RenderThread::SubmitPacket");
+
+    // Don't get more than one packet ahead of the render thread, otherwise frames would be recorded only to be replaced
+    // Spin for a little while first, then sleep until the render thread takes the packet
+    for (uint32_t spinCount = 0; m_packets.IsPending() && m_running.load(std::memory_order_acquire); spinCount++)
+    {
+        if (spinCount < RenderThreadParams::handoverSpinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_handoverMutex);
+        m_handoverCondition.wait(lock, [this]() 
+            { return !m_packets.IsPending() || !m_running.load(std::memory_order_acquire); });
+    }
+
+    this->RethrowException();
+
+    FrameStats::GetInstance().SetFrameIndex(m_packets.GetBack().m_frameIndex);
+    m_packets.Publish();
+    this->NotifyHandover();
+    ++m_nextFrameIndex;
+}
+
+bool RenderThread::IsRunning() const
+{
+    return m_running.load(std::memory_order_acquire);
+}
+
+uint64_t RenderThread::GetRenderedFrameCount() const
+{
+    return m_renderedFrameCount.load(std::memory_order_acquire);
+}
@@ -0,0 +1,82 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <core/window_frame.h>
+#include <graphics/frame_packet.h>
+#include <util/triple_buffer.h>
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <cstdint>
+
+// Runs all the rendering on a dedicated thread which owns the window's OpenGL context, so the simulation of the next frame 
+// overlaps the submission of the current one.
+// The simulation thread records each frame into a frame packet and hands it over through a triple buffer, so neither thread
+// takes a lock. The render thread renders the latest packet handed over and swaps the window's buffers, if the simulation 
+// gets a whole packet ahead then it waits for the render thread to take it before handing over the next.
+// Note that once started, no other thread may make OpenGL calls (including creating or destroying GPU resources) until stopped.
+class RenderThread
+{
+public:
+	// Called on the render thread to render each frame packet, before the window's buffers are swapped.
+	using RenderFunction = std::function<void(const FramePacket& packet)>;
+private:
+	TripleBuffer<FramePacket> m_packets;
+	uint64_t m_nextFrameIndex; // Only accessed by the simulation thread
+
+	const WindowFrame* m_frame;
+	RenderFunction m_renderFunction;
+
+	std::thread m_thread;
+	std::atomic<bool> m_running;
+	std::atomic<uint64_t> m_renderedFrameCount;
+	std::exception_ptr m_exception; // The exception which stopped the render thread, rethrown on the simulation thread
+
+	// Either thread sleeps on this once it has spun for a while waiting for a packet to be handed over or taken
+	std::mutex m_handoverMutex;
+	std::condition_variable m_handoverCondition;
+
+	// The main function of the render thread.
+	void ThreadMain();
+
+	// Wakes the other thread if it's sleeping, called after a packet is handed over or taken, or the render thread stops.
+	void NotifyHandover();
+
+	// Rethrows the exception which stopped the render thread, if there was one.
+	void RethrowException();
+public:
+	RenderThread();
+	RenderThread(const RenderThread& other) = delete;
+
+	~RenderThread();
+
+	RenderThread& operator=(const RenderThread& other) = delete;
+
+	// Releases the window's OpenGL context from the calling thread and starts the render thread, which makes it current there.
+	void Start(const WindowFrame& frame, const RenderFunction& renderFunction);
+
+	// Waits for the render thread to finish its current packet and stops it, then makes the window's OpenGL context current 
+	// on the calling thread again.
+	void Stop();
+
+	// Returns the packet to record the next frame into, with its draw commands cleared.
+	// This and SubmitPacket() must only be called by the thread which started the render thread.
+	FramePacket& BeginPacket();
+
+	// Hands the packet returned by BeginPacket() over to the render thread.
+	// If the previous packet hasn't been taken by the render thread yet, this waits until it has.
+	// Any exception thrown on the render thread is rethrown here.
+	void SubmitPacket();
+
+	// Returns TRUE if the render thread is running.
+	bool IsRunning() const;
+
+	// Returns the number of frame packets which have been rendered.
+	uint64_t GetRenderedFrameCount() const;
+};
+
+#endif
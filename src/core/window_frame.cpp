@@ -1,26 +1,38 @@
 #include <core/window_frame.h>
 #include <util/logging_system.h>
 #include <util/formatted_exception.h>
+#include <util/profiler.h>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <algorithm>
 
 WindowFrame::WindowFrame() :
-	m_resizable(false), m_fullscreen(false), m_vsync(false), m_windowStruct(nullptr)
+	m_resizable(false), m_fullscreen(false), m_vsync(false), m_headless(false), m_windowStruct(nullptr)
 {}
 
-WindowFrame::WindowFrame(std::string_view title, const glm::ivec2& size, bool resizable, bool fullscreen, bool vsync) :
-	m_resizable(resizable), m_fullscreen(fullscreen), m_vsync(vsync), m_windowStruct(nullptr)
+WindowFrame::WindowFrame(std::string_view title, const glm::ivec2& size, bool resizable, bool fullscreen, bool vsync, bool headless) :
+	m_resizable(resizable), m_fullscreen(fullscreen && !headless), m_vsync(vsync), m_headless(headless), m_windowStruct(nullptr)
 {
 	// Setup the window hints
+	glfwDefaultWindowHints();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_RESIZABLE, resizable);
 
+	if (headless)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#if !defined(_PLATFORM_WINDOWS) && !defined(_PLATFORM_MACOSX)
+		// EGL contexts can be created without a display server, which GLX contexts can't
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#endif
+	}
+
 	// Create the window struct object
-	m_windowStruct = fullscreen ? glfwCreateWindow(size.x, size.y, title.data(), glfwGetPrimaryMonitor(), nullptr) :
+	m_windowStruct = m_fullscreen ? glfwCreateWindow(size.x, size.y, title.data(), glfwGetPrimaryMonitor(), nullptr) :
 		glfwCreateWindow(size.x, size.y, title.data(), nullptr, nullptr);
 
 	if (!m_windowStruct)
@@ -31,9 +43,10 @@ WindowFrame::WindowFrame(std::string_view title, const glm::ivec2& size, bool re
 	if (m_vsync)
 		glfwSwapInterval(1);
 
-	// Position the window at the centre of the monitor
-	const GLFWvidmode* monitorInfo = glfwGetVideoMode(glfwGetPrimaryMonitor());
-	glfwSetWindowPos(m_windowStruct, (monitorInfo->width - size.x) / 2, (monitorInfo->height - size.y) / 2);
+	// Position the window at the centre of the monitor, headless windows may not have a monitor to be positioned on
+	const GLFWvidmode* monitorInfo = headless ? nullptr : glfwGetVideoMode(glfwGetPrimaryMonitor());
+	if (monitorInfo)
+		glfwSetWindowPos(m_windowStruct, (monitorInfo->width - size.x) / 2, (monitorInfo->height - size.y) / 2);
 
 	// Load the addresses for all the OpenGL functions
 	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
@@ -43,7 +56,8 @@ WindowFrame::WindowFrame(std::string_view title, const glm::ivec2& size, bool re
 }
 
 WindowFrame::WindowFrame(WindowFrame&& temp) noexcept :
-	m_windowStruct(temp.m_windowStruct), m_fullscreen(temp.m_fullscreen), m_resizable(temp.m_resizable), m_vsync(temp.m_vsync)
+	m_windowStruct(temp.m_windowStruct), m_fullscreen(temp.m_fullscreen), m_resizable(temp.m_resizable), m_vsync(temp.m_vsync),
+	m_headless(temp.m_headless)
 {
 	temp.m_windowStruct = nullptr;
 }
@@ -60,11 +74,26 @@ WindowFrame& WindowFrame::operator=(WindowFrame&& temp) noexcept
 	m_fullscreen = temp.m_fullscreen;
 	m_resizable = temp.m_resizable;
 	m_vsync = temp.m_vsync;
+	m_headless = temp.m_headless;
 
 	temp.m_windowStruct = nullptr;
 	return *this;
 }
 
+void WindowFrame::InitLibrary(bool headless)
+{
+#ifdef GLFW_PLATFORM_NULL
+	// GLFW 3.4 onwards has a platform which doesn't need a display server at all
+	if (headless)
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+	(void)headless;
+#endif
+
+	if (!glfwInit())
+		throw FormattedException("Failed to initialize the GLFW library");
+}
+
 void WindowFrame::SetPosition(const glm::ivec2& pos)
 {
 	glfwSetWindowPos(m_windowStruct, pos.x, pos.y);
@@ -92,6 +121,7 @@ void WindowFrame::RequestClose() const
 
 void WindowFrame::Update() const
 {
+	PROFILE_SCOPE("WindowFrame::Update");
 	glfwSwapBuffers(m_windowStruct);
 }
 
@@ -139,6 +169,11 @@ bool WindowFrame::IsVSyncEnabled() const
 	return m_vsync;
 }
 
+bool WindowFrame::IsHeadless() const
+{
+	return m_headless;
+}
+
 GLFWwindow* WindowFrame::GetFrameStruct() const
 {
 	return m_windowStruct;
@@ -10,10 +10,14 @@ class WindowFrame
 {
 private:
 	GLFWwindow* m_windowStruct;
-	bool m_resizable, m_fullscreen, m_vsync;
+	bool m_resizable, m_fullscreen, m_vsync, m_headless;
 public:
 	WindowFrame();
-	WindowFrame(std::string_view title, const glm::ivec2& size, bool resizable, bool fullscreen, bool vsync);
+
+	// Creates a window with an OpenGL 3.3 core context.
+	// A headless window is never shown and isn't tied to a monitor, so it can be rendered offscreen on machines without a display
+	// (e.g. with Mesa's llvmpipe). Headless windows are never fullscreen.
+	WindowFrame(std::string_view title, const glm::ivec2& size, bool resizable, bool fullscreen, bool vsync, bool headless = false);
 	WindowFrame(const WindowFrame& other) = delete;
 	WindowFrame(WindowFrame&& temp) noexcept;
 
@@ -22,6 +26,10 @@ public:
 	WindowFrame& operator=(const WindowFrame& other) = delete;
 	WindowFrame& operator=(WindowFrame&& temp) noexcept;
 
+	// Initializes the GLFW library, this must be called before any windows are created.
+	// If headless windows are going to be used, then GLFW is set up to run without a display where supported.
+	static void InitLibrary(bool headless = false);
+
 	// Sets the position of the window.
 	void SetPosition(const glm::ivec2& pos);
 
@@ -64,6 +72,9 @@ public:
 	// Returns TRUE if the window has VSync enabled.
 	bool IsVSyncEnabled() const;
 
+	// Returns TRUE if the window is headless.
+	bool IsHeadless() const;
+
 	// Returns pointer to the GLFWwindow struct.
 	GLFWwindow* GetFrameStruct() const;
 };
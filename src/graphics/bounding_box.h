@@ -0,0 +1,12 @@
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include <glm/glm.hpp>
+
+// An axis-aligned bounding box.
+struct BoundingBox
+{
+	glm::vec3 m_min = glm::vec3(0.0f), m_max = glm::vec3(0.0f);
+};
+
+#endif
@@ -5,19 +5,23 @@
 
 Camera3D::Camera3D() :
     m_position(glm::vec3(0.0f)), m_frontDir(glm::vec3(0.0f)), m_prevCursorPosition(glm::vec2(0.0f)), m_eulerAngles(glm::vec2(0.0f)), 
-    m_sensitivity(0.0f), m_fov(0.0f), m_cursorSynced(false)
+    m_sensitivity(0.0f), m_fov(0.0f), m_nearPlane(0.1f), m_farPlane(1000.0f), m_cursorSynced(false)
 {}
 
 Camera3D::Camera3D(const glm::vec3& pos, const glm::vec2& size, float fov, float sensitivity) :
     m_position(pos), CameraBase(size), m_frontDir({ 0.0f, 0.0f, -1.0f }), m_prevCursorPosition(glm::vec2(0.0f)),
-    m_sensitivity(sensitivity), m_fov(glm::radians(fov)), m_cursorSynced(false)
+    m_sensitivity(sensitivity), m_fov(glm::radians(fov)), m_nearPlane(0.1f), m_farPlane(1000.0f), m_cursorSynced(false)
 {
     m_eulerAngles = { m_frontDir.z * 90.0f, 0.0f };
 }
 
 void Camera3D::SetPosition(const glm::vec3& pos)
 {
-    m_position = pos;
+    if (pos != m_position)
+    {
+        m_position = pos;
+        this->MarkViewDirty();
+    }
 }
 
 void Camera3D::SetSensitivity(float value)
@@ -28,6 +32,14 @@ void Camera3D::SetSensitivity(float value)
 void Camera3D::SetFOV(float degrees)
 {
     m_fov = glm::radians(degrees);
+    this->MarkProjectionDirty();
+}
+
+void Camera3D::SetClipPlanes(float nearPlane, float farPlane)
+{
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+    this->MarkProjectionDirty();
 }
 
 void Camera3D::Update()
@@ -44,13 +56,16 @@ void Camera3D::Update()
     const glm::vec2 cursorOffset = { currentCursorPosition.x - m_prevCursorPosition.x, m_prevCursorPosition.y - currentCursorPosition.y };
     m_prevCursorPosition = currentCursorPosition;
 
-    m_eulerAngles.x += (cursorOffset.x * m_sensitivity); // Yaw
-    m_eulerAngles.y += (cursorOffset.y * m_sensitivity); // Pitch
+    if (cursorOffset.x == 0.0f && cursorOffset.y == 0.0f) // The camera hasn't turned so there is nothing to update
+        return;
 
-    if (m_eulerAngles.y > 89.0) // Constrain pitch values
-        m_eulerAngles.y = 89.0;
-    else if (m_eulerAngles.y < -89.0)
-        m_eulerAngles.y = -89.0;
+    this->SetRotation(m_eulerAngles.x + (cursorOffset.x * m_sensitivity), m_eulerAngles.y + (cursorOffset.y * m_sensitivity));
+}
+
+void Camera3D::SetRotation(float yaw, float pitch)
+{
+    m_eulerAngles.x = yaw;
+    m_eulerAngles.y = glm::clamp(pitch, -89.0f, 89.0f); // Constrain pitch values
 
     // Calculate new camera front direction vector
     glm::vec3 newFrontDir = glm::vec3(0.0f);
@@ -59,16 +74,29 @@ void Camera3D::Update()
     newFrontDir.z = (float)(glm::cos(glm::radians(m_eulerAngles.y)) * glm::sin(glm::radians(m_eulerAngles.x)));
 
     m_frontDir = glm::normalize(newFrontDir);
+    this->MarkViewDirty();
 }
 
 glm::mat4 Camera3D::ComputeViewMatrix() const
 {
-    return glm::lookAt(m_position, m_position + m_frontDir, { 0.0f, 1.0f, 0.0f });
+    if (m_viewDirty)
+    {
+        m_viewMatrix = glm::lookAt(m_position, m_position + m_frontDir, { 0.0f, 1.0f, 0.0f });
+        m_viewDirty = false;
+    }
+
+    return m_viewMatrix;
 }
 
 glm::mat4 Camera3D::ComputeProjectionMatrix() const
 {
-    return glm::perspective(m_fov, m_size.x / m_size.y, 0.1f, 1000.0f);
+    if (m_projectionDirty)
+    {
+        m_projectionMatrix = glm::perspective(m_fov, m_size.x / m_size.y, m_nearPlane, m_farPlane);
+        m_projectionDirty = false;
+    }
+
+    return m_projectionMatrix;
 }
 
 const glm::vec3& Camera3D::GetPosition() const
@@ -90,3 +118,13 @@ float Camera3D::GetFOV() const
 {
     return glm::degrees(m_fov);
 }
+
+float Camera3D::GetNearPlane() const
+{
+    return m_nearPlane;
+}
+
+float Camera3D::GetFarPlane() const
+{
+    return m_farPlane;
+}
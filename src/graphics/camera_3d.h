@@ -8,7 +8,7 @@ class Camera3D : public CameraBase
 private:
 	glm::vec3 m_position, m_frontDir;
 	glm::vec2 m_prevCursorPosition, m_eulerAngles;
-	float m_fov, m_sensitivity;
+	float m_fov, m_sensitivity, m_nearPlane, m_farPlane;
 	bool m_cursorSynced = false;
 public:
 	Camera3D();
@@ -26,13 +26,22 @@ public:
 	// The angle you specify should be in degrees.
 	void SetFOV(float degrees);
 
+	// Sets the distances of the near and far clipping planes of the camera.
+	void SetClipPlanes(float nearPlane, float farPlane);
+
+	// Sets the direction the camera is facing from the given yaw and pitch angles, in degrees.
+	// The pitch is clamped between -89 and 89 degrees.
+	void SetRotation(float yaw, float pitch);
+
 	// Updates the direction the camera is facing based on the movement of the cursor.
 	void Update();
 
 	// Returns the computed camera view matrix.
+	// The matrix is cached and only recomputed after the camera has moved or turned.
 	glm::mat4 ComputeViewMatrix() const override;
 
 	// Returns the computed camera projection matrix.
+	// The matrix is cached and only recomputed after the FOV, size or clipping planes of the camera have changed.
 	glm::mat4 ComputeProjectionMatrix() const override;
 
 	// Returns the position of the camera.
@@ -47,6 +56,12 @@ public:
 	// Returns the FOV angle of the camera.
 	// The angle returned is in degrees.
 	float GetFOV() const;
+
+	// Returns the distance of the near clipping plane of the camera.
+	float GetNearPlane() const;
+
+	// Returns the distance of the far clipping plane of the camera.
+	float GetFarPlane() const;
 };
 
 #endif
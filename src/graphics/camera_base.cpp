@@ -1,19 +1,70 @@
 #include <graphics/camera_base.h>
+#include <atomic>
+
+namespace Camera
+{
+	static std::atomic<uint64_t> revisionCounter = 0;
+}
 
 CameraBase::CameraBase() :
-	m_size(glm::vec2(0.0f))
+	m_size(glm::vec2(0.0f)), m_viewMatrix(1.0f), m_projectionMatrix(1.0f), m_viewDirty(true), m_projectionDirty(true),
+	m_revision(++Camera::revisionCounter)
 {}
 
 CameraBase::CameraBase(const glm::vec2& size) :
-	m_size(size)
+	m_size(size), m_viewMatrix(1.0f), m_projectionMatrix(1.0f), m_viewDirty(true), m_projectionDirty(true),
+	m_revision(++Camera::revisionCounter)
 {}
 
+void CameraBase::MarkViewDirty()
+{
+	m_viewDirty = true;
+	m_revision = ++Camera::revisionCounter;
+}
+
+void CameraBase::MarkProjectionDirty()
+{
+	m_projectionDirty = true;
+	m_revision = ++Camera::revisionCounter;
+}
+
 void CameraBase::SetSize(const glm::vec2& size)
 {
-	m_size = size;
+	if (size != m_size)
+	{
+		m_size = size;
+		this->MarkProjectionDirty();
+	}
+}
+
+std::array<glm::vec4, 6> CameraBase::ComputeFrustumPlanes() const
+{
+	// Extract the planes from the rows of the view projection matrix (Gribb & Hartmann method)
+	const glm::mat4 viewProjection = this->ComputeProjectionMatrix() * this->ComputeViewMatrix();
+	std::array<glm::vec4, 4> rows;
+
+	for (int row = 0; row < 4; row++)
+		rows[row] = { viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row] };
+
+	std::array<glm::vec4, 6> planes =
+	{
+		rows[3] + rows[0], rows[3] - rows[0], // Left, right
+		rows[3] + rows[1], rows[3] - rows[1], // Bottom, top
+		rows[3] + rows[2], rows[3] - rows[2]  // Near, far
+	};
+
+	for (glm::vec4& plane : planes)
+		plane = plane / glm::length(glm::vec3(plane));
+
+	return planes;
 }
 
 const glm::vec2& CameraBase::GetSize() const
 {
 	return m_size;
 }
+
+uint64_t CameraBase::GetRevision() const
+{
+	return m_revision;
+}
@@ -2,11 +2,24 @@
 #define CAMERA_BASE_H
 
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <array>
 
 class CameraBase
 {
 protected:
 	glm::vec2 m_size;
+
+	// Cached camera matrices, these are only recomputed when their dirty flag has been set.
+	mutable glm::mat4 m_viewMatrix, m_projectionMatrix;
+	mutable bool m_viewDirty, m_projectionDirty;
+	uint64_t m_revision;
+
+	// Flags the view matrix as needing to be recomputed and assigns the camera a new revision number.
+	void MarkViewDirty();
+
+	// Flags the projection matrix as needing to be recomputed and assigns the camera a new revision number.
+	void MarkProjectionDirty();
 public:
 	CameraBase();
 	CameraBase(const glm::vec2& size);
@@ -19,8 +32,18 @@ public:
 	virtual glm::mat4 ComputeViewMatrix() const = 0;
 	virtual glm::mat4 ComputeProjectionMatrix() const = 0;
 
+	// Returns the six planes of the camera's view frustum in world space, in the order left, right, bottom, top, near, far.
+	// Each plane is stored as a normalized normal (xyz) pointing into the frustum and a distance (w), so a point p is
+	// inside the plane when dot(plane.xyz, p) + plane.w >= 0.
+	std::array<glm::vec4, 6> ComputeFrustumPlanes() const;
+
 	// Returns the dimension size of the camera.
 	const glm::vec2& GetSize() const;
+
+	// Returns the revision number of the camera's state.
+	// Every change to the camera gives it a new revision number which is unique across all cameras, so if two revision 
+	// numbers match then the cameras (or copies of the same camera) have identical matrices.
+	uint64_t GetRevision() const;
 };
 
 #endif
@@ -0,0 +1,336 @@
+#include <graphics/cooked_mesh.h>
+#include <util/formatted_exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace CookedMeshParams
+{
+    constexpr char fileMagic[4] = { 'M', 'M', 'S', 'H' };
+    constexpr uint32_t fileVersion = 1;
+
+    // The largest value of a 16-bit signed normalized component, which represents 1.
+    constexpr float snorm16Max = 32767.0f;
+
+    // Returns the 16-bit signed normalized encoding of a value between -1 and 1.
+    static int16_t QuantizeSnorm16(float value)
+    {
+        return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * snorm16Max);
+    }
+
+    // Returns the half float closest to the given float, values too large for a half float become infinity.
+    static uint16_t FloatToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        const uint32_t sign = (bits >> 16) & 0x8000;
+        const uint32_t floatExponent = (bits >> 23) & 0xFF;
+        const int32_t exponent = (int32_t)floatExponent - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        if (floatExponent == 0xFF) // Infinity or NaN
+            return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+        if (exponent >= 31)
+            return (uint16_t)(sign | 0x7C00);
+
+        // Values too small for a normal half float become subnormal, or zero if they're too small for that as well
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return (uint16_t)sign;
+
+            mantissa |= 0x800000;
+            const uint32_t shift = (uint32_t)(14 - exponent);
+            const uint32_t roundBit = (mantissa >> (shift - 1)) & 1;
+
+            return (uint16_t)(sign | ((mantissa >> shift) + roundBit));
+        }
+
+        // Rounding up can carry into the exponent, which still gives the right result
+        const uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+        return (uint16_t)(half + ((mantissa >> 12) & 1));
+    }
+
+    // Encodes the unit vector by projecting it onto an octahedron, which is then unfolded onto a square.
+    static void EncodeOctahedral(const glm::vec3& normal, int16_t encoded[2])
+    {
+        const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        glm::vec2 projected = length > 0.0f ? glm::vec2(normal.x, normal.y) / length : glm::vec2(0.0f);
+
+        // Fold the lower half of the octahedron over the upper half
+        if (normal.z < 0.0f)
+        {
+            projected = (glm::vec2(1.0f) - glm::abs(glm::vec2(projected.y, projected.x))) *
+                glm::vec2(projected.x >= 0.0f ? 1.0f : -1.0f, projected.y >= 0.0f ? 1.0f : -1.0f);
+        }
+
+        encoded[0] = QuantizeSnorm16(projected.x);
+        encoded[1] = QuantizeSnorm16(projected.y);
+    }
+
+    // Returns the normal of each vertex, the average of the normals of the triangles which use the vertex.
+    static std::vector<glm::vec3> ComputeNormals(const GeometryPool::Vertex* vertices, uint32_t vertexCount,
+        const uint32_t* indices, uint32_t indexCount)
+    {
+        // The cross products are left unnormalized, so that larger triangles have more weight
+        std::vector<glm::vec3> normals(vertexCount, glm::vec3(0.0f));
+        for (uint32_t index = 0; index + 2 < indexCount; index += 3)
+        {
+            const glm::vec3& a = vertices[indices[index]].m_position;
+            const glm::vec3& b = vertices[indices[index + 1]].m_position;
+            const glm::vec3& c = vertices[indices[index + 2]].m_position;
+            const glm::vec3 triangleNormal = glm::cross(b - a, c - a);
+
+            normals[indices[index]] += triangleNormal;
+            normals[indices[index + 1]] += triangleNormal;
+            normals[indices[index + 2]] += triangleNormal;
+        }
+
+        // Vertices which aren't part of any triangle with an area face along the z axis
+        for (glm::vec3& normal : normals)
+            normal = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+        return normals;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CookedMesh::CookedMesh() :
+    m_header()
+{}
+
+CookedMesh CookedMesh::Cook(const GeometryPool::Vertex* vertices, const glm::vec3* normals, uint32_t vertexCount,
+    const uint32_t* indices, uint32_t indexCount)
+{
+    if (!vertices || !indices || vertexCount == 0 || indexCount == 0)
+        throw FormattedException("The mesh given to be cooked has no vertices or indices.");
+
+    for (uint32_t index = 0; index < indexCount; index++)
+    {
+        if (indices[index] >= vertexCount)
+        {
+            throw FormattedException("Index %u of the mesh given to be cooked refers to vertex %u, however the mesh only has %u "
+                "vertices.", index, indices[index], vertexCount);
+        }
+    }
+
+    // The positions are quantized within the bounds of the mesh
+    glm::vec3 boundsMin = vertices[0].m_position, boundsMax = vertices[0].m_position;
+    for (uint32_t vertexIndex = 1; vertexIndex < vertexCount; vertexIndex++)
+    {
+        boundsMin = glm::min(boundsMin, vertices[vertexIndex].m_position);
+        boundsMax = glm::max(boundsMax, vertices[vertexIndex].m_position);
+    }
+
+    const glm::vec3 positionScale = (boundsMax - boundsMin) * 0.5f;
+    const glm::vec3 positionOffset = (boundsMax + boundsMin) * 0.5f;
+
+    CookedMesh mesh;
+    Header& header = mesh.m_header;
+    std::memcpy(header.m_magic, CookedMeshParams::fileMagic, sizeof(header.m_magic));
+    header.m_version = CookedMeshParams::fileVersion;
+    header.m_vertexCount = vertexCount;
+    header.m_indexCount = indexCount;
+    header.m_indexSize = vertexCount <= (uint32_t)std::numeric_limits<uint16_t>::max() + 1 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        header.m_positionScale[axis] = positionScale[axis];
+        header.m_positionOffset[axis] = positionOffset[axis];
+    }
+
+    const std::vector<glm::vec3> computedNormals = normals ? std::vector<glm::vec3>() :
+        CookedMeshParams::ComputeNormals(vertices, vertexCount, indices, indexCount);
+
+    // Lay out the file, with the vertices straight after the header followed by the indices
+    const size_t vertexDataSize = (size_t)vertexCount * sizeof(GeometryPool::QuantizedVertex);
+    mesh.m_fileData.resize(sizeof(Header) + vertexDataSize + (size_t)indexCount * header.m_indexSize);
+    std::memcpy(mesh.m_fileData.data(), &header, sizeof(Header));
+
+    GeometryPool::QuantizedVertex* quantizedVertices = (GeometryPool::QuantizedVertex*)(mesh.m_fileData.data() + sizeof(Header));
+    for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+    {
+        const GeometryPool::Vertex& vertex = vertices[vertexIndex];
+        GeometryPool::QuantizedVertex& quantizedVertex = quantizedVertices[vertexIndex];
+
+        // Axes along which the mesh is flat are left at 0, which the offset alone restores
+        for (int axis = 0; axis < 3; axis++)
+        {
+            quantizedVertex.m_position[axis] = positionScale[axis] > 0.0f ?
+                CookedMeshParams::QuantizeSnorm16((vertex.m_position[axis] - positionOffset[axis]) / positionScale[axis]) : 0;
+        }
+
+        quantizedVertex.m_position[3] = 0;
+        quantizedVertex.m_uvCoords[0] = CookedMeshParams::FloatToHalf(vertex.m_uvCoords.x);
+        quantizedVertex.m_uvCoords[1] = CookedMeshParams::FloatToHalf(vertex.m_uvCoords.y);
+        const glm::vec3& normal = normals ? normals[vertexIndex] : computedNormals[vertexIndex];
+        CookedMeshParams::EncodeOctahedral(normal, quantizedVertex.m_normal);
+    }
+
+    uint8_t* indexData = mesh.m_fileData.data() + sizeof(Header) + vertexDataSize;
+    if (header.m_indexSize == sizeof(uint16_t))
+    {
+        for (uint32_t index = 0; index < indexCount; index++)
+        {
+            const uint16_t shortIndex = (uint16_t)indices[index];
+            std::memcpy(indexData + index * sizeof(uint16_t), &shortIndex, sizeof(uint16_t));
+        }
+    }
+    else
+        std::memcpy(indexData, indices, (size_t)indexCount * sizeof(uint32_t));
+
+    mesh.m_file = { mesh.m_fileData.data(), mesh.m_fileData.size() };
+    return mesh;
+}
+
+CookedMesh CookedMesh::Load(const std::string& filePath)
+{
+    FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file)
+        throw FormattedException("Failed to open the cooked mesh file at path: %s.", filePath.c_str());
+
+    std::vector<uint8_t> fileData;
+    std::fseek(file, 0, SEEK_END);
+    const long fileSize = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+
+    if (fileSize > 0)
+    {
+        fileData.resize((size_t)fileSize);
+        fileData.resize(std::fread(fileData.data(), 1, fileData.size(), file));
+    }
+
+    std::fclose(file);
+    return CookedMesh::FromData(std::move(fileData), filePath);
+}
+
+CookedMesh CookedMesh::FromData(std::vector<uint8_t> fileData, const std::string& filePath)
+{
+    CookedMesh mesh;
+    mesh.m_fileData = std::move(fileData);
+    mesh.m_file = { mesh.m_fileData.data(), mesh.m_fileData.size() };
+    mesh.ParseFileData(filePath);
+    return mesh;
+}
+
+CookedMesh CookedMesh::FromView(ByteView fileData, const std::string& filePath)
+{
+    CookedMesh mesh;
+    mesh.m_file = fileData;
+    mesh.ParseFileData(filePath);
+    return mesh;
+}
+
+void CookedMesh::ParseFileData(const std::string& filePath)
+{
+    if (m_file.m_size < sizeof(Header))
+        throw FormattedException("The cooked mesh file at path: %s, is too small to hold a header.", filePath.c_str());
+
+    std::memcpy(&m_header, m_file.m_data, sizeof(Header));
+    if (std::memcmp(m_header.m_magic, CookedMeshParams::fileMagic, sizeof(m_header.m_magic)) != 0 ||
+        m_header.m_version != CookedMeshParams::fileVersion)
+    {
+        throw FormattedException("The file at path: %s, isn't a cooked mesh of a supported version.", filePath.c_str());
+    }
+
+    const size_t dataSize = (size_t)m_header.m_vertexCount * sizeof(GeometryPool::QuantizedVertex) +
+        (size_t)m_header.m_indexCount * m_header.m_indexSize;
+
+    if (m_header.m_vertexCount == 0 || m_header.m_indexCount == 0 ||
+        (m_header.m_indexSize != sizeof(uint16_t) && m_header.m_indexSize != sizeof(uint32_t)) ||
+        m_file.m_size < sizeof(Header) + dataSize)
+    {
+        throw FormattedException("The header of the cooked mesh file at path: %s, is invalid.", filePath.c_str());
+    }
+
+    // Indices outside of the mesh would read the vertices of other meshes in the pool, or past the end of its buffer
+    const uint8_t* indexData = (const uint8_t*)this->GetIndexData();
+    for (uint32_t index = 0; index < m_header.m_indexCount; index++)
+    {
+        uint32_t vertexIndex = 0;
+        if (m_header.m_indexSize == sizeof(uint16_t))
+        {
+            uint16_t shortIndex;
+            std::memcpy(&shortIndex, indexData + index * sizeof(uint16_t), sizeof(uint16_t));
+            vertexIndex = shortIndex;
+        }
+        else
+            std::memcpy(&vertexIndex, indexData + index * sizeof(uint32_t), sizeof(uint32_t));
+
+        if (vertexIndex >= m_header.m_vertexCount)
+            throw FormattedException("Index %u of the cooked mesh file at path: %s, is out of range.", index, filePath.c_str());
+    }
+}
+
+void CookedMesh::Save(const std::string& filePath) const
+{
+    // Write under a name unique to the thread, in case another thread is writing the same mesh
+    const size_t threadHash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    const std::string temporaryFilePath = filePath + "." + std::to_string(threadHash) + ".tmp";
+
+    FILE* file = std::fopen(temporaryFilePath.c_str(), "wb");
+    if (!file)
+        throw FormattedException("Failed to create the cooked mesh file at path: %s.", temporaryFilePath.c_str());
+
+    const bool written = std::fwrite(m_file.m_data, 1, m_file.m_size, file) == m_file.m_size;
+    const bool closed = std::fclose(file) == 0;
+
+    std::error_code error;
+    if (written && closed)
+        std::filesystem::rename(temporaryFilePath, filePath, error);
+
+    if (!written || !closed || error)
+    {
+        std::filesystem::remove(temporaryFilePath, error);
+        throw FormattedException("Failed to write the cooked mesh file at path: %s.", filePath.c_str());
+    }
+}
+
+uint32_t CookedMesh::GetVertexCount() const
+{
+    return m_header.m_vertexCount;
+}
+
+uint32_t CookedMesh::GetIndexCount() const
+{
+    return m_header.m_indexCount;
+}
+
+uint32_t CookedMesh::GetIndexSize() const
+{
+    return m_header.m_indexSize;
+}
+
+const void* CookedMesh::GetVertexData() const
+{
+    return m_file.m_data + sizeof(Header);
+}
+
+const void* CookedMesh::GetIndexData() const
+{
+    return m_file.m_data + sizeof(Header) + (size_t)m_header.m_vertexCount * sizeof(GeometryPool::QuantizedVertex);
+}
+
+glm::vec3 CookedMesh::GetPositionScale() const
+{
+    return { m_header.m_positionScale[0], m_header.m_positionScale[1], m_header.m_positionScale[2] };
+}
+
+glm::vec3 CookedMesh::GetPositionOffset() const
+{
+    return { m_header.m_positionOffset[0], m_header.m_positionOffset[1], m_header.m_positionOffset[2] };
+}
+
+BoundingBox CookedMesh::GetBounds() const
+{
+    return { this->GetPositionOffset() - this->GetPositionScale(), this->GetPositionOffset() + this->GetPositionScale() };
+}
@@ -0,0 +1,94 @@
+#ifndef COOKED_MESH_H
+#define COOKED_MESH_H
+
+#include <graphics/geometry_pool.h>
+#include <graphics/bounding_box.h>
+#include <util/asset_pack.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// A mesh with quantized vertices, in the layout of a cooked mesh (.mmesh) file.
+// The file is made up of a header followed by the vertices and then the indices, which are ready to be copied straight into a
+// quantized geometry pool (see GeometryPool::QuantizedVertex). Positions are stored as 16-bit signed normalized values within
+// the mesh's bounds, which the shader scales back using the position scale and offset, UVs as half floats and normals with
+// an octahedral encoding. Indices are 16-bit whenever the mesh has few enough vertices, otherwise 32-bit.
+class CookedMesh
+{
+private:
+	// The header at the start of a cooked mesh file, which is followed by the vertices and indices.
+	struct Header
+	{
+		char m_magic[4];
+		uint32_t m_version;
+		uint32_t m_vertexCount, m_indexCount;
+		uint32_t m_indexSize; // 2 or 4 bytes
+		uint32_t m_reserved;
+		float m_positionScale[3], m_positionOffset[3]; // The half size and centre of the bounds of the positions
+	};
+
+	std::vector<uint8_t> m_fileData; // Empty if the file data is owned by something else, such as a mapped asset pack
+	ByteView m_file;
+	Header m_header;
+
+	// Checks that the header at the start of the file data is valid, and that every index refers to one of the vertices.
+	void ParseFileData(const std::string& filePath);
+public:
+	CookedMesh();
+	CookedMesh(const CookedMesh& other) = delete;
+	CookedMesh(CookedMesh&& temp) noexcept = default;
+
+	~CookedMesh() = default;
+
+	CookedMesh& operator=(const CookedMesh& other) = delete;
+	CookedMesh& operator=(CookedMesh&& temp) noexcept = default;
+
+	// Creates a cooked mesh by quantizing the given vertices and picking the smallest index size which fits the mesh.
+	// If no normals are given, they're computed by averaging the normals of the triangles around each vertex, which assumes
+	// the indices are a triangle list.
+	static CookedMesh Cook(const GeometryPool::Vertex* vertices, const glm::vec3* normals, uint32_t vertexCount,
+		const uint32_t* indices, uint32_t indexCount);
+
+	// Loads the cooked mesh file at the given path with a single read.
+	static CookedMesh Load(const std::string& filePath);
+
+	// Returns the cooked mesh in the file data given, taking ownership of the data.
+	// The file path is only used in error messages.
+	static CookedMesh FromData(std::vector<uint8_t> fileData, const std::string& filePath);
+
+	// Returns the cooked mesh in the file data given without copying it, so the data must outlive the cooked mesh.
+	// The file path is only used in error messages.
+	static CookedMesh FromView(ByteView fileData, const std::string& filePath);
+
+	// Writes the cooked mesh to a file at the given path.
+	// The file is written under a temporary name and then renamed, so that it's never read while partially written.
+	void Save(const std::string& filePath) const;
+
+	// Returns the number of vertices in the mesh.
+	uint32_t GetVertexCount() const;
+
+	// Returns the number of indices in the mesh.
+	uint32_t GetIndexCount() const;
+
+	// Returns the size of each index in bytes, either 2 or 4.
+	uint32_t GetIndexSize() const;
+
+	// Returns the quantized vertices, in the format of GeometryPool::QuantizedVertex.
+	const void* GetVertexData() const;
+
+	// Returns the indices, whose size is given by GetIndexSize().
+	const void* GetIndexData() const;
+
+	// Returns the scale which takes the normalized positions back to their original size, the half size of the mesh's bounds.
+	glm::vec3 GetPositionScale() const;
+
+	// Returns the offset added to the scaled positions, the centre of the mesh's bounds.
+	glm::vec3 GetPositionOffset() const;
+
+	// Returns the bounding box of the mesh's vertices.
+	BoundingBox GetBounds() const;
+};
+
+#endif
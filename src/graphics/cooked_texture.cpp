@@ -0,0 +1,574 @@
+#include <graphics/cooked_texture.h>
+#include <util/formatted_exception.h>
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+namespace CookedTextureParams
+{
+    constexpr char fileMagic[4] = { 'M', 'T', 'E', 'X' };
+    constexpr uint32_t fileVersion = 1;
+
+    // The S3TC formats aren't part of core OpenGL, so they aren't defined by the loader.
+    // These come from the EXT_texture_compression_s3tc and EXT_texture_sRGB extensions.
+    constexpr uint32_t compressedRGBFormat = 0x83F0; // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    constexpr uint32_t compressedRGBAFormat = 0x83F3; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    constexpr uint32_t compressedSRGBFormat = 0x8C4C; // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+    constexpr uint32_t compressedSRGBAlphaFormat = 0x8C4F; // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+
+    // The width and height of a compressed block in pixels, and the size of a BC1 color block or BC3 alpha block in bytes.
+    constexpr uint32_t blockDimension = 4;
+    constexpr size_t halfBlockSize = 8;
+
+    // The result of the last compression support query.
+    static std::atomic<bool> compressionSupported(false);
+
+    // Returns the linear intensity of an 8-bit sRGB encoded value.
+    static const std::array<float, 256>& GetSRGBToLinearTable()
+    {
+        static const std::array<float, 256> table = []()
+        {
+            std::array<float, 256> values;
+            for (size_t index = 0; index < values.size(); index++)
+            {
+                const float value = (float)index / 255.0f;
+                values[index] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+
+            return values;
+        }();
+
+        return table;
+    }
+
+    // Returns the 8-bit sRGB encoding of a linear intensity between 0 and 1.
+    static uint8_t LinearToSRGB(float value)
+    {
+        const float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return (uint8_t)std::clamp(encoded * 255.0f + 0.5f, 0.0f, 255.0f);
+    }
+
+    // Returns the next mip level of the given level, made by averaging each 2x2 square of pixels.
+    // If the level has an odd width or height, the last column or row is repeated.
+    static std::vector<uint8_t> DownsampleLevel(const std::vector<uint8_t>& pixels, const glm::ivec2& size,
+        uint32_t channelCount, bool srgb)
+    {
+        const std::array<float, 256>& srgbToLinear = GetSRGBToLinearTable();
+        const glm::ivec2 nextSize = glm::max(size / 2, glm::ivec2(1));
+
+        std::vector<uint8_t> nextPixels((size_t)nextSize.x * nextSize.y * channelCount);
+        for (int y = 0; y < nextSize.y; y++)
+        {
+            const int sourceRows[2] = { std::min(y * 2, size.y - 1), std::min(y * 2 + 1, size.y - 1) };
+            for (int x = 0; x < nextSize.x; x++)
+            {
+                const int sourceColumns[2] = { std::min(x * 2, size.x - 1), std::min(x * 2 + 1, size.x - 1) };
+                for (uint32_t channel = 0; channel < channelCount; channel++)
+                {
+                    const bool linearChannel = !srgb || channel == 3; // Alpha is always stored linearly
+                    float total = 0.0f;
+
+                    for (int sourceRow : sourceRows)
+                    {
+                        for (int sourceColumn : sourceColumns)
+                        {
+                            const uint8_t value = pixels[((size_t)sourceRow * size.x + sourceColumn) * channelCount + channel];
+                            total += linearChannel ? (float)value : srgbToLinear[value];
+                        }
+                    }
+
+                    uint8_t& nextValue = nextPixels[((size_t)y * nextSize.x + x) * channelCount + channel];
+                    nextValue = linearChannel ? (uint8_t)(total * 0.25f + 0.5f) : LinearToSRGB(total * 0.25f);
+                }
+            }
+        }
+
+        return nextPixels;
+    }
+
+    // Returns the 5:6:5 bit packing of an 8-bit per channel color.
+    static uint16_t PackColor565(const int* color)
+    {
+        return (uint16_t)((((color[0] * 31 + 127) / 255) << 11) | (((color[1] * 63 + 127) / 255) << 5) | ((color[2] * 31 + 127) / 255));
+    }
+
+    // Expands a 5:6:5 bit packed color back to 8 bits per channel.
+    static void UnpackColor565(uint16_t packedColor, int* color)
+    {
+        const int red = (packedColor >> 11) & 0x1F, green = (packedColor >> 5) & 0x3F, blue = packedColor & 0x1F;
+        color[0] = (red << 3) | (red >> 2);
+        color[1] = (green << 2) | (green >> 4);
+        color[2] = (blue << 3) | (blue >> 2);
+    }
+
+    // Writes the value to the output in little-endian byte order.
+    template<typename T>
+    static void WriteLittleEndian(T value, uint8_t* output)
+    {
+        for (size_t byteIndex = 0; byteIndex < sizeof(T); byteIndex++)
+            output[byteIndex] = (uint8_t)((uint64_t)value >> (byteIndex * 8));
+    }
+
+    // Compresses the colors of a 4x4 block of RGBA pixels into a BC1 block, using the corners of the colors' bounding box as
+    // the endpoints. The block always uses the four color mode, so any alpha is ignored.
+    static void CompressColorBlock(const uint8_t (&block)[16][4], uint8_t* output)
+    {
+        int minColor[3] = { 255, 255, 255 }, maxColor[3] = { 0, 0, 0 };
+        for (const uint8_t* pixel : block)
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                minColor[channel] = std::min(minColor[channel], (int)pixel[channel]);
+                maxColor[channel] = std::max(maxColor[channel], (int)pixel[channel]);
+            }
+        }
+
+        // Move the endpoints inwards slightly, which reduces the error of the colors in between
+        for (int channel = 0; channel < 3; channel++)
+        {
+            const int inset = (maxColor[channel] - minColor[channel]) / 16;
+            minColor[channel] += inset;
+            maxColor[channel] -= inset;
+        }
+
+        uint16_t endpoints[2] = { PackColor565(maxColor), PackColor565(minColor) };
+        if (endpoints[0] < endpoints[1]) // The first endpoint must be greater to select the four color mode
+            std::swap(endpoints[0], endpoints[1]);
+
+        uint32_t indices = 0;
+        if (endpoints[0] != endpoints[1])
+        {
+            int palette[4][3];
+            UnpackColor565(endpoints[0], palette[0]);
+            UnpackColor565(endpoints[1], palette[1]);
+
+            for (int channel = 0; channel < 3; channel++)
+            {
+                palette[2][channel] = (palette[0][channel] * 2 + palette[1][channel]) / 3;
+                palette[3][channel] = (palette[0][channel] + palette[1][channel] * 2) / 3;
+            }
+
+            for (uint32_t pixelIndex = 0; pixelIndex < 16; pixelIndex++)
+            {
+                uint32_t closestIndex = 0;
+                int closestDistance = INT32_MAX;
+
+                for (uint32_t paletteIndex = 0; paletteIndex < 4; paletteIndex++)
+                {
+                    int distance = 0;
+                    for (int channel = 0; channel < 3; channel++)
+                    {
+                        const int difference = (int)block[pixelIndex][channel] - palette[paletteIndex][channel];
+                        distance += difference * difference;
+                    }
+
+                    if (distance < closestDistance)
+                    {
+                        closestDistance = distance;
+                        closestIndex = paletteIndex;
+                    }
+                }
+
+                indices |= closestIndex << (pixelIndex * 2);
+            }
+        }
+
+        WriteLittleEndian(endpoints[0], output);
+        WriteLittleEndian(endpoints[1], output + 2);
+        WriteLittleEndian(indices, output + 4);
+    }
+
+    // Compresses the alpha of a 4x4 block of RGBA pixels into the alpha half of a BC3 block, using the eight value mode.
+    static void CompressAlphaBlock(const uint8_t (&block)[16][4], uint8_t* output)
+    {
+        int minAlpha = 255, maxAlpha = 0;
+        for (const uint8_t* pixel : block)
+        {
+            minAlpha = std::min(minAlpha, (int)pixel[3]);
+            maxAlpha = std::max(maxAlpha, (int)pixel[3]);
+        }
+
+        uint64_t indices = 0;
+        if (maxAlpha != minAlpha)
+        {
+            // The first two palette entries are the endpoints, followed by six values evenly spaced between them
+            int palette[8] = { maxAlpha, minAlpha };
+            for (int paletteIndex = 1; paletteIndex < 7; paletteIndex++)
+                palette[paletteIndex + 1] = ((7 - paletteIndex) * maxAlpha + paletteIndex * minAlpha) / 7;
+
+            for (uint32_t pixelIndex = 0; pixelIndex < 16; pixelIndex++)
+            {
+                uint64_t closestIndex = 0;
+                int closestDistance = INT32_MAX;
+
+                for (uint32_t paletteIndex = 0; paletteIndex < 8; paletteIndex++)
+                {
+                    const int distance = std::abs((int)block[pixelIndex][3] - palette[paletteIndex]);
+                    if (distance < closestDistance)
+                    {
+                        closestDistance = distance;
+                        closestIndex = paletteIndex;
+                    }
+                }
+
+                indices |= closestIndex << (pixelIndex * 3);
+            }
+        }
+
+        output[0] = (uint8_t)maxAlpha;
+        output[1] = (uint8_t)minAlpha;
+        for (size_t byteIndex = 0; byteIndex < 6; byteIndex++)
+            output[byteIndex + 2] = (uint8_t)(indices >> (byteIndex * 8));
+    }
+
+    // Returns the level compressed into BC1 blocks (3 channels) or BC3 blocks (4 channels), in rows of blocks.
+    // Blocks which overhang the edges of the level repeat the last column or row of pixels.
+    static std::vector<uint8_t> CompressLevel(const std::vector<uint8_t>& pixels, const glm::ivec2& size, uint32_t channelCount)
+    {
+        const uint32_t blockColumnCount = (size.x + blockDimension - 1) / blockDimension;
+        const uint32_t blockRowCount = (size.y + blockDimension - 1) / blockDimension;
+        const size_t blockSize = channelCount == 4 ? halfBlockSize * 2 : halfBlockSize;
+
+        std::vector<uint8_t> blocks(blockColumnCount * blockRowCount * blockSize);
+        uint8_t* output = blocks.data();
+
+        for (uint32_t blockRow = 0; blockRow < blockRowCount; blockRow++)
+        {
+            for (uint32_t blockColumn = 0; blockColumn < blockColumnCount; blockColumn++)
+            {
+                uint8_t block[16][4];
+                for (uint32_t pixelIndex = 0; pixelIndex < 16; pixelIndex++)
+                {
+                    const int x = std::min((int)(blockColumn * blockDimension + pixelIndex % blockDimension), size.x - 1);
+                    const int y = std::min((int)(blockRow * blockDimension + pixelIndex / blockDimension), size.y - 1);
+                    const uint8_t* pixel = &pixels[((size_t)y * size.x + x) * channelCount];
+
+                    block[pixelIndex][0] = pixel[0];
+                    block[pixelIndex][1] = pixel[1];
+                    block[pixelIndex][2] = pixel[2];
+                    block[pixelIndex][3] = channelCount == 4 ? pixel[3] : 255;
+                }
+
+                if (channelCount == 4)
+                {
+                    CompressAlphaBlock(block, output);
+                    output += halfBlockSize;
+                }
+
+                CompressColorBlock(block, output);
+                output += halfBlockSize;
+            }
+        }
+
+        return blocks;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CookedTexture::CookedTexture() :
+    m_header()
+{}
+
+CookedTexture CookedTexture::Cook(const uint8_t* pixels, const glm::ivec2& size, uint32_t channelCount, bool srgb, bool flipped,
+    bool compress)
+{
+    if (channelCount != 3 && channelCount != 4)
+        throw FormattedException("Only textures with 3 or 4 channels can be cooked, the texture given has %u.", channelCount);
+
+    if (size.x <= 0 || size.y <= 0)
+        throw FormattedException("The texture given to be cooked has no pixels.");
+
+    CookedTexture texture;
+    Header& header = texture.m_header;
+    std::memcpy(header.m_magic, CookedTextureParams::fileMagic, sizeof(header.m_magic));
+    header.m_version = CookedTextureParams::fileVersion;
+    header.m_width = size.x;
+    header.m_height = size.y;
+    header.m_levelCount = (uint32_t)std::floor(std::log2((double)std::max(size.x, size.y))) + 1;
+    header.m_channelCount = channelCount;
+    header.m_flags = (srgb ? CookedTexture::flagSRGB : 0) | (flipped ? CookedTexture::flagFlipped : 0) |
+        (compress ? CookedTexture::flagCompressed : 0);
+
+    if (compress)
+    {
+        if (channelCount == 4)
+            header.m_internalFormat = srgb ? CookedTextureParams::compressedSRGBAlphaFormat : CookedTextureParams::compressedRGBAFormat;
+        else
+            header.m_internalFormat = srgb ? CookedTextureParams::compressedSRGBFormat : CookedTextureParams::compressedRGBFormat;
+
+        header.m_format = 0;
+    }
+    else
+    {
+        if (channelCount == 4)
+            header.m_internalFormat = srgb ? GL_SRGB_ALPHA : GL_RGBA;
+        else
+            header.m_internalFormat = srgb ? GL_SRGB : GL_RGB;
+
+        header.m_format = channelCount == 4 ? GL_RGBA : GL_RGB;
+    }
+
+    // Lay out the file, with the level data starting after the header and level table
+    texture.m_fileData.resize(sizeof(Header) + header.m_levelCount * sizeof(Level));
+    texture.m_levels.resize(header.m_levelCount);
+
+    std::vector<uint8_t> levelPixels(pixels, pixels + (size_t)size.x * size.y * channelCount);
+    glm::ivec2 levelSize = size;
+
+    for (uint32_t levelIndex = 0; levelIndex < header.m_levelCount; levelIndex++)
+    {
+        if (levelIndex > 0)
+        {
+            levelPixels = CookedTextureParams::DownsampleLevel(levelPixels, levelSize, channelCount, srgb);
+            levelSize = glm::max(levelSize / 2, glm::ivec2(1));
+        }
+
+        const std::vector<uint8_t> levelData = compress ?
+            CookedTextureParams::CompressLevel(levelPixels, levelSize, channelCount) : levelPixels;
+
+        Level& level = texture.m_levels[levelIndex];
+        level.m_width = levelSize.x;
+        level.m_height = levelSize.y;
+        level.m_dataOffset = texture.m_fileData.size();
+        level.m_dataSize = levelData.size();
+
+        texture.m_fileData.insert(texture.m_fileData.end(), levelData.begin(), levelData.end());
+    }
+
+    std::memcpy(texture.m_fileData.data(), &header, sizeof(Header));
+    std::memcpy(texture.m_fileData.data() + sizeof(Header), texture.m_levels.data(), header.m_levelCount * sizeof(Level));
+    texture.m_file = { texture.m_fileData.data(), texture.m_fileData.size() };
+    return texture;
+}
+
+CookedTexture CookedTexture::Load(const std::string& filePath)
+{
+    FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file)
+        throw FormattedException("Failed to open the cooked texture file at path: %s.", filePath.c_str());
+
+    std::vector<uint8_t> fileData;
+    std::fseek(file, 0, SEEK_END);
+    const long fileSize = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+
+    if (fileSize > 0)
+    {
+        fileData.resize((size_t)fileSize);
+        fileData.resize(std::fread(fileData.data(), 1, fileData.size(), file));
+    }
+
+    std::fclose(file);
+    return CookedTexture::FromData(std::move(fileData), filePath);
+}
+
+CookedTexture CookedTexture::FromData(std::vector<uint8_t> fileData, const std::string& filePath)
+{
+    CookedTexture texture;
+    texture.m_fileData = std::move(fileData);
+    texture.m_file = { texture.m_fileData.data(), texture.m_fileData.size() };
+    texture.ParseFileData(filePath);
+    return texture;
+}
+
+CookedTexture CookedTexture::FromView(ByteView fileData, const std::string& filePath)
+{
+    CookedTexture texture;
+    texture.m_file = fileData;
+    texture.ParseFileData(filePath);
+    return texture;
+}
+
+void CookedTexture::ParseFileData(const std::string& filePath)
+{
+    if (m_file.m_size < sizeof(Header))
+        throw FormattedException("The cooked texture file at path: %s, is too small to hold a header.", filePath.c_str());
+
+    std::memcpy(&m_header, m_file.m_data, sizeof(Header));
+    if (std::memcmp(m_header.m_magic, CookedTextureParams::fileMagic, sizeof(m_header.m_magic)) != 0 ||
+        m_header.m_version != CookedTextureParams::fileVersion)
+    {
+        throw FormattedException("The file at path: %s, isn't a cooked texture of a supported version.", filePath.c_str());
+    }
+
+    if (m_header.m_width == 0 || m_header.m_height == 0 || m_header.m_levelCount == 0 || m_header.m_levelCount > 32 ||
+        (m_header.m_channelCount != 3 && m_header.m_channelCount != 4) ||
+        m_file.m_size < sizeof(Header) + m_header.m_levelCount * sizeof(Level))
+    {
+        throw FormattedException("The header of the cooked texture file at path: %s, is invalid.", filePath.c_str());
+    }
+
+    m_levels.resize(m_header.m_levelCount);
+    std::memcpy(m_levels.data(), m_file.m_data + sizeof(Header), m_header.m_levelCount * sizeof(Level));
+
+    // Check that every level is the size expected and lies within the file
+    for (uint32_t levelIndex = 0; levelIndex < m_header.m_levelCount; levelIndex++)
+    {
+        const Level& level = m_levels[levelIndex];
+        const size_t expectedSize = this->GetLevelRowSize(levelIndex) *
+            ((level.m_height + this->GetRowBlockHeight() - 1) / this->GetRowBlockHeight());
+
+        const bool validSize = level.m_width == std::max(m_header.m_width >> levelIndex, 1u) &&
+            level.m_height == std::max(m_header.m_height >> levelIndex, 1u) && level.m_dataSize == expectedSize;
+        const bool inBounds = level.m_dataOffset <= m_file.m_size && level.m_dataSize <= m_file.m_size - level.m_dataOffset;
+
+        if (!validSize || !inBounds)
+        {
+            throw FormattedException("Mip level %u of the cooked texture file at path: %s, is invalid.", levelIndex, filePath.c_str());
+        }
+    }
+}
+
+void CookedTexture::Save(const std::string& filePath) const
+{
+    // Write under a name unique to the thread, in case another thread is cooking the same texture
+    const std::string temporaryFilePath = filePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+        ".tmp";
+
+    FILE* file = std::fopen(temporaryFilePath.c_str(), "wb");
+    if (!file)
+        throw FormattedException("Failed to create the cooked texture file at path: %s.", temporaryFilePath.c_str());
+
+    const bool written = std::fwrite(m_file.m_data, 1, m_file.m_size, file) == m_file.m_size;
+    const bool closed = std::fclose(file) == 0;
+
+    std::error_code error;
+    if (written && closed)
+        std::filesystem::rename(temporaryFilePath, filePath, error);
+
+    if (!written || !closed || error)
+    {
+        std::filesystem::remove(temporaryFilePath, error);
+        throw FormattedException("Failed to write the cooked texture file at path: %s.", filePath.c_str());
+    }
+}
+
+Texture2D CookedTexture::CreateTexture() const
+{
+    Texture2D texture(this->GetSize(), m_header.m_levelCount);
+
+    // The rows of uncompressed levels are tightly packed, rather than aligned to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (uint32_t levelIndex = 0; levelIndex < m_header.m_levelCount; levelIndex++)
+    {
+        if (this->IsCompressed())
+        {
+            texture.SetCompressedLevelData(levelIndex, this->GetLevelData(levelIndex), (size_t)m_levels[levelIndex].m_dataSize,
+                m_header.m_internalFormat);
+        }
+        else
+        {
+            texture.SetLevelData(levelIndex, this->GetLevelData(levelIndex), GL_UNSIGNED_BYTE, m_header.m_internalFormat,
+                m_header.m_format);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return texture;
+}
+
+glm::ivec2 CookedTexture::GetSize() const
+{
+    return { (int)m_header.m_width, (int)m_header.m_height };
+}
+
+uint32_t CookedTexture::GetLevelCount() const
+{
+    return m_header.m_levelCount;
+}
+
+const CookedTexture::Level& CookedTexture::GetLevel(uint32_t level) const
+{
+    return m_levels[level];
+}
+
+const uint8_t* CookedTexture::GetLevelData(uint32_t level) const
+{
+    return m_file.m_data + m_levels[level].m_dataOffset;
+}
+
+uint32_t CookedTexture::GetRowBlockHeight() const
+{
+    return this->IsCompressed() ? CookedTextureParams::blockDimension : 1;
+}
+
+size_t CookedTexture::GetLevelRowSize(uint32_t level) const
+{
+    if (this->IsCompressed())
+    {
+        const size_t blockSize = m_header.m_channelCount == 4 ? CookedTextureParams::halfBlockSize * 2 :
+            CookedTextureParams::halfBlockSize;
+
+        return ((m_levels[level].m_width + CookedTextureParams::blockDimension - 1) / CookedTextureParams::blockDimension) *
+            blockSize;
+    }
+
+    return (size_t)m_levels[level].m_width * m_header.m_channelCount;
+}
+
+uint32_t CookedTexture::GetInternalFormat() const
+{
+    return m_header.m_internalFormat;
+}
+
+uint32_t CookedTexture::GetFormat() const
+{
+    return m_header.m_format;
+}
+
+bool CookedTexture::IsSRGB() const
+{
+    return m_header.m_flags & CookedTexture::flagSRGB;
+}
+
+bool CookedTexture::IsFlipped() const
+{
+    return m_header.m_flags & CookedTexture::flagFlipped;
+}
+
+bool CookedTexture::IsCompressed() const
+{
+    return m_header.m_flags & CookedTexture::flagCompressed;
+}
+
+std::string CookedTexture::GetCookedFilePath(const std::string& imageFilePath)
+{
+    return std::filesystem::path(imageFilePath).replace_extension(".mtex").string();
+}
+
+void CookedTexture::QueryCompressionSupport()
+{
+    bool s3tcSupported = false, srgbSupported = false;
+
+    int extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+    for (int extensionIndex = 0; extensionIndex < extensionCount; extensionIndex++)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, extensionIndex);
+        if (!extension)
+            continue;
+
+        if (std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0)
+            s3tcSupported = true;
+        else if (std::strcmp(extension, "GL_EXT_texture_sRGB") == 0)
+            srgbSupported = true;
+    }
+
+    CookedTextureParams::compressionSupported.store(s3tcSupported && srgbSupported);
+}
+
+bool CookedTexture::IsCompressionSupported()
+{
+    return CookedTextureParams::compressionSupported.load();
+}
@@ -0,0 +1,128 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <graphics/texture_2d.h>
+#include <util/asset_pack.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// A texture's pixels along with its precomputed mip chain, in the layout of a cooked texture (.mtex) file.
+// The file is made up of a header and a table of the mip levels, followed by the data of each level from the largest to the
+// smallest, which is ready to be uploaded straight into a texture. The levels can optionally be S3TC compressed, using BC1 for
+// RGB textures and BC3 for RGBA textures.
+class CookedTexture
+{
+public:
+	// A mip level of the texture, whose data is stored in the texture's file data.
+	struct Level
+	{
+		uint32_t m_width, m_height;
+		uint64_t m_dataOffset, m_dataSize; // The location of the level's data from the start of the file
+	};
+private:
+	// The header at the start of a cooked texture file, which is followed by the table of its levels.
+	struct Header
+	{
+		char m_magic[4];
+		uint32_t m_version;
+		uint32_t m_width, m_height;
+		uint32_t m_levelCount;
+		uint32_t m_channelCount;
+		uint32_t m_flags;
+		uint32_t m_internalFormat, m_format; // The OpenGL formats of the levels, the format is 0 if they're compressed
+		uint32_t m_reserved;
+	};
+
+	static constexpr uint32_t flagSRGB = 0x1, flagFlipped = 0x2, flagCompressed = 0x4;
+
+	std::vector<uint8_t> m_fileData; // Empty if the file data is owned by something else, such as a mapped asset pack
+	ByteView m_file;
+	Header m_header;
+	std::vector<Level> m_levels;
+
+	// Checks that the header and level table at the start of the file data are valid, then reads them.
+	void ParseFileData(const std::string& filePath);
+public:
+	CookedTexture();
+	CookedTexture(const CookedTexture& other) = delete;
+	CookedTexture(CookedTexture&& temp) noexcept = default;
+
+	~CookedTexture() = default;
+
+	CookedTexture& operator=(const CookedTexture& other) = delete;
+	CookedTexture& operator=(CookedTexture&& temp) noexcept = default;
+
+	// Creates a cooked texture from the pixels of an image, generating its mip chain and compressing it if requested.
+	// The rows of pixels must be tightly packed with 3 or 4 channels of 8 bits each. The flipped flag is only recorded, so that
+	// loaders can tell whether the texture was cooked the way they need.
+	// For sRGB textures, the mip levels are filtered in linear space.
+	static CookedTexture Cook(const uint8_t* pixels, const glm::ivec2& size, uint32_t channelCount, bool srgb, bool flipped,
+		bool compress);
+
+	// Loads the cooked texture file at the given path with a single read.
+	static CookedTexture Load(const std::string& filePath);
+
+	// Returns the cooked texture in the file data given, taking ownership of the data.
+	// The file path is only used in error messages.
+	static CookedTexture FromData(std::vector<uint8_t> fileData, const std::string& filePath);
+
+	// Returns the cooked texture in the file data given without copying it, so the data must outlive the cooked texture.
+	// The file path is only used in error messages.
+	static CookedTexture FromView(ByteView fileData, const std::string& filePath);
+
+	// Writes the cooked texture to a file at the given path.
+	// The file is written under a temporary name and then renamed, so that it's never read while partially written.
+	void Save(const std::string& filePath) const;
+
+	// Creates a texture buffer and uploads every mip level into it. This must be called on the thread with the OpenGL context.
+	Texture2D CreateTexture() const;
+
+	// Returns the size of the largest mip level.
+	glm::ivec2 GetSize() const;
+
+	// Returns the number of mip levels.
+	uint32_t GetLevelCount() const;
+
+	// Returns the size and location of the given mip level.
+	const Level& GetLevel(uint32_t level) const;
+
+	// Returns the data of the given mip level.
+	const uint8_t* GetLevelData(uint32_t level) const;
+
+	// Returns the number of rows of pixels in each row of the level data, which is 4 for compressed textures (a row of blocks).
+	uint32_t GetRowBlockHeight() const;
+
+	// Returns the size of each row of the given mip level's data in bytes, a row of blocks for compressed textures.
+	size_t GetLevelRowSize(uint32_t level) const;
+
+	// Returns the OpenGL internal format of the levels.
+	uint32_t GetInternalFormat() const;
+
+	// Returns the OpenGL format of the levels' pixels, or 0 if they're compressed.
+	uint32_t GetFormat() const;
+
+	// Returns TRUE if the texture stores sRGB colors.
+	bool IsSRGB() const;
+
+	// Returns TRUE if the image was flipped vertically before being cooked.
+	bool IsFlipped() const;
+
+	// Returns TRUE if the levels are S3TC compressed.
+	bool IsCompressed() const;
+
+	// Returns the path of the cooked texture file for the image file at the given path, which has the .mtex extension.
+	static std::string GetCookedFilePath(const std::string& imageFilePath);
+
+	// Checks whether the OpenGL implementation supports S3TC compressed textures, including sRGB ones.
+	// This must be called on the thread with the OpenGL context, Renderer::Init() does this.
+	static void QueryCompressionSupport();
+
+	// Returns the result of the last call to QueryCompressionSupport(), or FALSE if it hasn't been called. 
+	// This can be called from any thread.
+	static bool IsCompressionSupported();
+};
+
+#endif
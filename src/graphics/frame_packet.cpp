@@ -0,0 +1,30 @@
+#include <graphics/frame_packet.h>
+
+DrawCommand DrawCommand::FromGeometry(const Geometry& geometry, const glm::mat4& modelMatrix)
+{
+    const Geometry::Material& material = geometry.GetMaterialData();
+
+    DrawCommand command;
+    command.m_modelMatrix = modelMatrix;
+    command.m_diffuseColor = material.m_diffuseColor;
+    command.m_geometryData = geometry.GetGeometryData();
+    command.m_localBounds = geometry.GetLocalBounds();
+    command.m_diffuseTexture = material.GetDiffuseTexture();
+    command.m_diffuseLayer = material.m_diffuseLayer;
+    command.m_count = geometry.GetCount();
+    command.m_primitiveType = geometry.GetPrimitiveType();
+    command.m_renderFunc = geometry.GetRenderFunction();
+    command.m_shaderFeatures = geometry.GetShaderFeatures();
+
+    return command;
+}
+
+void FramePacket::AddDraw(const Geometry& geometry)
+{
+    m_drawCommands.push_back(DrawCommand::FromGeometry(geometry, geometry.ComputeModelMatrix()));
+}
+
+void FramePacket::AddDraw(const Geometry& geometry, const glm::mat4& modelMatrix)
+{
+    m_drawCommands.push_back(DrawCommand::FromGeometry(geometry, modelMatrix));
+}
@@ -0,0 +1,47 @@
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include <graphics/geometry.h>
+#include <graphics/camera_3d.h>
+
+#include <vector>
+#include <cstdint>
+
+// A draw of a piece of geometry, holding copies of everything the renderer needs so that it can be recorded on one thread 
+// and drawn on another.
+// Note that the mesh and diffuse texture are referenced rather than copied, so they must remain alive until the draw has been
+// rendered.
+struct DrawCommand
+{
+	glm::mat4 m_modelMatrix;
+	glm::vec4 m_diffuseColor;
+	AssetSystem::GeometryData m_geometryData; // The range of the geometry pool holding the mesh
+	BoundingBox m_localBounds;
+	const TextureBuffer* m_diffuseTexture; // A 2D texture or texture array depending on the shader features, or nullptr
+	uint32_t m_diffuseLayer; // The layer of the diffuse texture array, if the diffuse texture is one
+	uint32_t m_count;
+	Geometry::PrimitiveType m_primitiveType;
+	Geometry::RenderFunction m_renderFunc;
+	uint32_t m_shaderFeatures; // The feature mask of the geometry shader permutation to draw with, see Geometry::ShaderFeature
+
+	// Returns a draw of the given geometry using its current material and the model matrix given.
+	static DrawCommand FromGeometry(const Geometry& geometry, const glm::mat4& modelMatrix);
+};
+
+// Everything the render thread needs to render a frame, produced by the simulation thread.
+// The packets are reused from frame to frame, so their draw commands keep their capacity.
+struct FramePacket
+{
+	uint64_t m_frameIndex = 0;
+	Camera3D m_camera;
+	glm::vec4 m_clearColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	std::vector<DrawCommand> m_drawCommands;
+
+	// Records a draw of the geometry using its current transform and material.
+	void AddDraw(const Geometry& geometry);
+
+	// Records a draw of the geometry using its current material and the model matrix given.
+	void AddDraw(const Geometry& geometry, const glm::mat4& modelMatrix);
+};
+
+#endif
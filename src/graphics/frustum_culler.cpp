@@ -0,0 +1,192 @@
+#include <graphics/frustum_culler.h>
+#include <core/job_system.h>
+#include <util/profiler.h>
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Culling
+{
+#if defined(__AVX__)
+    constexpr size_t simdWidth = 8;
+#elif defined(__SSE2__) || defined(_M_X64)
+    constexpr size_t simdWidth = 4;
+#else
+    constexpr size_t simdWidth = 1;
+#endif
+
+    // The number of boxes in a batch before it is split across multiple threads.
+    constexpr size_t parallelThreshold = 32768;
+
+    // The number of boxes culled by each job when a batch is split across the job system, a multiple of the SIMD width.
+    constexpr size_t jobBatchSize = 4096;
+    static_assert(jobBatchSize % simdWidth == 0, "The job batch size must be a multiple of the SIMD width.");
+}
+
+FrustumCuller::FrustumCuller() :
+    m_count(0)
+{}
+
+void FrustumCuller::Clear()
+{
+    m_centresX.clear();
+    m_centresY.clear();
+    m_centresZ.clear();
+    m_extentsX.clear();
+    m_extentsY.clear();
+    m_extentsZ.clear();
+    m_count = 0;
+}
+
+size_t FrustumCuller::AddBoundingBox(const BoundingBox& box)
+{
+    const glm::vec3 centre = (box.m_min + box.m_max) * 0.5f;
+    const glm::vec3 extents = (box.m_max - box.m_min) * 0.5f;
+
+    m_centresX.push_back(centre.x);
+    m_centresY.push_back(centre.y);
+    m_centresZ.push_back(centre.z);
+    m_extentsX.push_back(extents.x);
+    m_extentsY.push_back(extents.y);
+    m_extentsZ.push_back(extents.z);
+
+    return m_count++;
+}
+
+void FrustumCuller::Cull(const std::array<glm::vec4, 6>& planes)
+{
+    PROFILE_SCOPE("FrustumCuller::Cull");
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // Pad the arrays up to a multiple of the SIMD width so that the last group of boxes can be loaded as a whole
+    const size_t paddedCount = ((m_count + Culling::simdWidth - 1) / Culling::simdWidth) * Culling::simdWidth;
+    for (std::vector<float>* component : { &m_centresX, &m_centresY, &m_centresZ, &m_extentsX, &m_extentsY, &m_extentsZ })
+        component->resize(paddedCount, 0.0f);
+
+    m_visibility.resize(paddedCount);
+
+    if (m_count >= Culling::parallelThreshold)
+    {
+        // Split the boxes into SIMD aligned ranges which are culled in parallel by the job system
+        JobSystem::GetInstance().ParallelFor(paddedCount, Culling::jobBatchSize, [this, &planes](size_t begin, size_t end)
+        {
+            this->CullRange(planes, begin, end);
+        });
+    }
+    else
+        this->CullRange(planes, 0, paddedCount);
+
+    // Remove the padding again so that more boxes can be added to the batch
+    for (std::vector<float>* component : { &m_centresX, &m_centresY, &m_centresZ, &m_extentsX, &m_extentsY, &m_extentsZ })
+        component->resize(m_count);
+
+    m_lastStatistics.m_testedCount = (uint32_t)m_count;
+    m_lastStatistics.m_culledCount = (uint32_t)std::count(m_visibility.begin(), m_visibility.begin() + m_count, (uint8_t)0);
+    m_lastStatistics.m_elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - 
+        startTime).count();
+}
+
+void FrustumCuller::CullRange(const std::array<glm::vec4, 6>& planes, size_t begin, size_t end)
+{
+    // A box is outside a plane if its centre is further behind the plane than the box's extent along the plane normal
+    // i.e. dot(normal, centre) + distance < -dot(abs(normal), extents)
+#if defined(__AVX__)
+    for (size_t index = begin; index < end; index += 8)
+    {
+        const __m256 centresX = _mm256_loadu_ps(&m_centresX[index]), centresY = _mm256_loadu_ps(&m_centresY[index]),
+            centresZ = _mm256_loadu_ps(&m_centresZ[index]);
+        const __m256 extentsX = _mm256_loadu_ps(&m_extentsX[index]), extentsY = _mm256_loadu_ps(&m_extentsY[index]),
+            extentsZ = _mm256_loadu_ps(&m_extentsZ[index]);
+
+        __m256 outsideMask = _mm256_setzero_ps();
+        for (const glm::vec4& plane : planes)
+        {
+            const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(centresX, _mm256_set1_ps(plane.x)),
+                _mm256_mul_ps(centresY, _mm256_set1_ps(plane.y))), _mm256_add_ps(_mm256_mul_ps(centresZ, _mm256_set1_ps(plane.z)),
+                _mm256_set1_ps(plane.w)));
+
+            const __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extentsX, _mm256_set1_ps(std::abs(plane.x))),
+                _mm256_mul_ps(extentsY, _mm256_set1_ps(std::abs(plane.y)))), _mm256_mul_ps(extentsZ, _mm256_set1_ps(std::abs(plane.z))));
+
+            outsideMask = _mm256_or_ps(outsideMask, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        const int outsideBits = _mm256_movemask_ps(outsideMask);
+        for (size_t lane = 0; lane < 8; lane++)
+            m_visibility[index + lane] = !((outsideBits >> lane) & 1);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    for (size_t index = begin; index < end; index += 4)
+    {
+        const __m128 centresX = _mm_loadu_ps(&m_centresX[index]), centresY = _mm_loadu_ps(&m_centresY[index]),
+            centresZ = _mm_loadu_ps(&m_centresZ[index]);
+        const __m128 extentsX = _mm_loadu_ps(&m_extentsX[index]), extentsY = _mm_loadu_ps(&m_extentsY[index]),
+            extentsZ = _mm_loadu_ps(&m_extentsZ[index]);
+
+        __m128 outsideMask = _mm_setzero_ps();
+        for (const glm::vec4& plane : planes)
+        {
+            const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centresX, _mm_set1_ps(plane.x)),
+                _mm_mul_ps(centresY, _mm_set1_ps(plane.y))), _mm_add_ps(_mm_mul_ps(centresZ, _mm_set1_ps(plane.z)),
+                _mm_set1_ps(plane.w)));
+
+            const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentsX, _mm_set1_ps(std::abs(plane.x))),
+                _mm_mul_ps(extentsY, _mm_set1_ps(std::abs(plane.y)))), _mm_mul_ps(extentsZ, _mm_set1_ps(std::abs(plane.z))));
+
+            outsideMask = _mm_or_ps(outsideMask, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        const int outsideBits = _mm_movemask_ps(outsideMask);
+        for (size_t lane = 0; lane < 4; lane++)
+            m_visibility[index + lane] = !((outsideBits >> lane) & 1);
+    }
+#else
+    for (size_t index = begin; index < end; index++)
+    {
+        const BoundingBox box = 
+        {
+            { m_centresX[index] - m_extentsX[index], m_centresY[index] - m_extentsY[index], m_centresZ[index] - m_extentsZ[index] },
+            { m_centresX[index] + m_extentsX[index], m_centresY[index] + m_extentsY[index], m_centresZ[index] + m_extentsZ[index] }
+        };
+
+        m_visibility[index] = FrustumCuller::IsVisible(planes, box);
+    }
+#endif
+}
+
+bool FrustumCuller::IsVisible(size_t index) const
+{
+    return m_visibility[index] != 0;
+}
+
+size_t FrustumCuller::GetCount() const
+{
+    return m_count;
+}
+
+const FrustumCuller::Statistics& FrustumCuller::GetLastStatistics() const
+{
+    return m_lastStatistics;
+}
+
+bool FrustumCuller::IsVisible(const std::array<glm::vec4, 6>& planes, const BoundingBox& box)
+{
+    const glm::vec3 centre = (box.m_min + box.m_max) * 0.5f;
+    const glm::vec3 extents = (box.m_max - box.m_min) * 0.5f;
+
+    for (const glm::vec4& plane : planes)
+    {
+        const glm::vec3 normal = glm::vec3(plane);
+        if (glm::dot(normal, centre) + plane.w < -glm::dot(glm::abs(normal), extents))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+#include <graphics/bounding_box.h>
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Tests batches of bounding boxes against the planes of a view frustum.
+// The boxes are stored as separate arrays of centres and extents (structure of arrays), so that several boxes can be tested
+// against a plane at once using SIMD instructions. Large batches are also split across the job system's workers.
+class FrustumCuller
+{
+public:
+	struct Statistics
+	{
+		uint32_t m_testedCount = 0, m_culledCount = 0;
+		double m_elapsedMilliseconds = 0.0;
+	};
+private:
+	std::vector<float> m_centresX, m_centresY, m_centresZ, m_extentsX, m_extentsY, m_extentsZ;
+	std::vector<uint8_t> m_visibility;
+	size_t m_count;
+
+	Statistics m_lastStatistics;
+
+	// Tests the boxes within the given index range, which must start on a multiple of the SIMD width.
+	void CullRange(const std::array<glm::vec4, 6>& planes, size_t begin, size_t end);
+public:
+	FrustumCuller();
+	~FrustumCuller() = default;
+
+	// Removes all the bounding boxes from the batch.
+	void Clear();
+
+	// Adds the given bounding box to the batch and returns its index.
+	size_t AddBoundingBox(const BoundingBox& box);
+
+	// Tests every bounding box in the batch against the given frustum planes.
+	// The planes should be in the format returned by CameraBase::ComputeFrustumPlanes().
+	void Cull(const std::array<glm::vec4, 6>& planes);
+
+	// Returns TRUE if the bounding box at the given index was inside or intersecting the frustum in the last call to Cull().
+	bool IsVisible(size_t index) const;
+
+	// Returns the number of bounding boxes in the batch.
+	size_t GetCount() const;
+
+	// Returns the statistics of the last call to Cull().
+	const Statistics& GetLastStatistics() const;
+
+	// Returns TRUE if the given bounding box is inside or intersecting the frustum with the planes given.
+	static bool IsVisible(const std::array<glm::vec4, 6>& planes, const BoundingBox& box);
+};
+
+#endif
@@ -6,6 +6,26 @@
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+uint32_t Geometry::Material::GetShaderFeatures() const
+{
+    // Materials without a texture are rendered untextured even if textures are enabled
+    if (!m_enableTextures)
+        return 0;
+
+    if (m_diffuseTextureArray)
+        return (uint32_t)ShaderFeature::TEXTURED | (uint32_t)ShaderFeature::TEXTURE_ARRAY;
+
+    return m_diffuseTexture ? (uint32_t)ShaderFeature::TEXTURED : 0;
+}
+
+const TextureBuffer* Geometry::Material::GetDiffuseTexture() const
+{
+    if (!m_enableTextures)
+        return nullptr;
+
+    return m_diffuseTextureArray ? (const TextureBuffer*)m_diffuseTextureArray.get() : m_diffuseTexture.get();
+}
+
 Geometry::Geometry() :
     m_count(0), m_renderFunc(RenderFunction::RENDER_ARRAYS), m_primitiveType(PrimitiveType::TRIANGLES)
 {}
@@ -41,24 +61,84 @@ void Geometry::SetDiffuse(Texture2DPtr texture)
     m_materialData.m_diffuseTexture = texture;
 }
 
+void Geometry::SetDiffuse(Texture2DArrayPtr textureArray, uint32_t layer)
+{
+    m_materialData.m_diffuseTextureArray = textureArray;
+    m_materialData.m_diffuseLayer = layer;
+}
+
 void Geometry::SetTexturesUsage(bool enable)
 {
     m_materialData.m_enableTextures = enable;
 }
 
 glm::mat4 Geometry::ComputeModelMatrix() const
+{
+    return Geometry::ComputeModelMatrix(m_transformData);
+}
+
+glm::mat4 Geometry::ComputeModelMatrix(const Transform& transform)
 {
     glm::mat4 modelMatrix = glm::mat4(1.0f);
-    modelMatrix = glm::scale(modelMatrix, m_transformData.m_size);
-    modelMatrix = glm::rotate(modelMatrix, glm::radians(m_transformData.m_rotationAngle), m_transformData.m_rotationAxis);
-    modelMatrix = glm::translate(modelMatrix, m_transformData.m_position);
+    modelMatrix = glm::scale(modelMatrix, transform.m_size);
+    modelMatrix = glm::rotate(modelMatrix, glm::radians(transform.m_rotationAngle), transform.m_rotationAxis);
+    modelMatrix = glm::translate(modelMatrix, transform.m_position);
 
     return modelMatrix;
 }
 
+Geometry::Transform Geometry::InterpolateTransform(const Transform& previous, const Transform& current, float alpha)
+{
+    Transform transform;
+    transform.m_position = glm::mix(previous.m_position, current.m_position, alpha);
+    transform.m_size = glm::mix(previous.m_size, current.m_size, alpha);
+    transform.m_rotationAxis = current.m_rotationAxis;
+    transform.m_rotationAngle = glm::mix(previous.m_rotationAngle, current.m_rotationAngle, alpha);
+
+    return transform;
+}
+
+BoundingBox Geometry::ComputeWorldBounds() const
+{
+    return Geometry::ComputeWorldBounds(m_localBounds, this->ComputeModelMatrix());
+}
+
+BoundingBox Geometry::ComputeWorldBounds(const BoundingBox& localBounds, const glm::mat4& modelMatrix)
+{
+    // Transform the centre of the box, then find the extents of the transformed box by projecting the local extents onto 
+    // each world axis (Arvo's method)
+    const glm::vec3 localCentre = (localBounds.m_min + localBounds.m_max) * 0.5f;
+    const glm::vec3 localExtents = (localBounds.m_max - localBounds.m_min) * 0.5f;
+
+    const glm::vec3 worldCentre = glm::vec3(modelMatrix * glm::vec4(localCentre, 1.0f));
+    glm::vec3 worldExtents = glm::vec3(0.0f);
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        worldExtents[axis] = (glm::abs(modelMatrix[0][axis]) * localExtents.x) + (glm::abs(modelMatrix[1][axis]) * localExtents.y) +
+            (glm::abs(modelMatrix[2][axis]) * localExtents.z);
+    }
+
+    return { worldCentre - worldExtents, worldCentre + worldExtents };
+}
+
 const VertexArray& Geometry::GetVertexArray() const
 {
-    return m_vertexArray;
+    return m_geometryData.m_pool->GetVertexArray();
+}
+
+const AssetSystem::GeometryData& Geometry::GetGeometryData() const
+{
+    return m_geometryData;
+}
+
+uint32_t Geometry::GetShaderFeatures() const
+{
+    uint32_t shaderFeatures = m_materialData.GetShaderFeatures();
+    if (m_geometryData.m_pool->GetVertexFormat() == GeometryPool::VertexFormat::QUANTIZED)
+        shaderFeatures |= (uint32_t)ShaderFeature::QUANTIZED;
+
+    return shaderFeatures;
 }
 
 const Geometry::Transform& Geometry::GetTransformData() const
@@ -71,6 +151,11 @@ const Geometry::Material& Geometry::GetMaterialData() const
     return m_materialData;
 }
 
+const BoundingBox& Geometry::GetLocalBounds() const
+{
+    return m_localBounds;
+}
+
 Geometry::RenderFunction Geometry::GetRenderFunction() const
 {
     return m_renderFunc;
@@ -86,6 +171,16 @@ uint32_t Geometry::GetCount() const
     return m_count;
 }
 
+uint32_t Geometry::GetBaseVertex() const
+{
+    return m_geometryData.m_allocation.m_baseVertex;
+}
+
+uint32_t Geometry::GetFirstIndex() const
+{
+    return m_geometryData.m_allocation.m_firstIndex;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Square::Square()
@@ -101,41 +196,35 @@ Square::Square(const Transform& transform, const Material& material) :
 
 void Square::InitGeometryData()
 {
-    // Attempt to fetch the geometry's buffer objects from the asset system
-    if (AssetSystem::GeometryData* geometryData = AssetSystem::GetInstance().GetGeometryBuffers("Square"))
-    {
-        // It has been found so simply attach them to the VAO
-        m_vertexArray.AttachBuffers(*geometryData->m_vertexBuffer, geometryData->m_indexBuffer.get());
-    }
-    else
+    // Attempt to fetch the geometry's mesh from the asset system
+    const AssetSystem::GeometryData* geometryData = AssetSystem::GetInstance().GetGeometry("Square"_id);
+    if (!geometryData)
     {
         // Define the vertex and index data
-        std::array<float, 20> vertices =
-        {
-            -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
-             0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
-             0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
-            -0.5f,  0.5f, 0.0f, 0.0f, 1.0f
-        };
+        std::array<GeometryPool::Vertex, 4> vertices =
+        { {
+            { { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f } },
+            { {  0.5f, -0.5f, 0.0f }, { 1.0f, 0.0f } },
+            { {  0.5f,  0.5f, 0.0f }, { 1.0f, 1.0f } },
+            { { -0.5f,  0.5f, 0.0f }, { 0.0f, 1.0f } }
+        } };
 
         std::array<uint32_t, 6> indices = { 0, 1, 2, 0, 2, 3 };
 
-        // Setup the vbo, ibo and vao
-        VertexBufferPtr vertexBuffer = AssetSystem::CreateVertexBuffer(vertices.data(), sizeof(vertices), GL_STATIC_DRAW);
-        vertexBuffer->PushLayout(0, GL_FLOAT, 3, 5 * sizeof(float));
-        vertexBuffer->PushLayout(1, GL_FLOAT, 2, 5 * sizeof(float), 3 * sizeof(float));
-
-        IndexBufferPtr indexBuffer = AssetSystem::CreateIndexBuffer(indices.data(), sizeof(indices), GL_STATIC_DRAW);
-        m_vertexArray.AttachBuffers(*vertexBuffer, indexBuffer.get());
-
-        // Store the buffer objects in the asset system
-        AssetSystem::GetInstance().StoreGeometryBuffers("Square", vertexBuffer, indexBuffer);
+        // Store the mesh in the asset system
+        AssetSystem::GetInstance().StoreMesh("Square", CookedMesh::Cook(vertices.data(), nullptr, (uint32_t)vertices.size(), 
+            indices.data(), (uint32_t)indices.size()));
+        
+        geometryData = AssetSystem::GetInstance().GetGeometry("Square"_id);
     }
 
+    m_geometryData = *geometryData;
+
     // Assign the rendering parameters
     m_renderFunc = RenderFunction::RENDER_ELEMENTS;
     m_primitiveType = PrimitiveType::TRIANGLES;
-    m_count = 6;
+    m_count = m_geometryData.m_allocation.m_indexCount;
+    m_localBounds = { { -0.5f, -0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -153,37 +242,34 @@ Triangle::Triangle(const Transform& transform, const Material& material) :
 
 void Triangle::InitGeometryData()
 {
-    // Attempt to fetch the geometry's buffer objects from the asset system
-    if (AssetSystem::GeometryData* geometryData = AssetSystem::GetInstance().GetGeometryBuffers("Triangle"))
+    // Attempt to fetch the geometry's mesh from the asset system
+    const AssetSystem::GeometryData* geometryData = AssetSystem::GetInstance().GetGeometry("Triangle"_id);
+    if (!geometryData)
     {
-        // It has been found so simply attach them to the VAO
-        m_vertexArray.AttachBuffers(*geometryData->m_vertexBuffer, geometryData->m_indexBuffer.get());
+        // Define the vertex and index data
+        std::array<GeometryPool::Vertex, 3> vertices =
+        { {
+            { { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f } },
+            { {  0.5f, -0.5f, 0.0f }, { 1.0f, 0.0f } },
+            { {  0.0f,  0.5f, 0.0f }, { 0.5f, 1.0f } }
+        } };
+
+        std::array<uint32_t, 3> indices = { 0, 1, 2 };
+
+        // Store the mesh in the asset system
+        AssetSystem::GetInstance().StoreMesh("Triangle", CookedMesh::Cook(vertices.data(), nullptr, (uint32_t)vertices.size(), 
+            indices.data(), (uint32_t)indices.size()));
+        
+        geometryData = AssetSystem::GetInstance().GetGeometry("Triangle"_id);
     }
-    else
-    {
-        // Define the vertex data
-        std::array<float, 15> vertices =
-        {
-            -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
-             0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
-             0.0f,  0.5f, 0.0f, 0.5f, 1.0f
-        };
 
-        // Setup the vbo and vao
-        VertexBufferPtr vertexBuffer = AssetSystem::CreateVertexBuffer(vertices.data(), sizeof(vertices), GL_STATIC_DRAW);
-        vertexBuffer->PushLayout(0, GL_FLOAT, 3, 5 * sizeof(float));
-        vertexBuffer->PushLayout(1, GL_FLOAT, 2, 5 * sizeof(float), 3 * sizeof(float));
-
-        m_vertexArray.AttachBuffers(*vertexBuffer);
-
-        // Store the buffer objects in the asset system
-        AssetSystem::GetInstance().StoreGeometryBuffers("Triangle", vertexBuffer);
-    }
+    m_geometryData = *geometryData;
 
     // Assign the rendering parameters
-    m_renderFunc = RenderFunction::RENDER_ARRAYS;
+    m_renderFunc = RenderFunction::RENDER_ELEMENTS;
     m_primitiveType = PrimitiveType::TRIANGLES;
-    m_count = 3;
+    m_count = m_geometryData.m_allocation.m_indexCount;
+    m_localBounds = { { -0.5f, -0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -201,16 +287,12 @@ Circle::Circle(const Transform& transform, const Material& material) :
 
 void Circle::InitGeometryData()
 {
-    // Attempt to fetch the geometry's buffer objects from the asset system
-    if (AssetSystem::GeometryData* geometryData = AssetSystem::GetInstance().GetGeometryBuffers("Circle"))
-    {
-        // It has been found so simply attach them to the VAO
-        m_vertexArray.AttachBuffers(*geometryData->m_vertexBuffer, geometryData->m_indexBuffer.get());
-    }
-    else
+    // Attempt to fetch the geometry's mesh from the asset system
+    const AssetSystem::GeometryData* geometryData = AssetSystem::GetInstance().GetGeometry("Circle"_id);
+    if (!geometryData)
     {
-        // Calculate the vertex and index data
-        std::vector<float> vertices({ 0.0f, 0.0f, 0.0f, 0.5f, 0.5f });
+        // Calculate the vertex data, starting with the centre vertex followed by the vertices around the edge
+        std::vector<GeometryPool::Vertex> vertices({ { { 0.0f, 0.0f, 0.0f }, { 0.5f, 0.5f } } });
         constexpr float angleDecrementStep = 10.0f;
 
         for (float angle = 360; angle >= 0; angle -= angleDecrementStep)
@@ -218,29 +300,31 @@ void Circle::InitGeometryData()
             const glm::vec3 vertexCoord = { glm::sin(glm::radians(angle)) / 2.0f, glm::cos(glm::radians(angle)) / 2.0f, 0.0f };
             const glm::vec2 uvCoord = { vertexCoord.x + 0.5f, vertexCoord.y + 0.5f };
 
-            vertices.emplace_back(vertexCoord.x);
-            vertices.emplace_back(vertexCoord.y);
-            vertices.emplace_back(vertexCoord.z);
-            vertices.emplace_back(uvCoord.x);
-            vertices.emplace_back(uvCoord.y);
+            vertices.push_back({ vertexCoord, uvCoord });
         }
 
-        // Setup the vbo and vao
-        VertexBufferPtr vertexBuffer = AssetSystem::CreateVertexBuffer(vertices.data(), vertices.size() * sizeof(float), GL_STATIC_DRAW);
-        vertexBuffer->PushLayout(0, GL_FLOAT, 3, 5 * sizeof(float));
-        vertexBuffer->PushLayout(1, GL_FLOAT, 2, 5 * sizeof(float), 3 * sizeof(float));
-
-        m_vertexArray.AttachBuffers(*vertexBuffer);
+        // Calculate the index data, the circle is drawn as a triangle list (rather than a fan) so that its draws can be 
+        // merged with draws of other geometry in the pool
+        std::vector<uint32_t> indices;
+        for (uint32_t edgeVertex = 1; edgeVertex + 1 < (uint32_t)vertices.size(); edgeVertex++)
+        {
+            indices.push_back(0);
+            indices.push_back(edgeVertex);
+            indices.push_back(edgeVertex + 1);
+        }
 
-        // Store the buffer objects in the asset system
-        AssetSystem::GetInstance().StoreGeometryBuffers("Circle", vertexBuffer);
+        // Store the mesh in the asset system
+        AssetSystem::GetInstance().StoreMesh("Circle", CookedMesh::Cook(vertices.data(), nullptr, (uint32_t)vertices.size(), 
+            indices.data(), (uint32_t)indices.size()));
+        
+        geometryData = AssetSystem::GetInstance().GetGeometry("Circle"_id);
     }
 
+    m_geometryData = *geometryData;
+
     // Assign the rendering parameters
-    m_renderFunc = RenderFunction::RENDER_ARRAYS;
-    m_primitiveType = PrimitiveType::TRIANGLE_FAN;
-    m_count = 38;
+    m_renderFunc = RenderFunction::RENDER_ELEMENTS;
+    m_primitiveType = PrimitiveType::TRIANGLES;
+    m_count = m_geometryData.m_allocation.m_indexCount;
+    m_localBounds = { { -0.5f, -0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
 }
-
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// TODO: Optimise vertex data storage and loading
\ No newline at end of file
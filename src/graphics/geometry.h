@@ -3,7 +3,9 @@
 
 #include <core/asset_system.h>
 #include <graphics/vertex_array.h>
+#include <graphics/bounding_box.h>
 #include <glm/glm.hpp>
+#include <array>
 
 class Geometry
 {
@@ -25,6 +27,21 @@ public:
 		TRIANGLE_FAN = 0x0006
 	};
 	
+	// The features which the geometry shader permutations are specialised for, a permutation is identified by the bitmask of 
+	// its features. Each feature is enabled in the shader sources by the define listed in shaderFeatureDefines.
+	enum class ShaderFeature : uint32_t
+	{
+		TEXTURED = 0x1,
+		TEXTURE_ARRAY = 0x2, // The diffuse texture is a layer of a texture array, only used along with TEXTURED
+		QUANTIZED = 0x4 // The mesh is held in a quantized geometry pool, so its vertices are decoded by the shader
+	};
+
+	// The define which enables each feature, ordered by the bit of the feature.
+	static constexpr std::array<const char*, 3> shaderFeatureDefines = { "TEXTURED", "TEXTURE_ARRAY", "QUANTIZED" };
+
+	// The number of geometry shader permutations, one for each combination of features.
+	static constexpr uint32_t shaderPermutationCount = 1u << shaderFeatureDefines.size();
+
 	struct Transform
 	{
 		glm::vec3 m_position = glm::vec3(0.0f), m_size = glm::vec3(1.0f), m_rotationAxis = glm::vec3(1.0f);
@@ -36,22 +53,34 @@ public:
 		glm::vec4 m_diffuseColor = glm::vec4(1.0f);
 		Texture2DPtr m_diffuseTexture;
 
+		// If set then the given layer of the texture array is used as the diffuse texture, instead of the diffuse texture.
+		// Materials sharing a texture array can be drawn without rebinding textures in between.
+		Texture2DArrayPtr m_diffuseTextureArray;
+		uint32_t m_diffuseLayer = 0;
+
 		// If enabled then the textures in the material are used and the color vectors are 
 		// then used to modify the texture's color.
 		bool m_enableTextures = false;
+
+		// Returns the feature mask of the geometry shader permutation which renders the material.
+		uint32_t GetShaderFeatures() const;
+
+		// Returns the texture sampled for the diffuse color, or nullptr if the material is untextured.
+		const TextureBuffer* GetDiffuseTexture() const;
 	};
 protected:
 	Transform m_transformData; // Transform data
 	Material m_materialData; // Material data
 
-	VertexArray m_vertexArray; // VAO
+	AssetSystem::GeometryData m_geometryData; // Range of the geometry pool holding the mesh
+	BoundingBox m_localBounds; // Bounds of the vertices before the model matrix is applied
 
 	// Rendering parameters
 	RenderFunction m_renderFunc;
 	PrimitiveType m_primitiveType;
 	uint32_t m_count;
 protected:
-	// Used for initializing the geometry's buffer objects and specifying the rendering parameters.
+	// Used for initializing the geometry's mesh and specifying the rendering parameters.
 	virtual void InitGeometryData() = 0;
 public:
 	Geometry();
@@ -77,6 +106,10 @@ public:
 	// Note that you will need to enable textures using SetTexturesUsage() in order for textures to appear on this geometry.
 	void SetDiffuse(Texture2DPtr texture);
 
+	// Sets the diffuse texture of the geometry to a layer of the texture array, which takes precedence over a diffuse texture.
+	// Note that you will need to enable textures using SetTexturesUsage() in order for textures to appear on this geometry.
+	void SetDiffuse(Texture2DArrayPtr textureArray, uint32_t layer);
+
 	// Sets whether the material textures should be used on this geometry.
 	// If enabled, material textures should appear on the geometry and color vectors will be used as modifiers for 
 	// their respective texture. 
@@ -86,15 +119,38 @@ public:
 	// Returns the model matrix computed using the transform data.
 	glm::mat4 ComputeModelMatrix() const;
 
-	// Returns the geometry's vertex array.
+	// Returns the model matrix computed using the given transform data.
+	static glm::mat4 ComputeModelMatrix(const Transform& transform);
+
+	// Returns the transform which is the given fraction (alpha) of the way from the previous transform to the current one.
+	// This is used to render the geometry between two simulation ticks. The rotation axis is taken from the current transform.
+	static Transform InterpolateTransform(const Transform& previous, const Transform& current, float alpha);
+
+	// Returns the bounding box of the geometry in world space, computed by transforming the local bounds with the model matrix.
+	BoundingBox ComputeWorldBounds() const;
+
+	// Returns the bounding box which encloses the given bounds after being transformed by the given matrix.
+	static BoundingBox ComputeWorldBounds(const BoundingBox& localBounds, const glm::mat4& modelMatrix);
+
+	// Returns the vertex array of the geometry pool which holds the geometry's mesh.
 	const VertexArray& GetVertexArray() const;
 
+	// Returns the range of the geometry pool which holds the geometry's mesh, which is shared with all other geometry of the same type.
+	const AssetSystem::GeometryData& GetGeometryData() const;
+
+	// Returns the feature mask of the geometry shader permutation which renders the geometry, the material's features along 
+	// with those needed by the format of the geometry's mesh.
+	uint32_t GetShaderFeatures() const;
+
 	// Returns the geometry's transform data.
 	const Transform& GetTransformData() const;
 
 	// Returns the geometry's material data.
 	const Material& GetMaterialData() const;
 
+	// Returns the bounding box of the geometry's vertices, before the model matrix is applied.
+	const BoundingBox& GetLocalBounds() const;
+
 	// Returns an enum specifying the function to use to render the geometry.
 	RenderFunction GetRenderFunction() const;
 
@@ -105,6 +161,12 @@ public:
 	// For geometry using RenderFunction::RENDER_ARRAYS, the number of vertices should be returned. 
 	// For geometry using RenderFunction::RENDER_ELEMENTS, the number of indices should be returned. 
 	uint32_t GetCount() const;
+
+	// Returns the offset added to each index of the geometry's mesh, which is the position of its first vertex in the pool.
+	uint32_t GetBaseVertex() const;
+
+	// Returns the position of the first index of the geometry's mesh in the pool.
+	uint32_t GetFirstIndex() const;
 };
 
 class Square : public Geometry
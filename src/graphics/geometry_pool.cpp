@@ -0,0 +1,242 @@
+#include <graphics/geometry_pool.h>
+#include <graphics/gl_state_cache.h>
+#include <util/formatted_exception.h>
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+
+GeometryPool::GeometryPool(uint32_t vertexCapacity, uint32_t indexCapacity, VertexFormat vertexFormat, uint32_t indexSize) :
+    m_vertexFormat(vertexFormat), 
+    m_vertexSize(vertexFormat == VertexFormat::QUANTIZED ? sizeof(QuantizedVertex) : sizeof(Vertex)), m_indexSize(indexSize), 
+    m_vertexCapacity(0), m_indexCapacity(0), m_vertexTop(0), m_indexTop(0), m_allocatedVertexCount(0), m_allocatedIndexCount(0),
+    m_revision(0)
+{
+    if (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t))
+        throw FormattedException("Geometry pools can only hold 16-bit or 32-bit indices, not %u-byte indices.", indexSize);
+
+    m_vertexArray = std::make_unique<VertexArray>();
+    this->Grow(vertexCapacity, indexCapacity);
+}
+
+bool GeometryPool::AllocateRange(std::vector<Range>& freeRanges, uint32_t& top, uint32_t capacity, uint32_t count, uint32_t& offset)
+{
+    // Use the first free range which is large enough
+    for (auto rangeIterator = freeRanges.begin(); rangeIterator != freeRanges.end(); ++rangeIterator)
+    {
+        if (rangeIterator->m_count >= count)
+        {
+            offset = rangeIterator->m_offset;
+            rangeIterator->m_offset += count;
+            rangeIterator->m_count -= count;
+
+            if (rangeIterator->m_count == 0)
+                freeRanges.erase(rangeIterator);
+
+            return true;
+        }
+    }
+
+    // Otherwise bump allocate from the top of the buffer
+    if (capacity - top < count)
+        return false;
+
+    offset = top;
+    top += count;
+
+    return true;
+}
+
+void GeometryPool::FreeRange(std::vector<Range>& freeRanges, uint32_t& top, uint32_t offset, uint32_t count)
+{
+    if (count == 0)
+        return;
+
+    auto nextIterator = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset, [](const Range& range, uint32_t value)
+        { return range.m_offset < value; });
+    
+    auto rangeIterator = freeRanges.insert(nextIterator, { offset, count });
+
+    // Merge with the next free range if they're adjacent
+    auto nextRange = rangeIterator + 1;
+    if (nextRange != freeRanges.end() && rangeIterator->m_offset + rangeIterator->m_count == nextRange->m_offset)
+    {
+        rangeIterator->m_count += nextRange->m_count;
+        freeRanges.erase(nextRange);
+    }
+
+    // Merge with the previous free range if they're adjacent
+    if (rangeIterator != freeRanges.begin())
+    {
+        auto previousRange = rangeIterator - 1;
+        if (previousRange->m_offset + previousRange->m_count == rangeIterator->m_offset)
+        {
+            previousRange->m_count += rangeIterator->m_count;
+            rangeIterator = freeRanges.erase(rangeIterator) - 1;
+        }
+    }
+
+    // A free range at the top of the buffer is given back to the bump allocator
+    if (rangeIterator->m_offset + rangeIterator->m_count == top)
+    {
+        top = rangeIterator->m_offset;
+        freeRanges.erase(rangeIterator);
+    }
+}
+
+void GeometryPool::Grow(uint32_t minVertexCapacity, uint32_t minIndexCapacity)
+{
+    uint32_t vertexCapacity = std::max(m_vertexCapacity, 1u), indexCapacity = std::max(m_indexCapacity, 1u);
+    while (vertexCapacity < minVertexCapacity)
+        vertexCapacity *= 2;
+
+    while (indexCapacity < minIndexCapacity)
+        indexCapacity *= 2;
+
+    // Create the new buffers and copy the contents of the old ones into them
+    std::unique_ptr<VertexBuffer> vertexBuffer = std::make_unique<VertexBuffer>(nullptr, (size_t)vertexCapacity * m_vertexSize, 
+        GL_STATIC_DRAW);
+    
+    if (m_vertexFormat == VertexFormat::QUANTIZED)
+    {
+        // The integer components are passed to the shader unnormalized, since OpenGL 3.3 doesn't map signed normalized values 
+        // to exactly 0, the shader divides them instead
+        vertexBuffer->PushLayout(0, GL_SHORT, 3, sizeof(QuantizedVertex), offsetof(QuantizedVertex, m_position));
+        vertexBuffer->PushLayout(1, GL_HALF_FLOAT, 2, sizeof(QuantizedVertex), offsetof(QuantizedVertex, m_uvCoords));
+        vertexBuffer->PushLayout(8, GL_SHORT, 2, sizeof(QuantizedVertex), offsetof(QuantizedVertex, m_normal));
+    }
+    else
+    {
+        vertexBuffer->PushLayout(0, GL_FLOAT, 3, sizeof(Vertex), offsetof(Vertex, m_position));
+        vertexBuffer->PushLayout(1, GL_FLOAT, 2, sizeof(Vertex), offsetof(Vertex, m_uvCoords));
+    }
+
+    std::unique_ptr<IndexBuffer> indexBuffer = std::make_unique<IndexBuffer>(nullptr, (size_t)indexCapacity * m_indexSize, 
+        GL_STATIC_DRAW);
+
+    if (m_vertexBuffer && m_vertexTop > 0)
+    {
+        GLStateCache::GetInstance().BindBuffer(GL_COPY_READ_BUFFER, m_vertexBuffer->GetID());
+        GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->GetID());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (size_t)m_vertexTop * m_vertexSize);
+    }
+
+    if (m_indexBuffer && m_indexTop > 0)
+    {
+        GLStateCache::GetInstance().BindBuffer(GL_COPY_READ_BUFFER, m_indexBuffer->GetID());
+        GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer->GetID());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (size_t)m_indexTop * m_indexSize);
+    }
+
+    // Attach the new buffers to the existing vao, so that it keeps the same ID
+    m_vertexArray->AttachBuffers(*vertexBuffer, indexBuffer.get());
+
+    m_vertexBuffer = std::move(vertexBuffer);
+    m_indexBuffer = std::move(indexBuffer);
+    m_vertexCapacity = vertexCapacity;
+    m_indexCapacity = indexCapacity;
+    ++m_revision;
+}
+
+GeometryPool::Allocation GeometryPool::Allocate(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, 
+    uint32_t indexCount)
+{
+    if (m_vertexFormat != VertexFormat::STANDARD || m_indexSize != sizeof(uint32_t))
+        throw FormattedException("Standard vertices with 32-bit indices can't be copied into a pool with a different format.");
+
+    return this->AllocateData(vertices, vertexCount, indices, indexCount);
+}
+
+GeometryPool::Allocation GeometryPool::AllocateData(const void* vertexData, uint32_t vertexCount, const void* indexData, 
+    uint32_t indexCount)
+{
+    Allocation allocation;
+    allocation.m_vertexCount = vertexCount;
+    allocation.m_indexCount = indexCount;
+
+    // Find space for the mesh, growing the buffers if there isn't enough
+    if (!GeometryPool::AllocateRange(m_freeVertexRanges, m_vertexTop, m_vertexCapacity, vertexCount, allocation.m_baseVertex))
+    {
+        this->Grow(m_vertexTop + vertexCount, m_indexCapacity);
+        GeometryPool::AllocateRange(m_freeVertexRanges, m_vertexTop, m_vertexCapacity, vertexCount, allocation.m_baseVertex);
+    }
+
+    if (!GeometryPool::AllocateRange(m_freeIndexRanges, m_indexTop, m_indexCapacity, indexCount, allocation.m_firstIndex))
+    {
+        this->Grow(m_vertexCapacity, m_indexTop + indexCount);
+        GeometryPool::AllocateRange(m_freeIndexRanges, m_indexTop, m_indexCapacity, indexCount, allocation.m_firstIndex);
+    }
+
+    // Copy the mesh into its range of the buffers
+    m_vertexBuffer->ModifyData(vertexData, (size_t)allocation.m_baseVertex * m_vertexSize, (size_t)vertexCount * m_vertexSize);
+    m_indexBuffer->ModifyData(indexData, (size_t)allocation.m_firstIndex * m_indexSize, (size_t)indexCount * m_indexSize);
+
+    m_allocatedVertexCount += vertexCount;
+    m_allocatedIndexCount += indexCount;
+
+    return allocation;
+}
+
+void GeometryPool::Free(const Allocation& allocation)
+{
+    GeometryPool::FreeRange(m_freeVertexRanges, m_vertexTop, allocation.m_baseVertex, allocation.m_vertexCount);
+    GeometryPool::FreeRange(m_freeIndexRanges, m_indexTop, allocation.m_firstIndex, allocation.m_indexCount);
+
+    m_allocatedVertexCount -= allocation.m_vertexCount;
+    m_allocatedIndexCount -= allocation.m_indexCount;
+}
+
+const VertexBuffer& GeometryPool::GetVertexBuffer() const
+{
+    return *m_vertexBuffer;
+}
+
+const IndexBuffer& GeometryPool::GetIndexBuffer() const
+{
+    return *m_indexBuffer;
+}
+
+const VertexArray& GeometryPool::GetVertexArray() const
+{
+    return *m_vertexArray;
+}
+
+GeometryPool::VertexFormat GeometryPool::GetVertexFormat() const
+{
+    return m_vertexFormat;
+}
+
+uint32_t GeometryPool::GetVertexSize() const
+{
+    return m_vertexSize;
+}
+
+uint32_t GeometryPool::GetIndexSize() const
+{
+    return m_indexSize;
+}
+
+uint32_t GeometryPool::GetIndexType() const
+{
+    return m_indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+uint32_t GeometryPool::GetIndexTypeSize(uint32_t indexType)
+{
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+uint32_t GeometryPool::GetAllocatedVertexCount() const
+{
+    return m_allocatedVertexCount;
+}
+
+uint32_t GeometryPool::GetAllocatedIndexCount() const
+{
+    return m_allocatedIndexCount;
+}
+
+uint64_t GeometryPool::GetRevision() const
+{
+    return m_revision;
+}
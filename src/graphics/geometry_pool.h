@@ -0,0 +1,137 @@
+#ifndef GEOMETRY_POOL_H
+#define GEOMETRY_POOL_H
+
+#include <graphics/vertex_buffer.h>
+#include <graphics/index_buffer.h>
+#include <graphics/vertex_array.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Sub-allocates the vertices and indices of many meshes out of one large vertex buffer and index buffer, which share a 
+// single vertex array object.
+// Meshes in the pool are ranges of the buffers drawn using base-vertex draw calls, so drawing different meshes from the 
+// same pool doesn't require the vertex array object to be rebound.
+// Every mesh in a pool shares the pool's vertex format and index size. Indices are relative to the mesh's base vertex, so 16-bit 
+// indices can be used for any mesh with up to 65536 vertices, however large the pool is.
+class GeometryPool
+{
+public:
+	enum class VertexFormat
+	{
+		STANDARD, // Vertex
+		QUANTIZED // QuantizedVertex, which is decoded by the QUANTIZED permutations of the geometry shaders
+	};
+
+	// The vertex format of standard pools.
+	struct Vertex
+	{
+		glm::vec3 m_position;
+		glm::vec2 m_uvCoords;
+	};
+
+	// The vertex format of quantized pools, which takes up half the space of full precision floats with a normal (16 bytes 
+	// rather than 32), see CookedMesh.
+	struct QuantizedVertex
+	{
+		int16_t m_position[4]; // Signed normalized within the mesh's bounds, the fourth component is padding
+		uint16_t m_uvCoords[2]; // Half floats
+		int16_t m_normal[2]; // Signed normalized octahedral encoding of the unit normal
+	};
+
+	// The range of the pool's buffers which was allocated for a mesh.
+	// The indices of the mesh are relative to its base vertex.
+	struct Allocation
+	{
+		uint32_t m_baseVertex = 0, m_vertexCount = 0;
+		uint32_t m_firstIndex = 0, m_indexCount = 0;
+	};
+private:
+	// A free range of elements in one of the pool's buffers.
+	struct Range
+	{
+		uint32_t m_offset, m_count;
+	};
+
+	std::unique_ptr<VertexBuffer> m_vertexBuffer;
+	std::unique_ptr<IndexBuffer> m_indexBuffer;
+	std::unique_ptr<VertexArray> m_vertexArray;
+
+	VertexFormat m_vertexFormat;
+	uint32_t m_vertexSize, m_indexSize; // In bytes
+
+	uint32_t m_vertexCapacity, m_indexCapacity;
+	uint32_t m_vertexTop, m_indexTop; // The end of the highest allocated range in each buffer
+	std::vector<Range> m_freeVertexRanges, m_freeIndexRanges; // Sorted by offset
+	uint32_t m_allocatedVertexCount, m_allocatedIndexCount;
+
+	uint64_t m_revision; // Incremented whenever the buffer objects are replaced
+
+	// Finds space for the given number of elements, first in the free ranges then at the top of the buffer.
+	// Returns FALSE if there isn't enough space left in the buffer.
+	static bool AllocateRange(std::vector<Range>& freeRanges, uint32_t& top, uint32_t capacity, uint32_t count, uint32_t& offset);
+
+	// Returns the range given to the free ranges, merging it with any neighbouring free ranges.
+	static void FreeRange(std::vector<Range>& freeRanges, uint32_t& top, uint32_t offset, uint32_t count);
+
+	// Replaces the buffer objects with larger ones which can fit at least the number of vertices and indices given.
+	// The contents of the old buffers are copied over, and the vertex array object is kept.
+	void Grow(uint32_t minVertexCapacity, uint32_t minIndexCapacity);
+public:
+	GeometryPool(uint32_t vertexCapacity, uint32_t indexCapacity, VertexFormat vertexFormat = VertexFormat::STANDARD, 
+		uint32_t indexSize = sizeof(uint32_t));
+	GeometryPool(const GeometryPool& other) = delete;
+
+	~GeometryPool() = default;
+
+	GeometryPool& operator=(const GeometryPool& other) = delete;
+
+	// Copies the given mesh into the pool and returns the range of the buffers it was placed in.
+	// The buffers are grown if there isn't enough space left for the mesh. The pool must use the standard vertex format with 
+	// 32-bit indices.
+	Allocation Allocate(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+	// Copies the given mesh into the pool and returns the range of the buffers it was placed in, the data must already be in
+	// the pool's vertex format and index size.
+	Allocation AllocateData(const void* vertexData, uint32_t vertexCount, const void* indexData, uint32_t indexCount);
+
+	// Frees the range of the buffers used by the mesh, so that the space can be reused by other meshes.
+	void Free(const Allocation& allocation);
+
+	// Returns the vertex buffer which holds the vertices of every mesh in the pool.
+	const VertexBuffer& GetVertexBuffer() const;
+
+	// Returns the index buffer which holds the indices of every mesh in the pool.
+	const IndexBuffer& GetIndexBuffer() const;
+
+	// Returns the vertex array object which has the pool's buffer objects attached.
+	const VertexArray& GetVertexArray() const;
+
+	// Returns the format of the vertices in the pool.
+	VertexFormat GetVertexFormat() const;
+
+	// Returns the size of each vertex in the pool in bytes.
+	uint32_t GetVertexSize() const;
+
+	// Returns the size of each index in the pool in bytes, either 2 or 4.
+	uint32_t GetIndexSize() const;
+
+	// Returns the OpenGL type of the indices in the pool, which is passed to the draw calls.
+	uint32_t GetIndexType() const;
+
+	// Returns the size in bytes of the given OpenGL index type, either GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+	static uint32_t GetIndexTypeSize(uint32_t indexType);
+
+	// Returns the number of vertices and indices which are currently allocated in the pool.
+	uint32_t GetAllocatedVertexCount() const;
+	uint32_t GetAllocatedIndexCount() const;
+
+	// Returns a number which changes whenever the pool's buffer objects are replaced.
+	// Any other vertex array objects which the pool's buffers were attached to must be set up again when this changes.
+	uint64_t GetRevision() const;
+};
+
+#endif
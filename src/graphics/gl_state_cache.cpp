@@ -0,0 +1,221 @@
+#include <graphics/gl_state_cache.h>
+#include <glad/glad.h>
+
+namespace StateCache
+{
+    // Cached value used for state which is unknown, forcing the next change of the state to be passed on to OpenGL.
+    constexpr uint32_t unknownState = 0xFFFFFFFF;
+
+    // Returns the index of the given texture target in the cache, or -1 if the target isn't cached.
+    static int GetTextureTargetIndex(uint32_t target)
+    {
+        switch (target)
+        {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        case GL_TEXTURE_CUBE_MAP: return 2;
+        case GL_TEXTURE_3D: return 3;
+        default: return -1;
+        }
+    }
+
+    // Returns the index of the given buffer target in the cache, or -1 if the target isn't cached.
+    static int GetBufferTargetIndex(uint32_t target)
+    {
+        switch (target)
+        {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER: return 2;
+        case GL_PIXEL_UNPACK_BUFFER: return 3;
+        case GL_COPY_READ_BUFFER: return 4;
+        case GL_COPY_WRITE_BUFFER: return 5;
+        default: return -1;
+        }
+    }
+}
+
+GLStateCache::GLStateCache()
+{
+    this->Invalidate();
+}
+
+bool GLStateCache::UpdateState(uint32_t& cachedValue, uint32_t newValue)
+{
+    if (cachedValue == newValue)
+    {
+        ++m_frameStatistics.m_elidedCalls;
+        return false;
+    }
+
+    cachedValue = newValue;
+    ++m_frameStatistics.m_issuedCalls;
+    return true;
+}
+
+void GLStateCache::UseProgram(uint32_t id)
+{
+    if (this->UpdateState(m_program, id))
+        glUseProgram(id);
+}
+
+void GLStateCache::BindVertexArray(uint32_t id)
+{
+    if (this->UpdateState(m_vertexArray, id))
+    {
+        glBindVertexArray(id);
+
+        // The element array buffer binding belongs to the vertex array object, so it is unknown now
+        m_buffers[StateCache::GetBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = StateCache::unknownState;
+    }
+}
+
+void GLStateCache::BindTexture(uint32_t target, uint32_t id)
+{
+    const int targetIndex = StateCache::GetTextureTargetIndex(target);
+    if (targetIndex < 0 || m_activeTextureUnit >= maxTextureUnits)
+    {
+        glBindTexture(target, id);
+        ++m_frameStatistics.m_issuedCalls;
+    }
+    else if (this->UpdateState(m_textures[m_activeTextureUnit][targetIndex], id))
+        glBindTexture(target, id);
+}
+
+void GLStateCache::BindTexture(uint32_t textureUnit, uint32_t target, uint32_t id)
+{
+    if (this->UpdateState(m_activeTextureUnit, textureUnit))
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+
+    this->BindTexture(target, id);
+}
+
+void GLStateCache::BindBuffer(uint32_t target, uint32_t id)
+{
+    const int targetIndex = StateCache::GetBufferTargetIndex(target);
+    if (targetIndex < 0)
+    {
+        glBindBuffer(target, id);
+        ++m_frameStatistics.m_issuedCalls;
+    }
+    else if (this->UpdateState(m_buffers[targetIndex], id))
+        glBindBuffer(target, id);
+}
+
+void GLStateCache::SetBlendEnabled(bool enable)
+{
+    if (this->UpdateState(m_blendEnabled, (uint32_t)enable))
+        enable ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+}
+
+void GLStateCache::SetBlendFunc(uint32_t sourceFactor, uint32_t destinationFactor)
+{
+    // Both factors are set in the same call, so they are counted as a single state change
+    if (m_blendSourceFactor == sourceFactor && m_blendDestinationFactor == destinationFactor)
+    {
+        ++m_frameStatistics.m_elidedCalls;
+        return;
+    }
+
+    m_blendSourceFactor = sourceFactor;
+    m_blendDestinationFactor = destinationFactor;
+    ++m_frameStatistics.m_issuedCalls;
+
+    glBlendFunc(sourceFactor, destinationFactor);
+}
+
+void GLStateCache::SetDepthTestEnabled(bool enable)
+{
+    if (this->UpdateState(m_depthTestEnabled, (uint32_t)enable))
+        enable ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+}
+
+void GLStateCache::SetDepthMaskEnabled(bool enable)
+{
+    if (this->UpdateState(m_depthMaskEnabled, (uint32_t)enable))
+        glDepthMask(enable ? GL_TRUE : GL_FALSE);
+}
+
+void GLStateCache::SetDepthFunc(uint32_t func)
+{
+    if (this->UpdateState(m_depthFunc, func))
+        glDepthFunc(func);
+}
+
+void GLStateCache::OnProgramDeleted(uint32_t id)
+{
+    // A deleted program stays in use until another program is made current, so it's safest to forget which one is in use
+    if (id != 0 && m_program == id)
+        m_program = StateCache::unknownState;
+}
+
+void GLStateCache::OnVertexArrayDeleted(uint32_t id)
+{
+    if (id != 0 && m_vertexArray == id)
+    {
+        m_vertexArray = 0;
+        m_buffers[StateCache::GetBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = StateCache::unknownState;
+    }
+}
+
+void GLStateCache::OnTextureDeleted(uint32_t id)
+{
+    if (id == 0)
+        return;
+
+    for (std::array<uint32_t, numTextureTargets>& unitTextures : m_textures)
+    {
+        for (uint32_t& texture : unitTextures)
+        {
+            if (texture == id)
+                texture = 0;
+        }
+    }
+}
+
+void GLStateCache::OnBufferDeleted(uint32_t id)
+{
+    if (id == 0)
+        return;
+
+    for (uint32_t& buffer : m_buffers)
+    {
+        if (buffer == id)
+            buffer = 0;
+    }
+}
+
+void GLStateCache::Invalidate()
+{
+    m_program = m_vertexArray = m_activeTextureUnit = StateCache::unknownState;
+
+    for (std::array<uint32_t, numTextureTargets>& unitTextures : m_textures)
+        unitTextures.fill(StateCache::unknownState);
+
+    m_buffers.fill(StateCache::unknownState);
+
+    m_blendEnabled = m_blendSourceFactor = m_blendDestinationFactor = StateCache::unknownState;
+    m_depthTestEnabled = m_depthMaskEnabled = m_depthFunc = StateCache::unknownState;
+}
+
+void GLStateCache::EndFrame()
+{
+    m_lastFrameStatistics = m_frameStatistics;
+    m_frameStatistics = Statistics();
+}
+
+const GLStateCache::Statistics& GLStateCache::GetFrameStatistics() const
+{
+    return m_frameStatistics;
+}
+
+const GLStateCache::Statistics& GLStateCache::GetLastFrameStatistics() const
+{
+    return m_lastFrameStatistics;
+}
+
+GLStateCache& GLStateCache::GetInstance()
+{
+    static GLStateCache instance;
+    return instance;
+}
@@ -0,0 +1,94 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <array>
+#include <cstdint>
+
+// Keeps a shadow copy of the OpenGL binding and render state, so that calls which wouldn't change the current state can be
+// skipped before they reach the driver.
+// All graphics objects bind through this class, so any code which changes the state directly through OpenGL must call 
+// Invalidate() afterwards. Note that the cache tracks the state of a single OpenGL context.
+class GLStateCache
+{
+public:
+	struct Statistics
+	{
+		uint32_t m_issuedCalls = 0; // The number of state changes which were passed on to OpenGL
+		uint32_t m_elidedCalls = 0; // The number of state changes which were skipped since the state was already set
+	};
+private:
+	static constexpr uint32_t maxTextureUnits = 32, numTextureTargets = 4, numBufferTargets = 6;
+
+	uint32_t m_program, m_vertexArray, m_activeTextureUnit;
+	std::array<std::array<uint32_t, numTextureTargets>, maxTextureUnits> m_textures;
+	std::array<uint32_t, numBufferTargets> m_buffers;
+
+	uint32_t m_blendEnabled, m_blendSourceFactor, m_blendDestinationFactor;
+	uint32_t m_depthTestEnabled, m_depthMaskEnabled, m_depthFunc;
+
+	Statistics m_frameStatistics, m_lastFrameStatistics;
+
+	GLStateCache();
+
+	// Updates the cached value with the new value given and returns TRUE if the state needs to be changed.
+	// Either the issued or elided call counter is incremented depending on the result.
+	bool UpdateState(uint32_t& cachedValue, uint32_t newValue);
+public:
+	~GLStateCache() = default;
+
+	// Makes the specified shader program part of the current rendering state.
+	void UseProgram(uint32_t id);
+
+	// Binds the specified vertex array object.
+	void BindVertexArray(uint32_t id);
+
+	// Binds the specified texture to the given target of the currently active texture unit.
+	void BindTexture(uint32_t target, uint32_t id);
+
+	// Activates the given texture unit and binds the specified texture to the given target of it.
+	void BindTexture(uint32_t textureUnit, uint32_t target, uint32_t id);
+
+	// Binds the specified buffer object to the given target.
+	// Note that the element array buffer binding is part of the vertex array object state, so it is forgotten whenever the 
+	// bound vertex array object changes.
+	void BindBuffer(uint32_t target, uint32_t id);
+
+	// Sets whether blending is enabled.
+	void SetBlendEnabled(bool enable);
+
+	// Sets the source and destination factors used for blending.
+	void SetBlendFunc(uint32_t sourceFactor, uint32_t destinationFactor);
+
+	// Sets whether depth testing is enabled.
+	void SetDepthTestEnabled(bool enable);
+
+	// Sets whether writing into the depth buffer is enabled.
+	void SetDepthMaskEnabled(bool enable);
+
+	// Sets the function used to compare depth values when depth testing.
+	void SetDepthFunc(uint32_t func);
+
+	// Updates the cached state after the specified object has been deleted.
+	// These should be called after the object is deleted, since OpenGL reverts bindings of deleted objects back to zero.
+	void OnProgramDeleted(uint32_t id);
+	void OnVertexArrayDeleted(uint32_t id);
+	void OnTextureDeleted(uint32_t id);
+	void OnBufferDeleted(uint32_t id);
+
+	// Marks all of the cached state as unknown, so the next call to change any state is always passed on to OpenGL.
+	void Invalidate();
+
+	// Stores the statistics of the current frame, which can then be retrieved by GetLastFrameStatistics(), and resets them.
+	void EndFrame();
+
+	// Returns the statistics of the state changes requested so far in the current frame.
+	const Statistics& GetFrameStatistics() const;
+
+	// Returns the statistics of the state changes requested in the previous frame.
+	const Statistics& GetLastFrameStatistics() const;
+
+	// Returns singleton instance of the class.
+	static GLStateCache& GetInstance();
+};
+
+#endif
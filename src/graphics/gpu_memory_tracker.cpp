@@ -0,0 +1,37 @@
+#include <graphics/gpu_memory_tracker.h>
+
+GPUMemoryTracker::GPUMemoryTracker()
+{
+    for (std::atomic<size_t>& allocatedSize : m_allocatedSizes)
+        allocatedSize.store(0, std::memory_order_relaxed);
+}
+
+void GPUMemoryTracker::OnAllocated(Category category, size_t size)
+{
+    m_allocatedSizes[(size_t)category].fetch_add(size, std::memory_order_relaxed);
+}
+
+void GPUMemoryTracker::OnFreed(Category category, size_t size)
+{
+    m_allocatedSizes[(size_t)category].fetch_sub(size, std::memory_order_relaxed);
+}
+
+size_t GPUMemoryTracker::GetAllocatedSize(Category category) const
+{
+    return m_allocatedSizes[(size_t)category].load(std::memory_order_relaxed);
+}
+
+size_t GPUMemoryTracker::GetTotalAllocatedSize() const
+{
+    size_t totalSize = 0;
+    for (const std::atomic<size_t>& allocatedSize : m_allocatedSizes)
+        totalSize += allocatedSize.load(std::memory_order_relaxed);
+
+    return totalSize;
+}
+
+GPUMemoryTracker& GPUMemoryTracker::GetInstance()
+{
+    static GPUMemoryTracker instance;
+    return instance;
+}
@@ -0,0 +1,44 @@
+#ifndef GPU_MEMORY_TRACKER_H
+#define GPU_MEMORY_TRACKER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Keeps a running total of the GPU memory allocated by the texture and buffer objects, which report their allocations and frees
+// as they happen. The sizes are estimates, since drivers are free to pad and align storage however they like.
+// This can be used from any thread.
+class GPUMemoryTracker
+{
+public:
+	enum class Category : uint32_t
+	{
+		TEXTURE,
+		BUFFER,
+		COUNT
+	};
+private:
+	std::array<std::atomic<size_t>, (size_t)Category::COUNT> m_allocatedSizes;
+
+	GPUMemoryTracker();
+public:
+	~GPUMemoryTracker() = default;
+
+	// Records that the given number of bytes were allocated for an object of the category.
+	void OnAllocated(Category category, size_t size);
+
+	// Records that the given number of bytes allocated for an object of the category were freed.
+	void OnFreed(Category category, size_t size);
+
+	// Returns the number of bytes currently allocated for objects of the category.
+	size_t GetAllocatedSize(Category category) const;
+
+	// Returns the number of bytes currently allocated for objects of every category.
+	size_t GetTotalAllocatedSize() const;
+
+	// Returns singleton instance of the class.
+	static GPUMemoryTracker& GetInstance();
+};
+
+#endif
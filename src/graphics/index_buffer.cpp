@@ -1,52 +1,68 @@
 #include <graphics/index_buffer.h>
+#include <graphics/gl_state_cache.h>
+#include <graphics/gpu_memory_tracker.h>
 #include <glad/glad.h>
 
 IndexBuffer::IndexBuffer() :
-    m_id(0)
+    m_id(0), m_size(0)
 {}
 
-IndexBuffer::IndexBuffer(const void* data, size_t size, uint32_t usage)
+IndexBuffer::IndexBuffer(const void* data, size_t size, uint32_t usage) :
+    m_size(size)
 {
+    // The data is uploaded through the copy write target, since binding to the element array target would attach the buffer 
+    // to whichever vertex array object is currently bound
     glGenBuffers(1, &m_id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, data, usage);
+
+    GPUMemoryTracker::GetInstance().OnAllocated(GPUMemoryTracker::Category::BUFFER, size);
 }
 
 IndexBuffer::IndexBuffer(IndexBuffer&& temp) noexcept :
-    m_id(temp.m_id)
+    m_id(temp.m_id), m_size(temp.m_size)
 {
     temp.m_id = 0;
+    temp.m_size = 0;
 }
 
 IndexBuffer::~IndexBuffer()
 {
     glDeleteBuffers(1, &m_id);
+    GLStateCache::GetInstance().OnBufferDeleted(m_id);
+    GPUMemoryTracker::GetInstance().OnFreed(GPUMemoryTracker::Category::BUFFER, m_size);
 }
 
 IndexBuffer& IndexBuffer::operator=(IndexBuffer&& temp) noexcept
 {
     m_id = temp.m_id;
+    m_size = temp.m_size;
+
     temp.m_id = 0;
+    temp.m_size = 0;
 
     return *this;
 }
 
 void IndexBuffer::ModifyData(const void* data, size_t offset, size_t size)
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
 }
 
 void IndexBuffer::Bind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+    GLStateCache::GetInstance().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 }
 
 void IndexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::GetInstance().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+size_t IndexBuffer::GetAllocatedSize() const
+{
+    return m_size;
 }
 
 uint32_t IndexBuffer::GetID() const
@@ -7,6 +7,7 @@ class IndexBuffer
 {
 private:
 	uint32_t m_id;
+	size_t m_size; // The size of the buffer's data store in bytes
 public:
 	IndexBuffer();
 	IndexBuffer(const void* data, size_t size, uint32_t usage);
@@ -27,6 +28,9 @@ public:
 	// Unbinds the index buffer.
 	void Unbind() const;
 
+	// Returns the number of bytes of GPU memory allocated for the buffer's data store.
+	size_t GetAllocatedSize() const;
+
 	// Returns the ID of the index buffer.
 	uint32_t GetID() const;
 };
@@ -0,0 +1,229 @@
+#include <graphics/program_binary_cache.h>
+#include <util/asset_id.h>
+#include <util/logging_system.h>
+#include <util/time.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace ProgramBinaryParams
+{
+    constexpr char fileMagic[4] = { 'M', 'B', 'I', 'N' };
+    constexpr uint32_t fileVersion = 1;
+
+    // The enums of ARB_get_program_binary, which the OpenGL 3.3 loader doesn't define.
+    constexpr uint32_t programBinaryRetrievableHint = 0x8257;
+    constexpr uint32_t programBinaryLength = 0x8741;
+    constexpr uint32_t numProgramBinaryFormats = 0x87FE;
+}
+
+typedef void (APIENTRYP GetProgramBinaryFunction)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat,
+    void* binary);
+typedef void (APIENTRYP ProgramBinaryFunction)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriFunction)(GLuint program, GLenum pname, GLint value);
+
+ProgramBinaryCache::ProgramBinaryCache() :
+    m_supported(false), m_getProgramBinary(nullptr), m_programBinary(nullptr), m_programParameteri(nullptr)
+{}
+
+void ProgramBinaryCache::Init(const std::string& cacheDirectory)
+{
+    m_cacheDirectory = cacheDirectory;
+
+    const char* vendor = (const char*)glGetString(GL_VENDOR), *renderer = (const char*)glGetString(GL_RENDERER),
+        *version = (const char*)glGetString(GL_VERSION);
+
+    m_driverIdentity = std::string(vendor ? vendor : "") + "\n" + (renderer ? renderer : "") + "\n" + (version ? version : "");
+
+    // Program binaries are core from OpenGL 4.1, otherwise the driver has to expose the extension
+    int majorVersion = 0, minorVersion = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+    bool extensionSupported = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 1);
+
+    int extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+    for (int extensionIndex = 0; extensionIndex < extensionCount && !extensionSupported; extensionIndex++)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, extensionIndex);
+        if (extension && std::strcmp(extension, "GL_ARB_get_program_binary") == 0)
+            extensionSupported = true;
+    }
+
+    if (extensionSupported)
+    {
+        m_getProgramBinary = (void*)glfwGetProcAddress("glGetProgramBinary");
+        m_programBinary = (void*)glfwGetProcAddress("glProgramBinary");
+        m_programParameteri = (void*)glfwGetProcAddress("glProgramParameteri");
+    }
+
+    // Some drivers support the extension without supporting any binary formats
+    int binaryFormatCount = 0;
+    if (extensionSupported)
+        glGetIntegerv(ProgramBinaryParams::numProgramBinaryFormats, &binaryFormatCount);
+
+    m_supported = m_getProgramBinary && m_programBinary && m_programParameteri && binaryFormatCount > 0;
+
+    LOG_INFO("Shader program binary caching is %s.", m_supported ? "supported" :
+        "not supported, shaders will be compiled on every launch");
+}
+
+uint64_t ProgramBinaryCache::GetKey(std::string_view vshSource, std::string_view fshSource) const
+{
+    std::string keySource;
+    keySource.reserve(m_driverIdentity.size() + vshSource.size() + fshSource.size() + 2);
+    keySource.append(m_driverIdentity).append(1, '\0').append(vshSource).append(1, '\0').append(fshSource);
+
+    return AssetID::Hash(keySource);
+}
+
+std::string ProgramBinaryCache::GetBinaryFilePath(uint64_t key) const
+{
+    char fileName[32];
+    std::snprintf(fileName, sizeof(fileName), "%016llx.mbin", (unsigned long long)key);
+
+    return (std::filesystem::path(m_cacheDirectory) / fileName).string();
+}
+
+uint32_t ProgramBinaryCache::Load(uint64_t key)
+{
+    if (!m_supported)
+    {
+        m_statistics.m_missCount++;
+        return 0;
+    }
+
+    const double startSeconds = Time::GetSecondsSinceEpoch();
+
+    // Read the header and binary, checking they belong to the program being loaded
+    Header header = {};
+    std::vector<uint8_t> binary;
+
+    FILE* file = std::fopen(this->GetBinaryFilePath(key).c_str(), "rb");
+    if (file)
+    {
+        const bool headerValid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+            std::memcmp(header.m_magic, ProgramBinaryParams::fileMagic, sizeof(header.m_magic)) == 0 &&
+            header.m_version == ProgramBinaryParams::fileVersion && header.m_key == key;
+
+        if (headerValid)
+        {
+            binary.resize(header.m_binarySize);
+            if (std::fread(binary.data(), 1, binary.size(), file) != binary.size())
+                binary.clear();
+        }
+
+        std::fclose(file);
+    }
+
+    if (binary.empty())
+    {
+        m_statistics.m_missCount++;
+        return 0;
+    }
+
+    // The driver can still reject the binary, for example if it was updated without its version string changing
+    const uint32_t programID = glCreateProgram();
+    ((ProgramBinaryFunction)m_programBinary)(programID, header.m_binaryFormat, binary.data(), (GLsizei)binary.size());
+
+    int linkStatus = GL_FALSE;
+    glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+
+    if (linkStatus != GL_TRUE)
+    {
+        glDeleteProgram(programID);
+        m_statistics.m_missCount++;
+
+        LOG_WARNING("The driver rejected the cached shader program binary %016llx, recompiling it.", (unsigned long long)key);
+        return 0;
+    }
+
+    m_statistics.m_hitCount++;
+    m_statistics.m_secondsSaved += std::max(header.m_compileSeconds - (Time::GetSecondsSinceEpoch() - startSeconds), 0.0);
+
+    return programID;
+}
+
+void ProgramBinaryCache::PrepareProgram(uint32_t programID) const
+{
+    if (m_supported)
+        ((ProgramParameteriFunction)m_programParameteri)(programID, ProgramBinaryParams::programBinaryRetrievableHint, GL_TRUE);
+}
+
+void ProgramBinaryCache::Store(uint64_t key, uint32_t programID, double compileSeconds) const
+{
+    if (!m_supported)
+        return;
+
+    int binaryLength = 0;
+    glGetProgramiv(programID, ProgramBinaryParams::programBinaryLength, &binaryLength);
+    if (binaryLength <= 0)
+        return;
+
+    std::vector<uint8_t> binary((size_t)binaryLength);
+    GLsizei writtenLength = 0;
+    GLenum binaryFormat = 0;
+    ((GetProgramBinaryFunction)m_getProgramBinary)(programID, binaryLength, &writtenLength, &binaryFormat, binary.data());
+
+    if (writtenLength <= 0)
+        return;
+
+    Header header = {};
+    std::memcpy(header.m_magic, ProgramBinaryParams::fileMagic, sizeof(header.m_magic));
+    header.m_version = ProgramBinaryParams::fileVersion;
+    header.m_key = key;
+    header.m_binaryFormat = binaryFormat;
+    header.m_binarySize = (uint32_t)writtenLength;
+    header.m_compileSeconds = compileSeconds;
+
+    // Write under a temporary name and then rename, so that a partially written binary is never read
+    std::error_code error;
+    std::filesystem::create_directories(m_cacheDirectory, error);
+
+    const std::string filePath = this->GetBinaryFilePath(key);
+    const std::string temporaryFilePath = filePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+        ".tmp";
+
+    bool written = false;
+    FILE* file = std::fopen(temporaryFilePath.c_str(), "wb");
+    if (file)
+    {
+        written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(binary.data(), 1, header.m_binarySize, file) == header.m_binarySize;
+
+        written = std::fclose(file) == 0 && written;
+    }
+
+    if (written)
+        std::filesystem::rename(temporaryFilePath, filePath, error);
+
+    if (!written || error)
+    {
+        std::filesystem::remove(temporaryFilePath, error);
+        LOG_WARNING("Failed to write the shader program binary cache file at path: %s.", filePath.c_str());
+    }
+}
+
+bool ProgramBinaryCache::IsSupported() const
+{
+    return m_supported;
+}
+
+const ProgramBinaryCache::Statistics& ProgramBinaryCache::GetStatistics() const
+{
+    return m_statistics;
+}
+
+ProgramBinaryCache& ProgramBinaryCache::GetInstance()
+{
+    static ProgramBinaryCache instance;
+    return instance;
+}
@@ -0,0 +1,80 @@
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Caches the binaries of linked shader programs on disk (ARB_get_program_binary), so programs can be loaded on later launches
+// without compiling and linking their sources again.
+// Binaries are keyed by the hash of the program's sources along with the vendor, renderer and version strings of the driver, since
+// binaries are only valid for the driver which produced them. If the driver rejects a cached binary anyway, the program is compiled
+// from source and the binary is replaced.
+// Everything here must be done on the thread with the OpenGL context.
+class ProgramBinaryCache
+{
+public:
+	struct Statistics
+	{
+		uint32_t m_hitCount = 0; // The number of programs loaded from cached binaries
+		uint32_t m_missCount = 0; // The number of programs compiled from source, since no usable binary was cached
+		double m_secondsSaved = 0.0; // The time the hits took to compile when they were cached, minus the time taken to load them
+	};
+private:
+	// The header at the start of a cached binary file, which is followed by the binary.
+	struct Header
+	{
+		char m_magic[4];
+		uint32_t m_version;
+		uint64_t m_key; // Checked against the key of the program being loaded, in case of a hash collision in the file names
+		uint32_t m_binaryFormat, m_binarySize;
+		double m_compileSeconds; // The time taken to compile and link the program from source
+	};
+
+	bool m_supported;
+	std::string m_cacheDirectory;
+	std::string m_driverIdentity; // The vendor, renderer and version strings of the driver
+
+	void* m_getProgramBinary;
+	void* m_programBinary;
+	void* m_programParameteri;
+
+	Statistics m_statistics;
+
+	ProgramBinaryCache();
+
+	// Returns the path of the cached binary file of the program with the given key.
+	std::string GetBinaryFilePath(uint64_t key) const;
+public:
+	~ProgramBinaryCache() = default;
+
+	// Checks whether the driver supports program binaries and loads the functions needed to use them, which aren't part of
+	// OpenGL 3.3. Binaries are cached in the given directory, which is created when the first binary is stored.
+	// Renderer::Init() calls this before loading any shaders, programs compiled before then are never cached.
+	void Init(const std::string& cacheDirectory);
+
+	// Returns the key of the program with the given sources on the current driver.
+	uint64_t GetKey(std::string_view vshSource, std::string_view fshSource) const;
+
+	// Returns a new program created from the cached binary with the given key, or 0 if there's no binary cached or the driver
+	// rejected it. Either way the outcome is recorded in the statistics.
+	uint32_t Load(uint64_t key);
+
+	// Hints to the driver that the binary of the program will be retrieved. This must be called before the program is linked.
+	void PrepareProgram(uint32_t programID) const;
+
+	// Stores the binary of the linked program under the given key, along with the time taken to compile it.
+	// Failing to write the binary isn't an error, the program is just compiled from source again next time.
+	void Store(uint64_t key, uint32_t programID, double compileSeconds) const;
+
+	// Returns TRUE if Init() found that the driver supports program binaries.
+	bool IsSupported() const;
+
+	// Returns the hit and miss statistics of the cache since startup.
+	const Statistics& GetStatistics() const;
+
+	// Returns singleton instance of the class.
+	static ProgramBinaryCache& GetInstance();
+};
+
+#endif
@@ -1,21 +1,78 @@
 #include <graphics/renderer.h>
+#include <graphics/gl_state_cache.h>
+#include <graphics/cooked_texture.h>
+#include <graphics/program_binary_cache.h>
+#include <util/formatted_exception.h>
+#include <util/profiler.h>
+#include <util/logging_system.h>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <fstream>
+#include <array>
+#include <cstddef>
+#include <algorithm>
+#include <cstring>
+
+namespace RenderQueue
+{
+    constexpr uint32_t depthBits = 24;
+}
+
+namespace RendererParams
+{
+    // The directory which the binaries of linked shader programs are cached in.
+    constexpr const char* programBinaryCacheDirectory = "shader_cache";
+}
+
+namespace UniformBlocks
+{
+    // The uniform buffer binding point which the camera block is bound to.
+    constexpr uint32_t cameraBlockBinding = 0;
+}
+
+namespace Instancing
+{
+    // The number of instances each frame can stream into the instance stream before it has to grow.
+    constexpr size_t initialInstanceCapacity = 1024;
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Renderer::Init() const
+void Renderer::Init()
 {
     // Enable blending which allows for transparency rendering
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLStateCache::GetInstance().SetBlendEnabled(true);
+    GLStateCache::GetInstance().SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLStateCache::GetInstance().SetDepthTestEnabled(true); // Enable depth testing
+
+    // Find out whether textures can be cooked with compression, before any textures are loaded
+    CookedTexture::QueryCompressionSupport();
+
+    // Shader programs are loaded from the binary cache where possible, which has to be setup before any shaders are compiled
+    ProgramBinaryCache::GetInstance().Init(RendererParams::programBinaryCacheDirectory);
 
-    glEnable(GL_DEPTH_TEST); // Enable depth testing
+    // Initialize the shaders required by the renderer, along with their permutations for each combination of features
+    const std::vector<std::string> featureDefines(Geometry::shaderFeatureDefines.begin(), Geometry::shaderFeatureDefines.end());
+    AssetSystem::GetInstance().LoadShader("Geometry", "shaders/common.glsl.vsh", "shaders/geometry.glsl.fsh", featureDefines);
+    AssetSystem::GetInstance().LoadShader("GeometryInstanced", "shaders/instanced.glsl.vsh", "shaders/geometry.glsl.fsh", 
+        featureDefines);
 
-    // Initialize the shaders required by the renderer
-    AssetSystem::GetInstance().LoadShader("Geometry", "shaders/common.glsl.vsh", "shaders/geometry.glsl.fsh");
+    // Setup the camera block, which is bound at a fixed binding point that every shader's camera block is assigned to
+    m_cameraBlockBuffer = std::make_unique<UniformBuffer>(nullptr, sizeof(CameraBlock), GL_DYNAMIC_DRAW);
+    m_cameraBlockBuffer->BindBase(UniformBlocks::cameraBlockBinding);
+    m_cameraBlockRevision = 0;
+
+    m_geometryShaders = Renderer::LoadGeometryShaders("Geometry"_id);
+    m_instancedGeometryShaders = Renderer::LoadGeometryShaders("GeometryInstanced"_id);
+
+    const ProgramBinaryCache::Statistics& binaryCacheStatistics = ProgramBinaryCache::GetInstance().GetStatistics();
+    LOG_INFO("Loaded %u shader programs from the binary cache and compiled %u, saving %.1f ms.", binaryCacheStatistics.m_hitCount,
+        binaryCacheStatistics.m_missCount, binaryCacheStatistics.m_secondsSaved * 1000.0);
+
+    // Setup the stream which the instance data is written into each frame
+    m_instanceStream = std::make_unique<StreamingBuffer>(GL_ARRAY_BUFFER, Instancing::initialInstanceCapacity * sizeof(InstanceData));
 }
 
 void Renderer::Clear(ClearFlag mask, const glm::vec4& color)
@@ -24,35 +81,431 @@ void Renderer::Clear(ClearFlag mask, const glm::vec4& color)
     glClear((uint32_t)mask);
 }
 
-void Renderer::Render(const Camera3D& camera, const Geometry& geometry) const
+void Renderer::Render(const Camera3D& camera, const Geometry& geometry)
 {
-    AssetSystem::GetInstance().GetShader("Geometry")->Bind(); // Bind the geometry shader
+    PROFILE_SCOPE("Renderer::Render");
 
-    // Assign the matrix shader uniforms
-    AssetSystem::GetInstance().GetShader("Geometry")->SetUniformEx("v_modelMatrix", geometry.ComputeModelMatrix());
-    AssetSystem::GetInstance().GetShader("Geometry")->SetUniformEx("v_cameraMatrix", camera.ComputeProjectionMatrix() *
-        camera.ComputeViewMatrix());
+    ++m_frameStatistics.m_submittedDraws;
+    if (!FrustumCuller::IsVisible(camera.ComputeFrustumPlanes(), geometry.ComputeWorldBounds()))
+        return;
 
-    // Assign the material shader uniforms
+    // Bind the permutation of the geometry shader for the geometry's features
     const Geometry::Material& material = geometry.GetMaterialData();
+    const GeometryShader& geometryShader = m_geometryShaders[geometry.GetShaderFeatures()];
 
-    AssetSystem::GetInstance().GetShader("Geometry")->SetUniformEx("f_material.m_diffuseColor", material.m_diffuseColor);
-    AssetSystem::GetInstance().GetShader("Geometry")->SetUniform("f_material.m_enableTextures", material.m_enableTextures);
+    this->UpdateCameraBlock(camera);
+    geometryShader.m_shader->Bind();
 
-    if (material.m_diffuseTexture)
+    // Assign the matrix shader uniforms, along with the dequantization uniforms which only quantized permutations use
+    geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_modelMatrix, geometry.ComputeModelMatrix());
+    geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_positionScale, geometry.GetGeometryData().m_positionScale);
+    geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_positionOffset, geometry.GetGeometryData().m_positionOffset);
+
+    // Assign the material shader uniforms
+    geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_diffuseColor, material.m_diffuseColor);
+
+    if (const TextureBuffer* diffuseTexture = material.GetDiffuseTexture())
     {
-        AssetSystem::GetInstance().GetShader("Geometry")->SetUniform("f_material.m_diffuseTexture", 0);
-        material.m_diffuseTexture->Bind(0); // Bind the diffuse texture
+        geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_diffuseTexture, 0);
+        geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_diffuseLayer, (int)material.m_diffuseLayer);
+        diffuseTexture->Bind(0); // Bind the diffuse texture
     }
 
-    // Bind the geometry vao
+    // Bind the geometry vao and draw the geometry
     geometry.GetVertexArray().Bind();
+    this->IssueDrawCall(geometry.GetRenderFunction(), geometry.GetPrimitiveType(), geometry.GetCount(), geometry.GetFirstIndex(),
+        geometry.GetBaseVertex(), geometry.GetGeometryData().m_pool->GetIndexType());
+}
+
+void Renderer::RenderInstanced(const Camera3D& camera, const Geometry& geometry, const std::vector<Geometry::Transform>& transforms,
+    const std::vector<glm::vec4>& diffuseColors)
+{
+    if (!diffuseColors.empty() && diffuseColors.size() != transforms.size())
+    {
+        throw FormattedException("The number of diffuse colors given (%zu) doesn't match the number of transforms given (%zu).",
+            diffuseColors.size(), transforms.size());
+    }
+
+    // Compute the per-instance data
+    m_instanceData.resize(transforms.size());
+    for (size_t index = 0; index < transforms.size(); index++)
+    {
+        m_instanceData[index].m_modelMatrix = Geometry::ComputeModelMatrix(transforms[index]);
+        m_instanceData[index].m_diffuseColor = diffuseColors.empty() ? geometry.GetMaterialData().m_diffuseColor : 
+            diffuseColors[index];
+        m_instanceData[index].m_diffuseLayer = (int32_t)geometry.GetMaterialData().m_diffuseLayer;
+    }
+
+    this->RenderInstanced(camera, geometry, m_instanceData.data(), m_instanceData.size());
+}
+
+void Renderer::RenderInstanced(const Camera3D& camera, const Geometry& geometry, const InstanceData* instances, size_t instanceCount)
+{
+    PROFILE_SCOPE("Renderer::RenderInstanced");
+
+    if (instanceCount == 0)
+        return;
+
+    m_frameStatistics.m_submittedDraws += (uint32_t)instanceCount;
+
+    // Stream the instance data into this frame's region of the instance stream
+    const StreamingBuffer::Allocation allocation = m_instanceStream->Allocate(instanceCount * sizeof(InstanceData));
+    std::memcpy(allocation.m_data, instances, instanceCount * sizeof(InstanceData));
+    m_instanceStream->Unmap();
+
+    // Bind the permutation of the instanced geometry shader for the geometry's features and assign the shader uniforms
+    const Geometry::Material& material = geometry.GetMaterialData();
+    const GeometryShader& geometryShader = m_instancedGeometryShaders[geometry.GetShaderFeatures()];
+
+    this->UpdateCameraBlock(camera);
+    geometryShader.m_shader->Bind();
+    geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_positionScale, geometry.GetGeometryData().m_positionScale);
+    geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_positionOffset, geometry.GetGeometryData().m_positionOffset);
+
+    // With a texture array, each instance samples the layer given in its instance data
+    if (const TextureBuffer* diffuseTexture = material.GetDiffuseTexture())
+    {
+        geometryShader.m_shader->SetUniform(geometryShader.m_uniforms.m_diffuseTexture, 0);
+        diffuseTexture->Bind(0); // Bind the diffuse texture
+    }
+
+    // Bind the instanced vao, point it at the streamed instance data and draw every instance of the geometry
+    this->GetInstancedVertexArray(geometry).Bind();
+    this->SpecifyInstanceAttributes(allocation.m_offset);
+    this->IssueDrawCall(geometry.GetRenderFunction(), geometry.GetPrimitiveType(), geometry.GetCount(), geometry.GetFirstIndex(),
+        geometry.GetBaseVertex(), geometry.GetGeometryData().m_pool->GetIndexType(), (uint32_t)instanceCount);
+}
+
+void Renderer::Submit(const Camera3D& camera, const Geometry& geometry)
+{
+    this->Submit(camera, DrawCommand::FromGeometry(geometry, geometry.ComputeModelMatrix()));
+}
+
+void Renderer::Submit(const Camera3D& camera, const DrawCommand& command)
+{
+    const GeometryPool::Allocation& allocation = command.m_geometryData.m_allocation;
+
+    DrawPacket packet;
+    packet.m_modelMatrix = command.m_modelMatrix;
+    packet.m_diffuseColor = command.m_diffuseColor;
+    packet.m_shader = m_geometryShaders[command.m_shaderFeatures].m_shader.get();
+    packet.m_diffuseTexture = (command.m_shaderFeatures & (uint32_t)Geometry::ShaderFeature::TEXTURED) ? command.m_diffuseTexture : 
+        nullptr;
+    packet.m_diffuseLayer = command.m_diffuseLayer;
+    packet.m_positionScale = command.m_geometryData.m_positionScale;
+    packet.m_positionOffset = command.m_geometryData.m_positionOffset;
+    packet.m_vertexArrayID = command.m_geometryData.m_pool->GetVertexArray().GetID();
+    packet.m_count = command.m_count;
+    packet.m_firstIndex = allocation.m_firstIndex;
+    packet.m_baseVertex = allocation.m_baseVertex;
+    packet.m_indexType = command.m_geometryData.m_pool->GetIndexType();
+    packet.m_primitiveType = command.m_primitiveType;
+    packet.m_renderFunc = command.m_renderFunc;
+    packet.m_shaderFeatures = command.m_shaderFeatures;
+
+    // The translation of the model matrix gives the position of the geometry in the world
+    const float cameraDistance = glm::length(glm::vec3(packet.m_modelMatrix[3]) - camera.GetPosition());
+    const float normalizedCameraDistance = (cameraDistance - camera.GetNearPlane()) / (camera.GetFarPlane() - camera.GetNearPlane());
+
+    ++m_frameStatistics.m_submittedDraws;
+    m_sortEntries.push_back({ Renderer::ComputeSortKey(packet, normalizedCameraDistance), (uint32_t)m_drawQueue.size() });
+    m_drawQueue.push_back(packet);
+    m_culler.AddBoundingBox(Geometry::ComputeWorldBounds(command.m_localBounds, packet.m_modelMatrix));
+}
+
+void Renderer::Flush(const Camera3D& camera)
+{
+    PROFILE_SCOPE("Renderer::Flush");
+    PROFILE_GPU_SCOPE("Renderer::Flush");
+
+    if (m_drawQueue.empty())
+        return;
+
+    // Cull the queued geometry as one batch, then remove the packets which weren't visible before sorting
+    m_culler.Cull(camera.ComputeFrustumPlanes());
+    m_sortEntries.erase(std::remove_if(m_sortEntries.begin(), m_sortEntries.end(), [this](const SortEntry& entry)
+        { return !m_culler.IsVisible(entry.m_packetIndex); }), m_sortEntries.end());
+
+    if (!m_sortEntries.empty())
+        this->SortDrawQueue();
+
+    this->UpdateCameraBlock(camera);
+
+    const ShaderProgram* boundShader = nullptr;
+    const GeometryUniforms* boundUniforms = nullptr;
+
+    // Issue the draws in sorted order, the state cache skips binds of the texture and VAO if they haven't changed
+    // Submitted geometry is always drawn with a permutation of the geometry shader, whose uniform handles are looked up by
+    // the packet's features whenever the bound permutation changes
+    for (size_t entryIndex = 0; entryIndex < m_sortEntries.size();)
+    {
+        const DrawPacket& packet = m_drawQueue[m_sortEntries[entryIndex].m_packetIndex];
+
+        if (packet.m_shader != boundShader)
+        {
+            boundShader = packet.m_shader;
+            boundUniforms = &m_geometryShaders[packet.m_shaderFeatures].m_uniforms;
+
+            boundShader->Bind();
+            boundShader->SetUniform(boundUniforms->m_diffuseTexture, 0);
+        }
+
+        if (packet.m_diffuseTexture)
+            packet.m_diffuseTexture->Bind(0);
+
+        GLStateCache::GetInstance().BindVertexArray(packet.m_vertexArrayID);
+
+        // Assign the per-object shader uniforms
+        boundShader->SetUniform(boundUniforms->m_modelMatrix, packet.m_modelMatrix);
+        boundShader->SetUniform(boundUniforms->m_diffuseColor, packet.m_diffuseColor);
+        boundShader->SetUniform(boundUniforms->m_diffuseLayer, (int)packet.m_diffuseLayer);
+        boundShader->SetUniform(boundUniforms->m_positionScale, packet.m_positionScale);
+        boundShader->SetUniform(boundUniforms->m_positionOffset, packet.m_positionOffset);
+
+        // Find the run of following packets which can be drawn along with this one
+        size_t runEnd = entryIndex + 1;
+        while (runEnd < m_sortEntries.size() && Renderer::CanMergeDraws(packet, m_drawQueue[m_sortEntries[runEnd].m_packetIndex]))
+            ++runEnd;
+
+        if (runEnd - entryIndex == 1)
+        {
+            this->IssueDrawCall(packet.m_renderFunc, packet.m_primitiveType, packet.m_count, packet.m_firstIndex, 
+                packet.m_baseVertex, packet.m_indexType);
+        }
+        else
+        {
+            m_multiDrawCounts.clear();
+            m_multiDrawIndexOffsets.clear();
+            m_multiDrawBaseVertices.clear();
+
+            // Merged draws share a VAO, so their indices are all the same type
+            for (size_t runIndex = entryIndex; runIndex < runEnd; runIndex++)
+            {
+                const DrawPacket& runPacket = m_drawQueue[m_sortEntries[runIndex].m_packetIndex];
+                m_multiDrawCounts.push_back((int32_t)runPacket.m_count);
+                m_multiDrawIndexOffsets.push_back(
+                    (const void*)((size_t)runPacket.m_firstIndex * GeometryPool::GetIndexTypeSize(packet.m_indexType)));
+                m_multiDrawBaseVertices.push_back((int32_t)runPacket.m_baseVertex);
+            }
+
+            glMultiDrawElementsBaseVertex((uint32_t)packet.m_primitiveType, m_multiDrawCounts.data(), packet.m_indexType, 
+                m_multiDrawIndexOffsets.data(), (int32_t)m_multiDrawCounts.size(), m_multiDrawBaseVertices.data());
+            ++m_frameStatistics.m_drawCalls;
+        }
+
+        entryIndex = runEnd;
+    }
+
+    m_drawQueue.clear();
+    m_sortEntries.clear();
+    m_culler.Clear();
+}
 
-    // Draw the geometry
-    if (geometry.GetRenderFunction() == Geometry::RenderFunction::RENDER_ARRAYS)
-        glDrawArrays((uint32_t)geometry.GetPrimitiveType(), 0, geometry.GetCount());
-    else if (geometry.GetRenderFunction() == Geometry::RenderFunction::RENDER_ELEMENTS)
-        glDrawElements((uint32_t)geometry.GetPrimitiveType(), geometry.GetCount(), GL_UNSIGNED_INT, nullptr);
+void Renderer::RenderPacket(const FramePacket& packet)
+{
+    PROFILE_SCOPE("Renderer::RenderPacket");
+
+    this->Clear(ClearFlag::COLOR_BUFFER_BIT | ClearFlag::DEPTH_BUFFER_BIT, packet.m_clearColor);
+
+    for (const DrawCommand& command : packet.m_drawCommands)
+        this->Submit(packet.m_camera, command);
+
+    this->Flush(packet.m_camera);
+}
+
+void Renderer::EndFrame()
+{
+    m_instanceStream->EndFrame();
+
+    m_lastFrameStatistics = m_frameStatistics;
+    m_frameStatistics = Statistics();
+}
+
+const Renderer::Statistics& Renderer::GetLastFrameStatistics() const
+{
+    return m_lastFrameStatistics;
+}
+
+const FrustumCuller::Statistics& Renderer::GetCullingStatistics() const
+{
+    return m_culler.GetLastStatistics();
+}
+
+const StreamingBuffer::Statistics& Renderer::GetStreamingStatistics() const
+{
+    return m_instanceStream->GetLastFrameStatistics();
+}
+
+Renderer::GeometryUniforms Renderer::GetGeometryUniforms(const ShaderProgram& shader)
+{
+    GeometryUniforms uniforms;
+    uniforms.m_modelMatrix = shader.GetUniformHandle<glm::mat4>("v_modelMatrix");
+    uniforms.m_diffuseColor = shader.GetUniformHandle<glm::vec4>("v_diffuseColor");
+    uniforms.m_diffuseTexture = shader.GetUniformHandle<int>("f_diffuseTexture");
+    uniforms.m_diffuseLayer = shader.GetUniformHandle<int>("v_diffuseLayer");
+    uniforms.m_positionScale = shader.GetUniformHandle<glm::vec3>("v_positionScale");
+    uniforms.m_positionOffset = shader.GetUniformHandle<glm::vec3>("v_positionOffset");
+
+    return uniforms;
+}
+
+std::array<Renderer::GeometryShader, Geometry::shaderPermutationCount> Renderer::LoadGeometryShaders(AssetID id)
+{
+    std::array<GeometryShader, Geometry::shaderPermutationCount> permutations;
+    for (uint32_t featureMask = 0; featureMask < Geometry::shaderPermutationCount; featureMask++)
+    {
+        GeometryShader& permutation = permutations[featureMask];
+        const uint32_t textureArrayMask = (uint32_t)Geometry::ShaderFeature::TEXTURE_ARRAY;
+        if ((featureMask & textureArrayMask) && !(featureMask & (uint32_t)Geometry::ShaderFeature::TEXTURED))
+        {
+            permutation = permutations[featureMask & ~textureArrayMask];
+            continue;
+        }
+
+        permutation.m_shader = AssetSystem::GetInstance().GetShaderPermutation(id, featureMask);
+        permutation.m_shader->SetUniformBlockBinding("CameraBlock", UniformBlocks::cameraBlockBinding);
+
+        if (permutation.m_shader->GetUniformBlockSize("CameraBlock") != sizeof(CameraBlock))
+            throw FormattedException("The size of the shader camera block doesn't match the size of the renderer's camera block.");
+
+        permutation.m_uniforms = Renderer::GetGeometryUniforms(*permutation.m_shader);
+    }
+
+    return permutations;
+}
+
+void Renderer::UpdateCameraBlock(const Camera3D& camera)
+{
+    if (camera.GetRevision() == m_cameraBlockRevision)
+        return;
+
+    CameraBlock cameraBlock;
+    cameraBlock.m_viewMatrix = camera.ComputeViewMatrix();
+    cameraBlock.m_projectionMatrix = camera.ComputeProjectionMatrix();
+    cameraBlock.m_viewProjectionMatrix = cameraBlock.m_projectionMatrix * cameraBlock.m_viewMatrix;
+    cameraBlock.m_position = glm::vec4(camera.GetPosition(), 1.0f);
+    cameraBlock.m_clipPlanes = { camera.GetNearPlane(), camera.GetFarPlane() };
+    cameraBlock.m_padding = glm::vec2(0.0f);
+
+    m_cameraBlockBuffer->ModifyData(&cameraBlock, 0, sizeof(CameraBlock));
+    m_cameraBlockRevision = camera.GetRevision();
+}
+
+uint64_t Renderer::ComputeSortKey(const DrawPacket& packet, float normalizedCameraDistance)
+{
+    const uint64_t shaderBits = packet.m_shader->GetID() & 0xFF;
+    const uint64_t textureBits = packet.m_diffuseTexture ? (packet.m_diffuseTexture->GetID() & 0xFFFF) : 0;
+    const uint64_t vertexArrayBits = packet.m_vertexArrayID & 0xFFFF;
+
+    // Quantize the camera distance so that nearer geometry is drawn first within a group, reducing overdraw
+    constexpr uint64_t maxDepthValue = (1ull << RenderQueue::depthBits) - 1;
+    const uint64_t depthBits = (uint64_t)(glm::clamp(normalizedCameraDistance, 0.0f, 1.0f) * (float)maxDepthValue);
+
+    return (shaderBits << 56) | (textureBits << 40) | (vertexArrayBits << 24) | depthBits;
+}
+
+void Renderer::SortDrawQueue()
+{
+    m_sortScratch.resize(m_sortEntries.size());
+
+    // Sort 8 bits of the key at a time, starting from the least significant byte
+    for (uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        std::array<uint32_t, 256> bucketOffsets = {};
+        for (const SortEntry& entry : m_sortEntries)
+            ++bucketOffsets[(entry.m_key >> shift) & 0xFF];
+
+        // Skip the pass if every key has the same value for this byte, since it wouldn't change the order
+        if (bucketOffsets[(m_sortEntries.front().m_key >> shift) & 0xFF] == m_sortEntries.size())
+            continue;
+
+        // Convert the bucket counts into the starting offset of each bucket
+        uint32_t runningOffset = 0;
+        for (uint32_t& bucketOffset : bucketOffsets)
+        {
+            const uint32_t bucketCount = bucketOffset;
+            bucketOffset = runningOffset;
+            runningOffset += bucketCount;
+        }
+
+        for (const SortEntry& entry : m_sortEntries)
+            m_sortScratch[bucketOffsets[(entry.m_key >> shift) & 0xFF]++] = entry;
+
+        m_sortEntries.swap(m_sortScratch);
+    }
+}
+
+const VertexArray& Renderer::GetInstancedVertexArray(const Geometry& geometry)
+{
+    const GeometryPool& geometryPool = *geometry.GetGeometryData().m_pool;
+
+    InstancedVertexArray& instancedVertexArray = m_instancedVertexArrays[geometryPool.GetVertexArray().GetID()];
+    if (!instancedVertexArray.m_vertexArray || instancedVertexArray.m_poolRevision != geometryPool.GetRevision())
+    {
+        instancedVertexArray.m_vertexArray = std::make_shared<VertexArray>();
+        instancedVertexArray.m_vertexArray->AttachBuffers(geometryPool.GetVertexBuffer(), &geometryPool.GetIndexBuffer());
+        instancedVertexArray.m_poolRevision = geometryPool.GetRevision();
+    }
+
+    return *instancedVertexArray.m_vertexArray;
+}
+
+void Renderer::SpecifyInstanceAttributes(size_t offset) const
+{
+    m_instanceStream->Bind();
+
+    // The model matrix takes up four attribute locations (one for each column)
+    for (uint32_t column = 0; column < 4; column++)
+    {
+        const size_t columnOffset = offset + offsetof(InstanceData, m_modelMatrix) + (column * sizeof(glm::vec4));
+
+        glEnableVertexAttribArray(2 + column);
+        glVertexAttribPointer(2 + column, 4, GL_FLOAT, false, sizeof(InstanceData), (const void*)columnOffset);
+        glVertexAttribDivisor(2 + column, 1);
+    }
+
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, false, sizeof(InstanceData), (const void*)(offset + offsetof(InstanceData, m_diffuseColor)));
+    glVertexAttribDivisor(6, 1);
+
+    // The layer is an integer attribute, so it isn't converted to a float, and it's signed like the shader's input
+    glEnableVertexAttribArray(7);
+    glVertexAttribIPointer(7, 1, GL_INT, sizeof(InstanceData), 
+        (const void*)(offset + offsetof(InstanceData, m_diffuseLayer)));
+    glVertexAttribDivisor(7, 1);
+}
+
+bool Renderer::CanMergeDraws(const DrawPacket& first, const DrawPacket& second)
+{
+    // The diffuse texture is only set for textured permutations, so comparing the shaders and textures covers the features
+    return first.m_renderFunc == Geometry::RenderFunction::RENDER_ELEMENTS && 
+        second.m_renderFunc == Geometry::RenderFunction::RENDER_ELEMENTS && first.m_shader == second.m_shader && 
+        first.m_vertexArrayID == second.m_vertexArrayID && first.m_primitiveType == second.m_primitiveType && 
+        first.m_diffuseTexture == second.m_diffuseTexture && first.m_diffuseLayer == second.m_diffuseLayer && 
+        first.m_diffuseColor == second.m_diffuseColor && first.m_positionScale == second.m_positionScale && 
+        first.m_positionOffset == second.m_positionOffset && first.m_modelMatrix == second.m_modelMatrix;
+}
+
+void Renderer::IssueDrawCall(Geometry::RenderFunction renderFunc, Geometry::PrimitiveType primitiveType, uint32_t count,
+    uint32_t firstIndex, uint32_t baseVertex, uint32_t indexType, uint32_t instanceCount)
+{
+    const void* indexOffset = (const void*)((size_t)firstIndex * GeometryPool::GetIndexTypeSize(indexType));
+    ++m_frameStatistics.m_drawCalls;
+
+    if (instanceCount > 1)
+    {
+        if (renderFunc == Geometry::RenderFunction::RENDER_ARRAYS)
+            glDrawArraysInstanced((uint32_t)primitiveType, baseVertex, count, instanceCount);
+        else if (renderFunc == Geometry::RenderFunction::RENDER_ELEMENTS)
+        {
+            glDrawElementsInstancedBaseVertex((uint32_t)primitiveType, count, indexType, indexOffset, instanceCount, 
+                baseVertex);
+        }
+    }
+    else if (renderFunc == Geometry::RenderFunction::RENDER_ARRAYS)
+        glDrawArrays((uint32_t)primitiveType, baseVertex, count);
+    else if (renderFunc == Geometry::RenderFunction::RENDER_ELEMENTS)
+        glDrawElementsBaseVertex((uint32_t)primitiveType, count, indexType, indexOffset, baseVertex);
 }
 
 Renderer& Renderer::GetInstance()
@@ -68,4 +521,4 @@ Renderer::ClearFlag operator|(Renderer::ClearFlag lhs, Renderer::ClearFlag rhs)
     return (Renderer::ClearFlag)((uint32_t)lhs | (uint32_t)rhs);
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
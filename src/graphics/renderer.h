@@ -5,11 +5,149 @@
 #include <core/asset_system.h>
 #include <graphics/camera_3d.h>
 #include <graphics/geometry.h>
+#include <graphics/frame_packet.h>
+#include <graphics/uniform_buffer.h>
+#include <graphics/frustum_culler.h>
+#include <graphics/streaming_buffer.h>
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <memory>
 
 class Renderer
 {
+public:
+	// The per-instance data streamed to the GPU when rendering instanced geometry.
+	struct InstanceData
+	{
+		glm::mat4 m_modelMatrix;
+		glm::vec4 m_diffuseColor;
+		int32_t m_diffuseLayer; // The layer of the diffuse texture array, signed to match the shader's int attribute
+	};
+
+	// The number of draws the renderer was given and the number of draw calls it issued to OpenGL for them.
+	struct Statistics
+	{
+		uint32_t m_submittedDraws = 0; // Draws given to Render(), RenderInstanced() and Submit(), including culled ones
+		uint32_t m_drawCalls = 0; // A multi-draw call counts as a single draw call
+	};
 private:
+	// Compact copy of everything needed to issue a draw of submitted geometry.
+	struct DrawPacket
+	{
+		glm::mat4 m_modelMatrix;
+		glm::vec4 m_diffuseColor;
+		const ShaderProgram* m_shader;
+		const TextureBuffer* m_diffuseTexture; // Only set if the shader is a textured permutation
+		uint32_t m_diffuseLayer;
+		glm::vec3 m_positionScale, m_positionOffset; // Dequantize the positions of meshes in quantized geometry pools
+		uint32_t m_vertexArrayID, m_count, m_firstIndex, m_baseVertex;
+		uint32_t m_indexType;
+		uint32_t m_shaderFeatures;
+		Geometry::PrimitiveType m_primitiveType;
+		Geometry::RenderFunction m_renderFunc;
+	};
+
+	// The per-frame camera data shared by all shaders, laid out to match the std140 "CameraBlock" uniform block.
+	struct CameraBlock
+	{
+		glm::mat4 m_viewMatrix, m_projectionMatrix, m_viewProjectionMatrix;
+		glm::vec4 m_position;
+		glm::vec2 m_clipPlanes, m_padding;
+	};
+
+	// A VAO with a geometry pool's buffer objects attached, which the instance attributes are pointed at before each draw.
+	struct InstancedVertexArray
+	{
+		VertexArrayPtr m_vertexArray;
+		uint64_t m_poolRevision; // The revision of the geometry pool when its buffer objects were attached
+	};
+
+	// The sort key of a draw packet along with the index of the packet in the draw queue.
+	struct SortEntry
+	{
+		uint64_t m_key;
+		uint32_t m_packetIndex;
+	};
+
+	// The handles of the uniforms assigned by the renderer in a geometry shader.
+	// Handles of uniforms which a permutation doesn't use (e.g. the texture of untextured permutations) are left invalid.
+	struct GeometryUniforms
+	{
+		UniformHandle<glm::mat4> m_modelMatrix;
+		UniformHandle<glm::vec4> m_diffuseColor;
+		UniformHandle<int> m_diffuseTexture;
+		UniformHandle<int> m_diffuseLayer;
+		UniformHandle<glm::vec3> m_positionScale, m_positionOffset;
+	};
+
+	// A permutation of a geometry shader along with the handles of its uniforms.
+	struct GeometryShader
+	{
+		ShaderProgramPtr m_shader;
+		GeometryUniforms m_uniforms;
+	};
+
+	// The permutations of the geometry shaders, indexed by their feature masks
+	std::array<GeometryShader, Geometry::shaderPermutationCount> m_geometryShaders, m_instancedGeometryShaders;
+
+	std::unique_ptr<UniformBuffer> m_cameraBlockBuffer;
+	uint64_t m_cameraBlockRevision = 0; // The revision of the camera the camera block was last computed from
+
+	std::unique_ptr<StreamingBuffer> m_instanceStream;
+	std::vector<InstanceData> m_instanceData;
+	std::unordered_map<uint32_t, InstancedVertexArray> m_instancedVertexArrays; // Keyed by the ID of the geometry pool's VAO
+
+	std::vector<DrawPacket> m_drawQueue;
+	std::vector<SortEntry> m_sortEntries, m_sortScratch;
+	FrustumCuller m_culler; // Holds the world bounds of each packet in the draw queue
+
+	// The parameters of the draws merged into a single multi-draw call
+	std::vector<int32_t> m_multiDrawCounts, m_multiDrawBaseVertices;
+	std::vector<const void*> m_multiDrawIndexOffsets;
+
+	Statistics m_frameStatistics, m_lastFrameStatistics;
+
 	Renderer() = default;
+
+	// Returns the handles of the uniforms assigned by the renderer in the given geometry shader.
+	static GeometryUniforms GetGeometryUniforms(const ShaderProgram& shader);
+
+	// Returns every permutation of the stored shader with the given ID, compiling any which haven't been compiled yet.
+	// Combinations of features which don't change the shader (texture arrays without texturing) share a permutation.
+	// The shader's camera block is bound to the camera block's binding point in each permutation.
+	static std::array<GeometryShader, Geometry::shaderPermutationCount> LoadGeometryShaders(AssetID id);
+
+	// Recomputes and uploads the camera block if the given camera differs from the one it was last computed from.
+	void UpdateCameraBlock(const Camera3D& camera);
+
+	// Returns the 64-bit sort key of the given draw packet.
+	// From the most to least significant bits, the key is made up of the shader (8 bits), the diffuse texture (16 bits),
+	// the VAO (16 bits) and the quantized distance from the camera (24 bits).
+	// The camera distance given should be normalized between the camera's near and far clipping planes.
+	static uint64_t ComputeSortKey(const DrawPacket& packet, float normalizedCameraDistance);
+
+	// Sorts the sort entries by their keys in ascending order using an LSD radix sort.
+	void SortDrawQueue();
+
+	// Returns the VAO used to render the given geometry instanced, which has the buffer objects of the geometry's pool attached.
+	// The VAO is created the first time geometry from the pool is rendered instanced, and set up again if the pool grows.
+	const VertexArray& GetInstancedVertexArray(const Geometry& geometry);
+
+	// Points the instance attributes of the currently bound VAO at the instance data which starts at the given offset in the 
+	// instance stream.
+	void SpecifyInstanceAttributes(size_t offset) const;
+
+	// Returns TRUE if the two draw packets can be drawn together in a single multi-draw call.
+	// This requires them to share the same state and per-object uniforms, and to both be indexed draws.
+	static bool CanMergeDraws(const DrawPacket& first, const DrawPacket& second);
+
+	// Issues the draw call for the given geometry parameters, assuming that the VAO is already bound.
+	// For geometry using RenderFunction::RENDER_ARRAYS, the base vertex is used as the first vertex to draw.
+	// The index type is the type of the indices in the bound index buffer, either GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+	void IssueDrawCall(Geometry::RenderFunction renderFunc, Geometry::PrimitiveType primitiveType, uint32_t count,
+		uint32_t firstIndex, uint32_t baseVertex, uint32_t indexType, uint32_t instanceCount = 1);
 public:
 	enum class ClearFlag : uint32_t
 	{
@@ -21,13 +159,52 @@ public:
 	~Renderer() = default;
 
 	// Initializes the rendering system.
-	void Init() const;
+	void Init();
 
 	// Clears the current active framebuffer.
 	void Clear(ClearFlag mask, const glm::vec4& color);
 
 	// Renders the given geometry onto the scene of the currently active framebuffer.
-	void Render(const Camera3D& camera, const Geometry& geometry) const;
+	// The geometry is drawn immediately, use Submit() and Flush() instead when rendering many objects.
+	// Nothing is drawn if the geometry is outside of the camera's view frustum.
+	void Render(const Camera3D& camera, const Geometry& geometry);
+
+	// Renders a copy of the given geometry for each of the transforms given, in a single instanced draw call.
+	// If diffuse colors are given then there must be one per transform, otherwise the geometry's material diffuse color is used.
+	// The geometry's own transform is ignored, however its material's texture is used for every instance.
+	void RenderInstanced(const Camera3D& camera, const Geometry& geometry, const std::vector<Geometry::Transform>& transforms,
+		const std::vector<glm::vec4>& diffuseColors = {});
+
+	// Renders a copy of the given geometry for each of the instances given, in a single instanced draw call.
+	void RenderInstanced(const Camera3D& camera, const Geometry& geometry, const InstanceData* instances, size_t instanceCount);
+
+	// Queues the given geometry to be rendered on the next call to Flush().
+	// Note that the diffuse texture of the geometry's material must remain alive until the queue has been flushed.
+	void Submit(const Camera3D& camera, const Geometry& geometry);
+
+	// Queues the given draw command to be rendered on the next call to Flush().
+	void Submit(const Camera3D& camera, const DrawCommand& command);
+
+	// Culls all the geometry queued by Submit() which is outside of the camera's view frustum, then sorts the rest so that 
+	// draws sharing the same shader, texture and VAO are grouped together and renders them onto the scene of the currently 
+	// active framebuffer.
+	// Consecutive draws of geometry with identical transforms and materials are merged into a single multi-draw call.
+	void Flush(const Camera3D& camera);
+
+	// Clears the current active framebuffer with the packet's clear color, then submits and flushes all of its draw commands.
+	void RenderPacket(const FramePacket& packet);
+
+	// Marks the end of the frame, this must be called once per frame after all the geometry has been rendered.
+	void EndFrame();
+
+	// Returns the draw statistics of the previous frame.
+	const Statistics& GetLastFrameStatistics() const;
+
+	// Returns the statistics of the frustum culling done in the last call to Flush().
+	const FrustumCuller::Statistics& GetCullingStatistics() const;
+
+	// Returns the statistics of the instance data streamed in the previous frame.
+	const StreamingBuffer::Statistics& GetStreamingStatistics() const;
 
 	// Returns singleton instance of the class.
 	static Renderer& GetInstance();
@@ -35,4 +212,4 @@ public:
 
 extern Renderer::ClearFlag operator|(Renderer::ClearFlag lhs, Renderer::ClearFlag rhs);
 
-#endif
\ No newline at end of file
+#endif
@@ -1,53 +1,199 @@
 #include <graphics/shader_program.h>
+#include <graphics/gl_state_cache.h>
+#include <graphics/program_binary_cache.h>
 #include <util/formatted_exception.h>
+#include <util/asset_id.h>
+#include <util/time.h>
 
 #include <glad/glad.h>
 #include <sstream>
 #include <fstream>
 #include <memory>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
 
 ShaderProgram::ShaderProgram() :
     m_id(0)
 {}
 
-ShaderProgram::ShaderProgram(std::string_view vshFilePath, std::string_view fshFilePath)
+ShaderProgram::ShaderProgram(std::string_view vshFilePath, std::string_view fshFilePath, const std::vector<std::string>& defines) :
+    ShaderProgram(ShaderProgram::FromFiles(std::string(vshFilePath), std::string(fshFilePath), defines, ShaderProgram::ReadFile))
+{}
+
+ShaderProgram ShaderProgram::FromSource(std::string_view vshSource, std::string_view fshSource, 
+    const std::vector<std::string>& defines)
 {
-    // Firstly open the shader files
-    std::ifstream vshFileStream(vshFilePath.data()), fshFileStream(fshFilePath.data());
+    ShaderProgram shaderProgram;
+    shaderProgram.Compile(ShaderProgram::Preprocess(vshSource, "", defines, ShaderProgram::ReadFile), 
+        ShaderProgram::Preprocess(fshSource, "", defines, ShaderProgram::ReadFile));
+
+    return shaderProgram;
+}
 
-    if (vshFileStream.fail())
-        throw FormattedException("Failed to open the vertex shader file at path: %s", vshFilePath.data());
+ShaderProgram ShaderProgram::FromFiles(const std::string& vshFilePath, const std::string& fshFilePath, 
+    const std::vector<std::string>& defines, const FileReader& readFile)
+{
+    const std::string vshSource = ShaderProgram::Preprocess(readFile(vshFilePath), vshFilePath, defines, readFile);
+    const std::string fshSource = ShaderProgram::Preprocess(readFile(fshFilePath), fshFilePath, defines, readFile);
 
-    if (fshFileStream.fail())
-        throw FormattedException("Failed to open the fragment shader file at path: %s", fshFilePath.data());
+    ShaderProgram shaderProgram;
+    shaderProgram.Compile(vshSource, fshSource);
+    return shaderProgram;
+}
 
-    // Stream the contents from the files into their respective string streams
-    std::stringstream vshStream, fshStream;
-    vshStream << vshFileStream.rdbuf();
-    fshStream << fshFileStream.rdbuf();
+std::string ShaderProgram::Preprocess(std::string_view source, const std::string& filePath, const std::vector<std::string>& defines,
+    const FileReader& readFile)
+{
+    // Find the #version directive, which has to come before anything else in the source except for comments
+    size_t bodyStart = 0;
+    uint32_t bodyLineNumber = 1;
 
-    const std::string vshContents = vshStream.str(), fshContents = fshStream.str();
-    
-    vshFileStream.close(); // We can now close the shader files
-    fshFileStream.close();
+    for (size_t lineStart = 0, lineNumber = 1; lineStart < source.size(); lineNumber++)
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        lineEnd = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+
+        const std::string_view line = source.substr(lineStart, lineEnd - lineStart);
+        const size_t directiveStart = line.find_first_not_of(" \t");
+
+        if (directiveStart != std::string_view::npos && line.compare(directiveStart, 8, "#version") == 0)
+        {
+            bodyStart = lineEnd;
+            bodyLineNumber = (uint32_t)lineNumber + 1;
+            break;
+        }
+
+        lineStart = lineEnd;
+    }
+
+    std::string output(source.substr(0, bodyStart));
+    if (!output.empty() && output.back() != '\n')
+        output += '\n';
+
+    for (const std::string& define : defines)
+        output.append("#define ").append(define).append(1, '\n');
+
+    output.append("#line ").append(std::to_string(bodyLineNumber)).append(" 0\n");
+
+    std::vector<std::string> includedFilePaths = { filePath };
+    ShaderProgram::ResolveIncludes(source.substr(bodyStart), filePath, bodyLineNumber, readFile, includedFilePaths, output);
+
+    return output;
+}
+
+void ShaderProgram::ResolveIncludes(std::string_view source, const std::string& filePath, uint32_t firstLineNumber, 
+    const FileReader& readFile, std::vector<std::string>& includedFilePaths, std::string& output)
+{
+    const size_t sourceNumber = std::find(includedFilePaths.begin(), includedFilePaths.end(), filePath) - includedFilePaths.begin();
+
+    uint32_t lineNumber = firstLineNumber;
+    for (size_t lineStart = 0; lineStart < source.size(); lineNumber++)
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        lineEnd = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+
+        const std::string_view line = source.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd;
+
+        std::string includePath;
+        if (!ShaderProgram::ParseIncludeDirective(line, includePath))
+        {
+            output.append(line);
+            continue;
+        }
+
+        // Files which have already been included are skipped, so a directive's line is kept as a blank line
+        const std::string includeFilePath = (std::filesystem::path(filePath).parent_path() / includePath).lexically_normal()
+            .generic_string();
+
+        if (std::find(includedFilePaths.begin(), includedFilePaths.end(), includeFilePath) != includedFilePaths.end())
+        {
+            output += '\n';
+            continue;
+        }
+
+        includedFilePaths.push_back(includeFilePath);
+        output.append("#line 1 ").append(std::to_string(includedFilePaths.size() - 1)).append(1, '\n');
+
+        ShaderProgram::ResolveIncludes(readFile(includeFilePath), includeFilePath, 1, readFile, includedFilePaths, output);
+        if (output.back() != '\n')
+            output += '\n';
+
+        output.append("#line ").append(std::to_string(lineNumber + 1)).append(1, ' ').append(std::to_string(sourceNumber))
+            .append(1, '\n');
+    }
+}
+
+bool ShaderProgram::ParseIncludeDirective(std::string_view line, std::string& includePath)
+{
+    size_t position = line.find_first_not_of(" \t");
+    if (position == std::string_view::npos || line[position] != '#')
+        return false;
+
+    position = line.find_first_not_of(" \t", position + 1);
+    if (position == std::string_view::npos || line.compare(position, 7, "include") != 0)
+        return false;
+
+    const size_t pathStart = line.find('"', position + 7), pathEnd = line.find('"', pathStart + 1);
+    if (pathStart == std::string_view::npos || pathEnd == std::string_view::npos || pathEnd == pathStart + 1)
+    {
+        const size_t lineLength = line.find_last_not_of("\r\n") + 1;
+        throw FormattedException("Malformed #include directive: %s", std::string(line.substr(0, lineLength)).c_str());
+    }
+
+    includePath = std::string(line.substr(pathStart + 1, pathEnd - pathStart - 1));
+    return true;
+}
+
+std::string ShaderProgram::ReadFile(const std::string& filePath)
+{
+    std::ifstream fileStream(filePath);
+    if (fileStream.fail())
+        throw FormattedException("Failed to open the shader file at path: %s", filePath.c_str());
 
-    // Compile the streamed shader file contents
-    const char* vshContentsPtr = vshContents.c_str(), *fshContentsPtr = fshContents.c_str();
+    // Stream the contents from the file into a string stream
+    std::stringstream contentStream;
+    contentStream << fileStream.rdbuf();
+
+    return contentStream.str();
+}
+
+void ShaderProgram::Compile(std::string_view vshSource, std::string_view fshSource)
+{
+    // Load the program from the binary cache if it's been compiled before with the same sources and driver
+    ProgramBinaryCache& binaryCache = ProgramBinaryCache::GetInstance();
+    const uint64_t binaryKey = binaryCache.GetKey(vshSource, fshSource);
+
+    m_id = binaryCache.Load(binaryKey);
+    if (m_id != 0)
+    {
+        this->ReflectUniforms();
+        return;
+    }
+
+    const double compileStartSeconds = Time::GetSecondsSinceEpoch();
+
+    // The sources are passed with their lengths, so they don't need to be null terminated
+    const char* vshSourcePtr = vshSource.data(), *fshSourcePtr = fshSource.data();
+    const int vshSourceLength = (int)vshSource.size(), fshSourceLength = (int)fshSource.size();
 
     const uint32_t vshID = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vshID, 1, &vshContentsPtr, nullptr);
+    glShaderSource(vshID, 1, &vshSourcePtr, &vshSourceLength);
     glCompileShader(vshID);
 
     this->CheckShaderOperation(vshID, Operation::COMPILATION);
 
     const uint32_t fshID = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fshID, 1, &fshContentsPtr, nullptr);
+    glShaderSource(fshID, 1, &fshSourcePtr, &fshSourceLength);
     glCompileShader(fshID);
 
     this->CheckShaderOperation(fshID, Operation::COMPILATION);
 
     // Attach the compiled shaders to the shader program and link them
     m_id = glCreateProgram();
+    binaryCache.PrepareProgram(m_id);
+
     glAttachShader(m_id, vshID);
     glAttachShader(m_id, fshID);
     glLinkProgram(m_id);
@@ -56,10 +202,15 @@ ShaderProgram::ShaderProgram(std::string_view vshFilePath, std::string_view fshF
 
     glDeleteShader(vshID); // We can delete the shader objects now
     glDeleteShader(fshID);
+
+    binaryCache.Store(binaryKey, m_id, Time::GetSecondsSinceEpoch() - compileStartSeconds);
+
+    this->ReflectUniforms();
 }
 
 ShaderProgram::ShaderProgram(ShaderProgram&& temp) noexcept :
-    m_id(temp.m_id)
+    m_id(temp.m_id), m_uniforms(std::move(temp.m_uniforms)), m_uniformIndices(std::move(temp.m_uniformIndices)), 
+    m_uniformBlocks(std::move(temp.m_uniformBlocks)), m_shadowValues(std::move(temp.m_shadowValues))
 {
     temp.m_id = 0;
 }
@@ -67,12 +218,19 @@ ShaderProgram::ShaderProgram(ShaderProgram&& temp) noexcept :
 ShaderProgram::~ShaderProgram()
 {
     if (m_id != 0)
+    {
         glDeleteProgram(m_id);
+        GLStateCache::GetInstance().OnProgramDeleted(m_id);
+    }
 }
 
 ShaderProgram& ShaderProgram::operator=(ShaderProgram&& temp) noexcept
 {
     m_id = temp.m_id;
+    m_uniforms = std::move(temp.m_uniforms);
+    m_uniformIndices = std::move(temp.m_uniformIndices);
+    m_uniformBlocks = std::move(temp.m_uniformBlocks);
+    m_shadowValues = std::move(temp.m_shadowValues);
     temp.m_id = 0;
 
     return *this;
@@ -107,68 +265,255 @@ void ShaderProgram::CheckShaderOperation(uint32_t id, Operation operation) const
         throw FormattedException(logBuffer.get());
 }
 
-uint32_t ShaderProgram::GetUniformLocation(std::string_view uniformName) const
+void ShaderProgram::ReflectUniforms()
+{
+    m_uniforms.clear();
+    m_uniformIndices.Clear();
+    m_uniformBlocks.Clear();
+    m_shadowValues.clear();
+
+    int maxNameLength = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    
+    int maxBlockNameLength = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+    std::vector<char> nameBuffer(std::max(std::max(maxNameLength, maxBlockNameLength), 1));
+
+    // Enumerate the uniforms in the default uniform block
+    int uniformCount = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+    for (uint32_t uniformIndex = 0; uniformIndex < (uint32_t)uniformCount; uniformIndex++)
+    {
+        int blockIndex = -1;
+        glGetActiveUniformsiv(m_id, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+        if (blockIndex != -1)
+            continue;
+
+        int nameLength = 0, arraySize = 0;
+        uint32_t type = 0;
+        glGetActiveUniform(m_id, uniformIndex, (int)nameBuffer.size(), &nameLength, &arraySize, &type, nameBuffer.data());
+
+        // Arrays are reported with the name of their first element, so strip the subscript to find them by their plain name
+        std::string_view name(nameBuffer.data(), nameLength);
+        if (name.size() > 3 && name.substr(name.size() - 3) == "[0]")
+            name.remove_suffix(3);
+
+        Uniform uniform;
+        uniform.m_location = glGetUniformLocation(m_id, nameBuffer.data());
+        uniform.m_type = type;
+        uniform.m_shadowOffset = (uint32_t)m_shadowValues.size();
+        uniform.m_shadowSize = ShaderProgram::GetUniformValueSize(type);
+        uniform.m_shadowValid = false;
+
+        m_shadowValues.resize(m_shadowValues.size() + uniform.m_shadowSize);
+        m_uniformIndices.Insert(AssetID::Hash(name), (uint32_t)m_uniforms.size());
+        m_uniforms.push_back(uniform);
+    }
+
+    // Enumerate the uniform blocks
+    int blockCount = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+
+    for (uint32_t blockIndex = 0; blockIndex < (uint32_t)blockCount; blockIndex++)
+    {
+        int nameLength = 0, dataSize = 0;
+        glGetActiveUniformBlockName(m_id, blockIndex, (int)nameBuffer.size(), &nameLength, nameBuffer.data());
+        glGetActiveUniformBlockiv(m_id, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+
+        m_uniformBlocks.Insert(AssetID::Hash(std::string_view(nameBuffer.data(), nameLength)), 
+            { blockIndex, (uint32_t)dataSize });
+    }
+}
+
+uint32_t ShaderProgram::FindUniform(std::string_view uniformName, uint32_t valueType) const
+{
+    const uint32_t* uniformIndex = m_uniformIndices.Find(AssetID::Hash(uniformName));
+    if (!uniformIndex)
+        return 0xFFFFFFFF;
+
+#ifdef _DEBUG
+    if (!ShaderProgram::IsCompatibleType(m_uniforms[*uniformIndex].m_type, valueType))
+    {
+        throw FormattedException("The uniform \"%s\" of shader program %u can't be assigned a value of type 0x%X.", 
+            std::string(uniformName).c_str(), m_id, valueType);
+    }
+#else
+    (void)valueType;
+#endif
+
+    return *uniformIndex;
+}
+
+bool ShaderProgram::UpdateShadowCopy(const Uniform& uniform, const void* value, size_t size) const
+{
+    if (size > uniform.m_shadowSize) // Values which don't fit in the shadow copy are always uploaded
+        return true;
+
+    // Compare the whole shadow copy against the zero padded value, so values smaller than the uniform (e.g. bools) compare 
+    // as the value that OpenGL actually stores
+    uint8_t paddedValue[sizeof(glm::mat4)] = {};
+    std::memcpy(paddedValue, value, size);
+
+    uint8_t* shadowValue = m_shadowValues.data() + uniform.m_shadowOffset;
+    if (uniform.m_shadowValid && std::memcmp(shadowValue, paddedValue, uniform.m_shadowSize) == 0)
+        return false;
+
+    std::memcpy(shadowValue, paddedValue, uniform.m_shadowSize);
+    uniform.m_shadowValid = true;
+
+    return true;
+}
+
+uint32_t ShaderProgram::GetUniformValueSize(uint32_t uniformType)
+{
+    switch (uniformType)
+    {
+    case GL_INT:
+    case GL_FLOAT:
+    case GL_BOOL:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+        return 4;
+    case GL_FLOAT_VEC2:
+        return sizeof(glm::vec2);
+    case GL_FLOAT_VEC3:
+        return sizeof(glm::vec3);
+    case GL_FLOAT_VEC4:
+        return sizeof(glm::vec4);
+    case GL_FLOAT_MAT3:
+        return sizeof(glm::mat3);
+    case GL_FLOAT_MAT4:
+        return sizeof(glm::mat4);
+    default:
+        return 0;
+    }
+}
+
+bool ShaderProgram::IsCompatibleType(uint32_t uniformType, uint32_t valueType)
+{
+    if (uniformType == valueType)
+        return true;
+
+    switch (uniformType)
+    {
+    case GL_BOOL: // Bools can be assigned integers, and integers (including sampler units) can be assigned bools
+        return valueType == GL_INT;
+    case GL_INT:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+        return valueType == GL_INT || valueType == GL_BOOL;
+    default:
+        return false;
+    }
+}
+
+void ShaderProgram::UploadUniform(int32_t location, int value)
+{
+    glUniform1i(location, value);
+}
+
+void ShaderProgram::UploadUniform(int32_t location, float value)
+{
+    glUniform1f(location, value);
+}
+
+void ShaderProgram::UploadUniform(int32_t location, bool value)
+{
+    glUniform1i(location, (int)value);
+}
+
+void ShaderProgram::UploadUniform(int32_t location, const glm::vec2& vector)
 {
-    // Look for the uniform in the cache map
-    auto cacheMapIterator = m_uniformLocationCache.find(uniformName.data());
-    if (cacheMapIterator != m_uniformLocationCache.end())
-        return cacheMapIterator->second;
+    glUniform2fv(location, 1, &vector[0]);
+}
+
+void ShaderProgram::UploadUniform(int32_t location, const glm::vec3& vector)
+{
+    glUniform3fv(location, 1, &vector[0]);
+}
 
-    // It's not in the cache map so add it into there
-    const uint32_t uniformLocation = glGetUniformLocation(m_id, uniformName.data());
-    m_uniformLocationCache[uniformName.data()] = uniformLocation;
+void ShaderProgram::UploadUniform(int32_t location, const glm::vec4& vector)
+{
+    glUniform4fv(location, 1, &vector[0]);
+}
+
+void ShaderProgram::UploadUniform(int32_t location, const glm::mat3& matrix)
+{
+    glUniformMatrix3fv(location, 1, false, &matrix[0][0]);
+}
 
-    return uniformLocation;
+void ShaderProgram::UploadUniform(int32_t location, const glm::mat4& matrix)
+{
+    glUniformMatrix4fv(location, 1, false, &matrix[0][0]);
 }
 
 void ShaderProgram::SetUniform(std::string_view uniformName, int value) const
 {
-    glUniform1i(this->GetUniformLocation(uniformName), value);
+    this->SetUniform(this->GetUniformHandle<int>(uniformName), value);
 }
 
 void ShaderProgram::SetUniform(std::string_view uniformName, float value) const
 {
-    glUniform1f(this->GetUniformLocation(uniformName), value);
+    this->SetUniform(this->GetUniformHandle<float>(uniformName), value);
 }
 
 void ShaderProgram::SetUniform(std::string_view uniformName, bool value) const
 {
-    glUniform1i(this->GetUniformLocation(uniformName), (int)value);
+    this->SetUniform(this->GetUniformHandle<bool>(uniformName), value);
 }
 
 void ShaderProgram::SetUniformEx(std::string_view uniformName, const glm::vec2& vector) const
 {
-    glUniform2fv(this->GetUniformLocation(uniformName), 1, &vector[0]);
+    this->SetUniform(this->GetUniformHandle<glm::vec2>(uniformName), vector);
 }
 
 void ShaderProgram::SetUniformEx(std::string_view uniformName, const glm::vec3& vector) const
 {
-    glUniform3fv(this->GetUniformLocation(uniformName), 1, &vector[0]);
+    this->SetUniform(this->GetUniformHandle<glm::vec3>(uniformName), vector);
 }
 
 void ShaderProgram::SetUniformEx(std::string_view uniformName, const glm::vec4& vector) const
 {
-    glUniform4fv(this->GetUniformLocation(uniformName), 1, &vector[0]);
+    this->SetUniform(this->GetUniformHandle<glm::vec4>(uniformName), vector);
 }
 
 void ShaderProgram::SetUniformEx(std::string_view uniformName, const glm::mat3& matrix) const
 {
-    glUniformMatrix3fv(this->GetUniformLocation(uniformName), 1, false, &matrix[0][0]);
+    this->SetUniform(this->GetUniformHandle<glm::mat3>(uniformName), matrix);
 }
 
 void ShaderProgram::SetUniformEx(std::string_view uniformName, const glm::mat4& matrix) const
 {
-    glUniformMatrix4fv(this->GetUniformLocation(uniformName), 1, false, &matrix[0][0]);
+    this->SetUniform(this->GetUniformHandle<glm::mat4>(uniformName), matrix);
+}
+
+void ShaderProgram::SetUniformBlockBinding(std::string_view blockName, uint32_t bindingPoint) const
+{
+    const UniformBlock* uniformBlock = m_uniformBlocks.Find(AssetID::Hash(blockName));
+    if (uniformBlock)
+        glUniformBlockBinding(m_id, uniformBlock->m_index, bindingPoint);
+}
+
+uint32_t ShaderProgram::GetUniformBlockSize(std::string_view blockName) const
+{
+    const UniformBlock* uniformBlock = m_uniformBlocks.Find(AssetID::Hash(blockName));
+    return uniformBlock ? uniformBlock->m_dataSize : 0;
 }
 
 void ShaderProgram::Bind() const
 {
-    glUseProgram(m_id);
+    GLStateCache::GetInstance().UseProgram(m_id);
 }
 
 void ShaderProgram::Unbind() const
 {
-    glUseProgram(0);
+    GLStateCache::GetInstance().UseProgram(0);
 }
 
 uint32_t ShaderProgram::GetID() const
@@ -1,27 +1,116 @@
 #ifndef SHADER_PROGRAM_H
 #define SHADER_PROGRAM_H
 
+#include <util/flat_hash_map.h>
+
+#include <string>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <cstdint>
 #include <glm/glm.hpp>
 
+// Refers to an active uniform of a shader program which has a value of type T.
+// Handles are resolved once using ShaderProgram::GetUniformHandle(), after which setting the uniform requires no name lookup.
+// Note that a handle can only be used with the shader program it was resolved from.
+template<typename T>
+class UniformHandle
+{
+private:
+	friend class ShaderProgram;
+
+	uint32_t m_index, m_programID;
+public:
+	UniformHandle() :
+		m_index(0xFFFFFFFF), m_programID(0)
+	{}
+
+	// Returns TRUE if the handle refers to an active uniform.
+	bool IsValid() const
+	{
+		return m_index != 0xFFFFFFFF;
+	}
+};
+
 class ShaderProgram
 {
+public:
+	// Returns the contents of the file at the given path, used to read shader sources and the files they include.
+	// Throws a formatted exception if the file can't be read.
+	using FileReader = std::function<std::string(const std::string& filePath)>;
 private:
 	enum class Operation { COMPILATION, LINKAGE };
 
+	// An active uniform in the default uniform block of the program, along with where its shadow copy is kept.
+	struct Uniform
+	{
+		int32_t m_location;
+		uint32_t m_type;
+		uint32_t m_shadowOffset, m_shadowSize;
+		mutable bool m_shadowValid;
+	};
+
+	// An active uniform block of the program.
+	struct UniformBlock
+	{
+		uint32_t m_index, m_dataSize;
+	};
+
 	uint32_t m_id;
-	mutable std::unordered_map<std::string, uint32_t> m_uniformLocationCache;
+
+	std::vector<Uniform> m_uniforms;
+	FlatHashMap<uint32_t> m_uniformIndices; // Indices into the uniform table, keyed by the hash of the uniform names
+	FlatHashMap<UniformBlock> m_uniformBlocks; // Keyed by the hash of the block names
+	mutable std::vector<uint8_t> m_shadowValues; // The last value uploaded to each uniform
+
+	// Appends the source to the output, with each #include directive replaced by the contents of the file it names.
+	// Files are included at most once, the paths of those already included are kept in the given list, which is also used 
+	// to number the sources in #line directives.
+	// The first line of the source is numbered as the line given.
+	static void ResolveIncludes(std::string_view source, const std::string& filePath, uint32_t firstLineNumber, 
+		const FileReader& readFile, std::vector<std::string>& includedFilePaths, std::string& output);
+
+	// Returns TRUE if the line is an #include directive, in which case the path it names is returned through the string given.
+	// Throws a formatted exception if the directive doesn't name a path in quotes.
+	static bool ParseIncludeDirective(std::string_view line, std::string& includePath);
+
+	// Compiles the vertex and fragment shader sources and links them into the program.
+	void Compile(std::string_view vshSource, std::string_view fshSource);
 
 	// Checks if the compilation or linkage operation on the shader was successful.
 	// Throws a formatted exception if any errors were thrown by OpenGL.
 	void CheckShaderOperation(uint32_t id, Operation operation) const;
 
-	// Returns the location unit of the specified uniform.
-	uint32_t GetUniformLocation(std::string_view uniformName) const;
+	// Enumerates the active uniforms and uniform blocks of the linked program into the uniform tables.
+	// Uniforms inside of uniform blocks are skipped, as their values are set through uniform buffers instead.
+	void ReflectUniforms();
+
+	// Returns the index in the uniform table of the specified uniform, or 0xFFFFFFFF if it's not an active uniform.
+	// In debug mode, a formatted exception is thrown if the uniform can't be assigned values of the given type.
+	uint32_t FindUniform(std::string_view uniformName, uint32_t valueType) const;
+
+	// Compares the given value with the shadow copy of the uniform, and updates the shadow copy if they differ.
+	// Returns TRUE if the value differs and so needs to be uploaded.
+	bool UpdateShadowCopy(const Uniform& uniform, const void* value, size_t size) const;
+
+	// Returns the size in bytes of a value of the given uniform type, or 0 if values of the type aren't shadowed.
+	static uint32_t GetUniformValueSize(uint32_t uniformType);
+
+	// Returns TRUE if uniforms of the given type can be assigned values of the given type.
+	static bool IsCompatibleType(uint32_t uniformType, uint32_t valueType);
+
+	// Uploads the given value to the uniform at the location specified, assuming that the program is bound.
+	static void UploadUniform(int32_t location, int value);
+	static void UploadUniform(int32_t location, float value);
+	static void UploadUniform(int32_t location, bool value);
+	static void UploadUniform(int32_t location, const glm::vec2& vector);
+	static void UploadUniform(int32_t location, const glm::vec3& vector);
+	static void UploadUniform(int32_t location, const glm::vec4& vector);
+	static void UploadUniform(int32_t location, const glm::mat3& matrix);
+	static void UploadUniform(int32_t location, const glm::mat4& matrix);
 public:
 	ShaderProgram();
-	ShaderProgram(std::string_view vshFilePath, std::string_view fshFilePath);
+	ShaderProgram(std::string_view vshFilePath, std::string_view fshFilePath, const std::vector<std::string>& defines = {});
 	ShaderProgram(const ShaderProgram& other) = delete;
 	ShaderProgram(ShaderProgram&& temp) noexcept;
 	
@@ -30,8 +119,29 @@ public:
 	ShaderProgram& operator=(const ShaderProgram& other) = delete;
 	ShaderProgram& operator=(ShaderProgram&& temp) noexcept;
 
+	// Returns a shader program compiled from the given vertex and fragment shader sources, which don't need to be null terminated.
+	// The defines are injected into both sources, and any files they include are read relative to the working directory.
+	static ShaderProgram FromSource(std::string_view vshSource, std::string_view fshSource, 
+		const std::vector<std::string>& defines = {});
+
+	// Returns a shader program compiled from the vertex and fragment shader files, with the given defines injected into both.
+	// The shader files, and the files they include, are read by the given function.
+	static ShaderProgram FromFiles(const std::string& vshFilePath, const std::string& fshFilePath, 
+		const std::vector<std::string>& defines, const FileReader& readFile);
+
+	// Returns the shader source with a #define directive for each of the given names inserted after its #version directive,
+	// and each #include "path" directive replaced by the contents of the file, whose path is relative to the including file.
+	// #line directives are inserted so compile errors refer to the original line numbers, with source string 0 being the
+	// shader file and the included files numbered in the order they're included.
+	static std::string Preprocess(std::string_view source, const std::string& filePath, const std::vector<std::string>& defines,
+		const FileReader& readFile);
+
+	// Returns the contents of the file at the given path, this is the file reader used unless another is given.
+	static std::string ReadFile(const std::string& filePath);
+
 	// Assigns the given value to the specifed shader uniform.
 	// This function (and overloads) are for simple types like integers, use SetUniformEx() for larger types like matrices.
+	// Prefer resolving a uniform handle once over these, as they have to look up the uniform by its name on every call.
 	void SetUniform(std::string_view uniformName, int value) const;
 	void SetUniform(std::string_view uniformName, float value) const;
 	void SetUniform(std::string_view uniformName, bool value) const;
@@ -44,6 +154,23 @@ public:
 	void SetUniformEx(std::string_view uniformName, const glm::mat3& matrix) const;
 	void SetUniformEx(std::string_view uniformName, const glm::mat4& matrix) const;
 
+	// Returns a handle to the specified uniform, which can then be used to set its value without any name lookup.
+	// If the uniform isn't active in the program then an invalid handle is returned, which SetUniform() ignores.
+	template<typename T>
+	UniformHandle<T> GetUniformHandle(std::string_view uniformName) const;
+
+	// Assigns the given value to the uniform referred to by the handle.
+	// The value is only uploaded if it differs from the last value assigned to the uniform.
+	template<typename T>
+	void SetUniform(UniformHandle<T> handle, const T& value) const;
+
+	// Assigns the specified uniform block in the shader to the given uniform buffer binding point.
+	// Nothing is done if the shader doesn't contain an active uniform block with the name given.
+	void SetUniformBlockBinding(std::string_view blockName, uint32_t bindingPoint) const;
+
+	// Returns the size in bytes of the specified uniform block, or 0 if the shader doesn't contain an active block with the name given.
+	uint32_t GetUniformBlockSize(std::string_view blockName) const;
+
 	// Binds the shader program.
 	void Bind() const;
 
@@ -54,4 +181,6 @@ public:
 	uint32_t GetID() const;
 };
 
+#include <graphics/shader_program.tpp>
+
 #endif
@@ -0,0 +1,41 @@
+#include <util/formatted_exception.h>
+
+namespace UniformTypes
+{
+    // The OpenGL type enum of each type of value which can be assigned to uniforms.
+    template<typename T> struct GLType;
+    template<> struct GLType<int> { static constexpr uint32_t value = 0x1404; }; // GL_INT
+    template<> struct GLType<float> { static constexpr uint32_t value = 0x1406; }; // GL_FLOAT
+    template<> struct GLType<bool> { static constexpr uint32_t value = 0x8B56; }; // GL_BOOL
+    template<> struct GLType<glm::vec2> { static constexpr uint32_t value = 0x8B50; }; // GL_FLOAT_VEC2
+    template<> struct GLType<glm::vec3> { static constexpr uint32_t value = 0x8B51; }; // GL_FLOAT_VEC3
+    template<> struct GLType<glm::vec4> { static constexpr uint32_t value = 0x8B52; }; // GL_FLOAT_VEC4
+    template<> struct GLType<glm::mat3> { static constexpr uint32_t value = 0x8B5B; }; // GL_FLOAT_MAT3
+    template<> struct GLType<glm::mat4> { static constexpr uint32_t value = 0x8B5C; }; // GL_FLOAT_MAT4
+}
+
+template<typename T>
+UniformHandle<T> ShaderProgram::GetUniformHandle(std::string_view uniformName) const
+{
+    UniformHandle<T> handle;
+    handle.m_index = this->FindUniform(uniformName, UniformTypes::GLType<T>::value);
+    handle.m_programID = m_id;
+
+    return handle;
+}
+
+template<typename T>
+void ShaderProgram::SetUniform(UniformHandle<T> handle, const T& value) const
+{
+    if (!handle.IsValid())
+        return;
+
+#ifdef _DEBUG
+    if (handle.m_programID != m_id)
+        throw FormattedException("A uniform handle of shader program %u was used with shader program %u.", handle.m_programID, m_id);
+#endif
+
+    const Uniform& uniform = m_uniforms[handle.m_index];
+    if (this->UpdateShadowCopy(uniform, &value, sizeof(T)))
+        ShaderProgram::UploadUniform(uniform.m_location, value);
+}
@@ -0,0 +1,159 @@
+#include <graphics/streaming_buffer.h>
+#include <graphics/gl_state_cache.h>
+#include <util/formatted_exception.h>
+
+#include <glad/glad.h>
+#include <chrono>
+
+namespace StreamingParams
+{
+    // The longest time to block for in a single wait on a fence, the wait is repeated until the fence is signalled.
+    constexpr uint64_t fenceWaitTimeoutNanoseconds = 1000000;
+}
+
+StreamingBuffer::StreamingBuffer(uint32_t target, size_t regionSize, size_t alignment) :
+    m_id(0), m_target(target), m_regionSize(0), m_alignment(alignment), m_currentRegion(0), m_regionOffset(0), m_mapped(false)
+{
+    m_regionFences.fill(nullptr);
+
+    glGenBuffers(1, &m_id);
+    this->Grow(regionSize);
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    for (void*& fence : m_regionFences)
+    {
+        if (fence)
+            glDeleteSync((GLsync)fence);
+    }
+
+    glDeleteBuffers(1, &m_id);
+    GLStateCache::GetInstance().OnBufferDeleted(m_id);
+}
+
+void StreamingBuffer::WaitForRegion(uint32_t region)
+{
+    if (!m_regionFences[region])
+        return;
+
+    const GLsync fence = (GLsync)m_regionFences[region];
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // Check if the fence has already been signalled before flushing the command queue and blocking
+    uint32_t waitResult = glClientWaitSync(fence, 0, 0);
+    while (waitResult == GL_TIMEOUT_EXPIRED)
+        waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, StreamingParams::fenceWaitTimeoutNanoseconds);
+
+    m_frameStatistics.m_fenceWaitMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - 
+        startTime).count();
+
+    glDeleteSync(fence);
+    m_regionFences[region] = nullptr;
+
+    if (waitResult == GL_WAIT_FAILED)
+        throw FormattedException("Failed to wait on the fence of region %u of streaming buffer %u.", region, m_id);
+}
+
+void StreamingBuffer::AdvanceRegion()
+{
+    this->Unmap();
+
+    if (m_regionOffset > 0) // Only regions which were written to need to be guarded
+        m_regionFences[m_currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_currentRegion = (m_currentRegion + 1) % numRegions;
+    m_regionOffset = 0;
+
+    this->WaitForRegion(m_currentRegion);
+}
+
+void StreamingBuffer::Grow(size_t minRegionSize)
+{
+    this->Unmap();
+
+    // Every region must be finished with before the data store can be replaced
+    for (uint32_t region = 0; region < numRegions; region++)
+        this->WaitForRegion(region);
+
+    size_t regionSize = m_regionSize > 0 ? m_regionSize : m_alignment;
+    while (regionSize < minRegionSize)
+        regionSize *= 2;
+
+    GLStateCache::GetInstance().BindBuffer(m_target, m_id);
+    glBufferData(m_target, regionSize * numRegions, nullptr, GL_STREAM_DRAW);
+
+    m_regionSize = regionSize;
+    m_currentRegion = 0;
+    m_regionOffset = 0;
+}
+
+StreamingBuffer::Allocation StreamingBuffer::Allocate(size_t size)
+{
+    this->Unmap();
+
+    if (size > m_regionSize)
+        this->Grow(size);
+
+    // Move on to the next region if there isn't enough space left in this one
+    const size_t alignedOffset = (m_regionOffset + m_alignment - 1) & ~(m_alignment - 1);
+    if (alignedOffset + size > m_regionSize)
+        this->AdvanceRegion();
+    else
+        m_regionOffset = alignedOffset;
+
+    Allocation allocation;
+    allocation.m_offset = (m_currentRegion * m_regionSize) + m_regionOffset;
+
+    // The region is guarded by its fence, so the mapping doesn't need to be synchronized with the GPU
+    GLStateCache::GetInstance().BindBuffer(m_target, m_id);
+    allocation.m_data = glMapBufferRange(m_target, allocation.m_offset, size, 
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+
+    if (!allocation.m_data)
+        throw FormattedException("Failed to map %zu bytes of streaming buffer %u.", size, m_id);
+
+    m_mapped = true;
+    m_regionOffset += size;
+    m_frameStatistics.m_streamedBytes += size;
+
+    return allocation;
+}
+
+void StreamingBuffer::Unmap()
+{
+    if (!m_mapped)
+        return;
+
+    GLStateCache::GetInstance().BindBuffer(m_target, m_id);
+    glUnmapBuffer(m_target);
+    m_mapped = false;
+}
+
+void StreamingBuffer::EndFrame()
+{
+    this->AdvanceRegion();
+
+    m_lastFrameStatistics = m_frameStatistics;
+    m_frameStatistics = Statistics();
+}
+
+void StreamingBuffer::Bind() const
+{
+    GLStateCache::GetInstance().BindBuffer(m_target, m_id);
+}
+
+const StreamingBuffer::Statistics& StreamingBuffer::GetFrameStatistics() const
+{
+    return m_frameStatistics;
+}
+
+const StreamingBuffer::Statistics& StreamingBuffer::GetLastFrameStatistics() const
+{
+    return m_lastFrameStatistics;
+}
+
+uint32_t StreamingBuffer::GetID() const
+{
+    return m_id;
+}
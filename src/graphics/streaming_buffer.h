@@ -0,0 +1,85 @@
+#ifndef STREAMING_BUFFER_H
+#define STREAMING_BUFFER_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// A buffer object for data which is written by the CPU every frame, such as instance data.
+// The buffer is split into a ring of regions, with each frame's data written into a different region through an unsynchronized 
+// mapping, so writes never wait for the GPU to finish reading the data of previous frames. Each region is guarded by a fence 
+// which is only waited on when the ring wraps back around to a region that the GPU may still be reading.
+class StreamingBuffer
+{
+public:
+	// A range of the buffer which was allocated for the caller to write into.
+	// The pointer is only valid until Unmap() is called, which must be done before the range is read by any draw calls.
+	struct Allocation
+	{
+		size_t m_offset = 0; // Offset in bytes from the start of the buffer
+		void* m_data = nullptr;
+	};
+
+	struct Statistics
+	{
+		size_t m_streamedBytes = 0; // The number of bytes allocated from the buffer
+		double m_fenceWaitMilliseconds = 0.0; // The time spent waiting for the GPU to finish reading regions of the buffer
+	};
+private:
+	static constexpr uint32_t numRegions = 3;
+
+	uint32_t m_id, m_target;
+	size_t m_regionSize, m_alignment;
+	uint32_t m_currentRegion;
+	size_t m_regionOffset; // The offset of the next allocation from the start of the current region
+	bool m_mapped;
+
+	std::array<void*, numRegions> m_regionFences; // The GLsync objects guarding each region, nullptr if not in use by the GPU
+
+	Statistics m_frameStatistics, m_lastFrameStatistics;
+
+	// Waits until the GPU has finished reading from the specified region, then deletes its fence.
+	void WaitForRegion(uint32_t region);
+
+	// Guards the current region with a fence and moves on to the next region in the ring, waiting for it if necessary.
+	void AdvanceRegion();
+
+	// Replaces the buffer's data store with one which has regions of at least the size given.
+	// The ID of the buffer is kept, so vertex arrays which the buffer is attached to remain valid.
+	void Grow(size_t minRegionSize);
+public:
+	// Creates a streaming buffer which is bound to the given target (e.g. GL_ARRAY_BUFFER), where each frame can stream up to
+	// the region size given before having to wait on the GPU.
+	// Every allocation is aligned to the given number of bytes, which must be a power of two.
+	StreamingBuffer(uint32_t target, size_t regionSize, size_t alignment = 16);
+	StreamingBuffer(const StreamingBuffer& other) = delete;
+
+	~StreamingBuffer();
+
+	StreamingBuffer& operator=(const StreamingBuffer& other) = delete;
+
+	// Allocates a range of the buffer of the specified size and maps it for writing.
+	// Any range which was previously mapped is unmapped first.
+	Allocation Allocate(size_t size);
+
+	// Unmaps the range returned by the last call to Allocate(), making its contents available to draw calls.
+	void Unmap();
+
+	// Marks the end of the frame, so that the next frame streams its data into the next region of the buffer.
+	// This should be called after all the draw calls which read this frame's data have been issued.
+	void EndFrame();
+
+	// Binds the streaming buffer to its target.
+	void Bind() const;
+
+	// Returns the statistics of the current frame.
+	const Statistics& GetFrameStatistics() const;
+
+	// Returns the statistics of the previous frame.
+	const Statistics& GetLastFrameStatistics() const;
+
+	// Returns the ID of the streaming buffer.
+	uint32_t GetID() const;
+};
+
+#endif
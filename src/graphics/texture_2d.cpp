@@ -1,19 +1,35 @@
 #include <graphics/texture_2d.h>
+#include <graphics/gl_state_cache.h>
 #include <glad/glad.h>
 
+#include <utility>
+
 Texture2D::Texture2D(const void* pixels, const glm::ivec2& size, uint32_t pixelDataType, uint32_t internalFormat, uint32_t format) :
 	TextureBuffer(GL_TEXTURE_2D, size)
 {
 	// Generate the texture buffer and fill it with the pixel data given
 	glGenTextures(1, &m_id);
-	glBindTexture(m_target, m_id);
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
 	glTexImage2D(m_target, 0, internalFormat, size.x, size.y, 0, format, pixelDataType, pixels);
+	this->SetLevelAllocatedSize(0, (size_t)size.x * size.y * TextureBuffer::GetPixelSize(internalFormat));
 
 	// Set the default texture filter and wrap modes
 	this->SetFilter(GL_LINEAR, GL_LINEAR);
 	this->SetWrap(GL_REPEAT, GL_REPEAT);
+}
+
+Texture2D::Texture2D(const glm::ivec2& size, uint32_t levelCount) :
+	TextureBuffer(GL_TEXTURE_2D, size)
+{
+	glGenTextures(1, &m_id);
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
 
-	glBindTexture(m_target, 0); // Unbind the texture buffer
+	// Only sample from the levels which will be given, since the texture is incomplete if any are missing
+	glTexParameteri(m_target, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, (int)levelCount - 1);
+
+	this->SetFilter(levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR, GL_LINEAR);
+	this->SetWrap(GL_REPEAT, GL_REPEAT);
 }
 
 Texture2D::Texture2D(Texture2D&& temp) noexcept
@@ -22,22 +38,77 @@ Texture2D::Texture2D(Texture2D&& temp) noexcept
 	m_target = temp.m_target;
 	m_size = temp.m_size;
 
+	m_allocatedSize.store(temp.m_allocatedSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	m_levelAllocatedSizes = std::move(temp.m_levelAllocatedSizes);
+
 	temp.m_id = 0;
+	temp.m_allocatedSize.store(0, std::memory_order_relaxed);
+	temp.m_levelAllocatedSizes.clear();
 }
 
 Texture2D& Texture2D::operator=(Texture2D&& temp) noexcept
 {
+	if (this == &temp)
+		return *this;
+
+	this->Release(); // The texture being replaced would otherwise be leaked, along with its tracked allocation
+
 	m_id = temp.m_id;
 	m_target = temp.m_target;
 	m_size = temp.m_size;
 
+	m_allocatedSize.store(temp.m_allocatedSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	m_levelAllocatedSizes = std::move(temp.m_levelAllocatedSizes);
+
 	temp.m_id = 0;
+	temp.m_allocatedSize.store(0, std::memory_order_relaxed);
+	temp.m_levelAllocatedSizes.clear();
 	return *this;
 }
 
-void Texture2D::ModifyData(const void* pixels, const glm::ivec2& offset, const glm::ivec2& size, uint32_t pixelDataType, uint32_t format)
+void Texture2D::ModifyData(const void* pixels, const glm::ivec2& offset, const glm::ivec2& size, uint32_t pixelDataType, uint32_t format,
+	uint32_t level)
+{
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glTexSubImage2D(m_target, level, offset.x, offset.y, size.x, size.y, format, pixelDataType, pixels);
+}
+
+void Texture2D::ModifyCompressedData(const void* data, size_t dataSize, const glm::ivec2& offset, const glm::ivec2& size, 
+	uint32_t internalFormat, uint32_t level)
+{
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glCompressedTexSubImage2D(m_target, level, offset.x, offset.y, size.x, size.y, internalFormat, (int)dataSize, data);
+}
+
+void Texture2D::SetLevelData(uint32_t level, const void* pixels, uint32_t pixelDataType, uint32_t internalFormat, uint32_t format)
+{
+	const glm::ivec2 levelSize = this->GetLevelSize(level);
+
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glTexImage2D(m_target, level, internalFormat, levelSize.x, levelSize.y, 0, format, pixelDataType, pixels);
+	this->SetLevelAllocatedSize(level, (size_t)levelSize.x * levelSize.y * TextureBuffer::GetPixelSize(internalFormat));
+}
+
+void Texture2D::SetCompressedLevelData(uint32_t level, const void* data, size_t dataSize, uint32_t internalFormat)
+{
+	const glm::ivec2 levelSize = this->GetLevelSize(level);
+
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glCompressedTexImage2D(m_target, level, internalFormat, levelSize.x, levelSize.y, 0, (int)dataSize, data);
+	this->SetLevelAllocatedSize(level, dataSize);
+}
+
+glm::ivec2 Texture2D::GetLevelSize(uint32_t level) const
+{
+	return glm::max(glm::ivec2(m_size.x >> level, m_size.y >> level), glm::ivec2(1));
+}
+
+void Texture2D::Swap(Texture2D& other) noexcept
 {
-	glBindTexture(m_target, m_id);
-	glTexSubImage2D(m_target, 0, offset.x, offset.y, size.x, size.y, format, pixelDataType, pixels);
-	glBindTexture(m_target, 0);
+	std::swap(m_id, other.m_id);
+	std::swap(m_target, other.m_target);
+	std::swap(m_size, other.m_size);
+	const size_t allocatedSize = m_allocatedSize.load(std::memory_order_relaxed);
+	m_allocatedSize.store(other.m_allocatedSize.exchange(allocatedSize, std::memory_order_relaxed), std::memory_order_relaxed);
+	std::swap(m_levelAllocatedSizes, other.m_levelAllocatedSizes);
 }
@@ -8,6 +8,10 @@ class Texture2D : public TextureBuffer
 public:
 	Texture2D() = default;
 	Texture2D(const void* pixels, const glm::ivec2& size, uint32_t pixelDataType, uint32_t internalFormat, uint32_t format);
+
+	// Creates a texture buffer with the given number of mip levels, the storage of each level is then allocated with 
+	// SetLevelData() or SetCompressedLevelData().
+	Texture2D(const glm::ivec2& size, uint32_t levelCount);
 	Texture2D(Texture2D&& temp) noexcept;
 
 	~Texture2D() = default;
@@ -15,7 +19,26 @@ public:
 	Texture2D& operator=(Texture2D&& temp) noexcept;
 
 	// Updates the data at the specified offset in the buffer with the new pixel data provided.
-	void ModifyData(const void* pixels, const glm::ivec2& offset, const glm::ivec2& size, uint32_t pixelDataType, uint32_t format);
+	void ModifyData(const void* pixels, const glm::ivec2& offset, const glm::ivec2& size, uint32_t pixelDataType, uint32_t format,
+		uint32_t level = 0);
+
+	// Updates the data at the specified offset in the mip level with the new compressed data provided.
+	// The offset must be a multiple of the compression format's block size.
+	void ModifyCompressedData(const void* data, size_t dataSize, const glm::ivec2& offset, const glm::ivec2& size, 
+		uint32_t internalFormat, uint32_t level);
+
+	// Allocates the storage of the mip level and fills it with the pixel data given, which may be nullptr to leave it empty.
+	void SetLevelData(uint32_t level, const void* pixels, uint32_t pixelDataType, uint32_t internalFormat, uint32_t format);
+
+	// Allocates the storage of the mip level with a compressed internal format and fills it with the compressed data given, 
+	// which may be nullptr to leave it empty.
+	void SetCompressedLevelData(uint32_t level, const void* data, size_t dataSize, uint32_t internalFormat);
+
+	// Returns the size of the given mip level.
+	glm::ivec2 GetLevelSize(uint32_t level) const;
+
+	// Exchanges the texture buffer with the other one, so that anything referring to this texture uses the other's buffer.
+	void Swap(Texture2D& other) noexcept;
 };
 
 #endif
@@ -0,0 +1,114 @@
+#include <graphics/texture_2d_array.h>
+#include <graphics/gl_state_cache.h>
+#include <glad/glad.h>
+
+#include <utility>
+
+Texture2DArray::Texture2DArray() :
+	m_layerCount(0), m_levelCount(0)
+{}
+
+Texture2DArray::Texture2DArray(const glm::ivec2& size, uint32_t layerCount, uint32_t levelCount) :
+	TextureBuffer(GL_TEXTURE_2D_ARRAY, size), m_layerCount(layerCount), m_levelCount(levelCount)
+{
+	glGenTextures(1, &m_id);
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+
+	// Only sample from the levels which will be given, since the texture is incomplete if any are missing
+	glTexParameteri(m_target, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, (int)levelCount - 1);
+
+	this->SetFilter(levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR, GL_LINEAR);
+	this->SetWrap(GL_REPEAT, GL_REPEAT);
+}
+
+Texture2DArray::Texture2DArray(Texture2DArray&& temp) noexcept
+{
+	m_id = temp.m_id;
+	m_target = temp.m_target;
+	m_size = temp.m_size;
+	m_layerCount = temp.m_layerCount;
+	m_levelCount = temp.m_levelCount;
+
+	m_allocatedSize.store(temp.m_allocatedSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	m_levelAllocatedSizes = std::move(temp.m_levelAllocatedSizes);
+
+	temp.m_id = 0;
+	temp.m_allocatedSize.store(0, std::memory_order_relaxed);
+	temp.m_levelAllocatedSizes.clear();
+}
+
+Texture2DArray& Texture2DArray::operator=(Texture2DArray&& temp) noexcept
+{
+	if (this == &temp)
+		return *this;
+
+	this->Release(); // The texture being replaced would otherwise be leaked, along with its tracked allocation
+
+	m_id = temp.m_id;
+	m_target = temp.m_target;
+	m_size = temp.m_size;
+	m_layerCount = temp.m_layerCount;
+	m_levelCount = temp.m_levelCount;
+
+	m_allocatedSize.store(temp.m_allocatedSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	m_levelAllocatedSizes = std::move(temp.m_levelAllocatedSizes);
+
+	temp.m_id = 0;
+	temp.m_allocatedSize.store(0, std::memory_order_relaxed);
+	temp.m_levelAllocatedSizes.clear();
+	return *this;
+}
+
+void Texture2DArray::AllocateLevel(uint32_t level, uint32_t internalFormat, uint32_t format, uint32_t pixelDataType)
+{
+	const glm::ivec2 levelSize = this->GetLevelSize(level);
+
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glTexImage3D(m_target, level, internalFormat, levelSize.x, levelSize.y, m_layerCount, 0, format, pixelDataType, nullptr);
+
+	const size_t layerSize = (size_t)levelSize.x * levelSize.y * TextureBuffer::GetPixelSize(internalFormat);
+	this->SetLevelAllocatedSize(level, layerSize * m_layerCount);
+}
+
+void Texture2DArray::AllocateCompressedLevel(uint32_t level, size_t layerDataSize, uint32_t internalFormat)
+{
+	const glm::ivec2 levelSize = this->GetLevelSize(level);
+
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glCompressedTexImage3D(m_target, level, internalFormat, levelSize.x, levelSize.y, m_layerCount, 0, 
+		(int)(layerDataSize * m_layerCount), nullptr);
+	this->SetLevelAllocatedSize(level, layerDataSize * m_layerCount);
+}
+
+void Texture2DArray::ModifyLayerData(uint32_t layer, uint32_t level, const void* pixels, uint32_t pixelDataType, uint32_t format)
+{
+	const glm::ivec2 levelSize = this->GetLevelSize(level);
+
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glTexSubImage3D(m_target, level, 0, 0, layer, levelSize.x, levelSize.y, 1, format, pixelDataType, pixels);
+}
+
+void Texture2DArray::ModifyCompressedLayerData(uint32_t layer, uint32_t level, const void* data, size_t dataSize, 
+	uint32_t internalFormat)
+{
+	const glm::ivec2 levelSize = this->GetLevelSize(level);
+
+	GLStateCache::GetInstance().BindTexture(m_target, m_id);
+	glCompressedTexSubImage3D(m_target, level, 0, 0, layer, levelSize.x, levelSize.y, 1, internalFormat, (int)dataSize, data);
+}
+
+glm::ivec2 Texture2DArray::GetLevelSize(uint32_t level) const
+{
+	return glm::max(glm::ivec2(m_size.x >> level, m_size.y >> level), glm::ivec2(1));
+}
+
+uint32_t Texture2DArray::GetLayerCount() const
+{
+	return m_layerCount;
+}
+
+uint32_t Texture2DArray::GetLevelCount() const
+{
+	return m_levelCount;
+}
@@ -0,0 +1,49 @@
+#ifndef TEXTURE_2D_ARRAY_H
+#define TEXTURE_2D_ARRAY_H
+
+#include <graphics/texture_buffer.h>
+
+#include <cstddef>
+
+// An array of 2D textures of the same size and format, which is bound as a single texture and sampled with a layer index.
+// Draws using different layers of the same array don't need to rebind textures between them.
+class Texture2DArray : public TextureBuffer
+{
+private:
+	uint32_t m_layerCount, m_levelCount;
+public:
+	Texture2DArray();
+
+	// Creates a texture array with the given number of layers and mip levels, the storage of each level is then allocated with 
+	// AllocateLevel() or AllocateCompressedLevel() before its layers are filled.
+	Texture2DArray(const glm::ivec2& size, uint32_t layerCount, uint32_t levelCount);
+	Texture2DArray(Texture2DArray&& temp) noexcept;
+
+	~Texture2DArray() = default;
+
+	Texture2DArray& operator=(Texture2DArray&& temp) noexcept;
+
+	// Allocates the storage of the mip level for every layer, leaving it empty.
+	void AllocateLevel(uint32_t level, uint32_t internalFormat, uint32_t format, uint32_t pixelDataType);
+
+	// Allocates the storage of the mip level for every layer with a compressed internal format, leaving it empty.
+	// The size given is the size of the compressed data of a single layer of the level.
+	void AllocateCompressedLevel(uint32_t level, size_t layerDataSize, uint32_t internalFormat);
+
+	// Replaces the data of the mip level of a layer with the pixel data given.
+	void ModifyLayerData(uint32_t layer, uint32_t level, const void* pixels, uint32_t pixelDataType, uint32_t format);
+
+	// Replaces the data of the mip level of a layer with the compressed data given.
+	void ModifyCompressedLayerData(uint32_t layer, uint32_t level, const void* data, size_t dataSize, uint32_t internalFormat);
+
+	// Returns the size of the given mip level.
+	glm::ivec2 GetLevelSize(uint32_t level) const;
+
+	// Returns the number of layers in the array.
+	uint32_t GetLayerCount() const;
+
+	// Returns the number of mip levels of each layer.
+	uint32_t GetLevelCount() const;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include <graphics/texture_array_builder.h>
+#include <util/formatted_exception.h>
+
+#include <glad/glad.h>
+
+uint32_t TextureArrayBuilder::AddLayer(CookedTexture texture, const std::string& name)
+{
+    if (!m_layers.empty())
+    {
+        const CookedTexture& firstLayer = m_layers.front();
+        if (texture.GetSize() != firstLayer.GetSize() || texture.GetLevelCount() != firstLayer.GetLevelCount() ||
+            texture.GetInternalFormat() != firstLayer.GetInternalFormat() || texture.GetFormat() != firstLayer.GetFormat())
+        {
+            throw FormattedException("The texture \"%s\" (%dx%d, format 0x%X) doesn't match the size and format of the texture array "
+                "(%dx%d, format 0x%X).", name.c_str(), texture.GetSize().x, texture.GetSize().y, texture.GetInternalFormat(), 
+                firstLayer.GetSize().x, firstLayer.GetSize().y, firstLayer.GetInternalFormat());
+        }
+    }
+
+    m_layers.push_back(std::move(texture));
+    return (uint32_t)m_layers.size() - 1;
+}
+
+Texture2DArray TextureArrayBuilder::Build() const
+{
+    if (m_layers.empty())
+        throw FormattedException("Can't build a texture array without any layers.");
+
+    int maxLayerCount = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayerCount);
+    if (m_layers.size() > (size_t)maxLayerCount)
+        throw FormattedException("The texture array has %zu layers, more than the maximum of %d.", m_layers.size(), maxLayerCount);
+
+    const CookedTexture& firstLayer = m_layers.front();
+    Texture2DArray textureArray(firstLayer.GetSize(), (uint32_t)m_layers.size(), firstLayer.GetLevelCount());
+
+    // The rows of uncompressed levels are tightly packed, rather than aligned to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (uint32_t levelIndex = 0; levelIndex < firstLayer.GetLevelCount(); levelIndex++)
+    {
+        if (firstLayer.IsCompressed())
+        {
+            textureArray.AllocateCompressedLevel(levelIndex, (size_t)firstLayer.GetLevel(levelIndex).m_dataSize, 
+                firstLayer.GetInternalFormat());
+        }
+        else
+            textureArray.AllocateLevel(levelIndex, firstLayer.GetInternalFormat(), firstLayer.GetFormat(), GL_UNSIGNED_BYTE);
+
+        for (uint32_t layerIndex = 0; layerIndex < m_layers.size(); layerIndex++)
+        {
+            const CookedTexture& layer = m_layers[layerIndex];
+            if (layer.IsCompressed())
+            {
+                textureArray.ModifyCompressedLayerData(layerIndex, levelIndex, layer.GetLevelData(levelIndex), 
+                    (size_t)layer.GetLevel(levelIndex).m_dataSize, layer.GetInternalFormat());
+            }
+            else
+            {
+                textureArray.ModifyLayerData(layerIndex, levelIndex, layer.GetLevelData(levelIndex), GL_UNSIGNED_BYTE, 
+                    layer.GetFormat());
+            }
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return textureArray;
+}
+
+uint32_t TextureArrayBuilder::GetLayerCount() const
+{
+    return (uint32_t)m_layers.size();
+}
@@ -0,0 +1,34 @@
+#ifndef TEXTURE_ARRAY_BUILDER_H
+#define TEXTURE_ARRAY_BUILDER_H
+
+#include <graphics/texture_2d_array.h>
+#include <graphics/cooked_texture.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Packs cooked textures of the same size and format (e.g. a set of road signs or vehicle liveries) into the layers of a 
+// texture array, so that draws using any of them share a single texture bind.
+class TextureArrayBuilder
+{
+private:
+	std::vector<CookedTexture> m_layers;
+public:
+	TextureArrayBuilder() = default;
+	~TextureArrayBuilder() = default;
+
+	// Adds the texture as the next layer of the array and returns the index of its layer.
+	// Throws a formatted exception if the texture's size, format or number of mip levels differ from those of the first layer,
+	// the name given is only used in the error message.
+	uint32_t AddLayer(CookedTexture texture, const std::string& name);
+
+	// Creates the texture array and uploads every mip level of every layer into it.
+	// This must be called on the thread with the OpenGL context.
+	Texture2DArray Build() const;
+
+	// Returns the number of layers added so far.
+	uint32_t GetLayerCount() const;
+};
+
+#endif
@@ -1,49 +1,94 @@
 #include <graphics/texture_buffer.h>
+#include <graphics/gl_state_cache.h>
+#include <graphics/gpu_memory_tracker.h>
 #include <glad/glad.h>
 
 TextureBuffer::TextureBuffer() :
-    m_id(0), m_target(0), m_size(glm::ivec2(0))
+    m_id(0), m_target(0), m_size(glm::ivec2(0)), m_allocatedSize(0)
 {}
 
 TextureBuffer::TextureBuffer(uint32_t target, const glm::ivec2& size) :
-    m_id(0), m_target(target), m_size(size)
+    m_id(0), m_target(target), m_size(size), m_allocatedSize(0)
 {}
 
 TextureBuffer::~TextureBuffer()
 {
+    this->Release();
+}
+
+void TextureBuffer::Release()
+{
+    if (m_id == 0)
+        return;
+
     glDeleteTextures(1, &m_id);
+    GLStateCache::GetInstance().OnTextureDeleted(m_id);
+    GPUMemoryTracker::GetInstance().OnFreed(GPUMemoryTracker::Category::TEXTURE, m_allocatedSize.exchange(0, std::memory_order_relaxed));
+
+    m_id = 0;
+    m_levelAllocatedSizes.clear();
+}
+
+void TextureBuffer::SetLevelAllocatedSize(uint32_t level, size_t size)
+{
+    if (level >= m_levelAllocatedSizes.size())
+        m_levelAllocatedSizes.resize(level + 1, 0);
+
+    GPUMemoryTracker::GetInstance().OnFreed(GPUMemoryTracker::Category::TEXTURE, m_levelAllocatedSizes[level]);
+    GPUMemoryTracker::GetInstance().OnAllocated(GPUMemoryTracker::Category::TEXTURE, size);
+
+    m_allocatedSize.fetch_add(size - m_levelAllocatedSizes[level], std::memory_order_relaxed);
+    m_levelAllocatedSizes[level] = size;
+}
+
+size_t TextureBuffer::GetPixelSize(uint32_t internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_RED:
+    case GL_R8:
+        return 1;
+    case GL_RG:
+    case GL_RG8:
+        return 2;
+    case GL_RGBA16F:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    default:
+        // Drivers store 3 channel formats with 4 bytes per pixel, which is also the size of the depth and stencil formats
+        return 4;
+    }
 }
 
 void TextureBuffer::SetFilter(uint32_t min, uint32_t mag) const
 {
-    glBindTexture(m_target, m_id);
+    // The texture is left bound afterwards, the state cache keeps track of it so it will be rebound if it needs to be
+    GLStateCache::GetInstance().BindTexture(m_target, m_id);
     glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, min);
     glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, mag);
-    glBindTexture(m_target, 0);
 }
 
 void TextureBuffer::SetWrap(uint32_t sAxis, uint32_t tAxis) const
 {
-    glBindTexture(m_target, m_id);
+    GLStateCache::GetInstance().BindTexture(m_target, m_id);
     glTexParameteri(m_target, GL_TEXTURE_WRAP_S, sAxis);
     glTexParameteri(m_target, GL_TEXTURE_WRAP_T, tAxis);
-    glBindTexture(m_target, 0);
 }
 
 void TextureBuffer::Bind() const
 {
-    glBindTexture(m_target, m_id);
+    GLStateCache::GetInstance().BindTexture(m_target, m_id);
 }
 
 void TextureBuffer::Bind(int textureUnit) const
 {
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(m_target, m_id);
+    GLStateCache::GetInstance().BindTexture(textureUnit, m_target, m_id);
 }
 
 void TextureBuffer::Unbind() const
 {
-    glBindTexture(m_target, 0);
+    GLStateCache::GetInstance().BindTexture(m_target, 0);
 }
 
 uint32_t TextureBuffer::GetID() const
@@ -60,3 +105,8 @@ const glm::ivec2& TextureBuffer::GetSize() const
 {
     return m_size;
 }
+
+size_t TextureBuffer::GetAllocatedSize() const
+{
+    return m_allocatedSize.load(std::memory_order_relaxed);
+}
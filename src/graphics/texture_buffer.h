@@ -3,6 +3,10 @@
 
 #include <glm/glm.hpp>
 
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
 typedef unsigned int uint32_t;
 
 class TextureBuffer // This is purely an abstract class, it shouldn't be used directly (as in creating objects of it)
@@ -10,6 +14,20 @@ class TextureBuffer // This is purely an abstract class, it shouldn't be used di
 protected:
 	uint32_t m_id, m_target;
 	glm::ivec2 m_size;
+
+	// The estimated GPU memory allocated for all of the texture's levels in bytes, which can be read from any thread
+	std::atomic<size_t> m_allocatedSize;
+	std::vector<size_t> m_levelAllocatedSizes;
+
+	// Records the number of bytes allocated for the mip level, which replaces any storage the level had before.
+	// This is reported to the GPU memory tracker, and the allocation is reported freed when the texture is deleted.
+	void SetLevelAllocatedSize(uint32_t level, size_t size);
+
+	// Deletes the texture and reports its allocation as freed, leaving the texture buffer empty.
+	void Release();
+
+	// Returns the number of bytes each pixel of the uncompressed internal format takes up.
+	static size_t GetPixelSize(uint32_t internalFormat);
 public:
 	TextureBuffer();
 	TextureBuffer(uint32_t target, const glm::ivec2& size);
@@ -42,6 +60,9 @@ public:
 
 	// Returns the size of the texture buffer.
 	const glm::ivec2& GetSize() const;
+
+	// Returns the estimated number of bytes of GPU memory allocated for the texture's levels.
+	size_t GetAllocatedSize() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include <graphics/uniform_buffer.h>
+#include <graphics/gl_state_cache.h>
+#include <glad/glad.h>
+
+UniformBuffer::UniformBuffer() :
+    m_id(0)
+{}
+
+UniformBuffer::UniformBuffer(const void* data, size_t size, uint32_t usage)
+{
+    glGenBuffers(1, &m_id);
+    GLStateCache::GetInstance().BindBuffer(GL_UNIFORM_BUFFER, m_id);
+    glBufferData(GL_UNIFORM_BUFFER, size, data, usage);
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& temp) noexcept :
+    m_id(temp.m_id)
+{
+    temp.m_id = 0;
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &m_id);
+    GLStateCache::GetInstance().OnBufferDeleted(m_id);
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& temp) noexcept
+{
+    m_id = temp.m_id;
+    temp.m_id = 0;
+
+    return *this;
+}
+
+void UniformBuffer::ModifyData(const void* data, size_t offset, size_t size)
+{
+    GLStateCache::GetInstance().BindBuffer(GL_UNIFORM_BUFFER, m_id);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+void UniformBuffer::BindBase(uint32_t bindingPoint) const
+{
+    // Binding to an indexed binding point also binds the buffer to the generic binding point, so keep the state cache in sync
+    GLStateCache::GetInstance().BindBuffer(GL_UNIFORM_BUFFER, m_id);
+    glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, m_id);
+}
+
+void UniformBuffer::Bind() const
+{
+    GLStateCache::GetInstance().BindBuffer(GL_UNIFORM_BUFFER, m_id);
+}
+
+void UniformBuffer::Unbind() const
+{
+    GLStateCache::GetInstance().BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+uint32_t UniformBuffer::GetID() const
+{
+    return m_id;
+}
@@ -0,0 +1,38 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+typedef unsigned int uint32_t;
+
+class UniformBuffer
+{
+private:
+	uint32_t m_id;
+public:
+	UniformBuffer();
+	UniformBuffer(const void* data, size_t size, uint32_t usage);
+	UniformBuffer(const UniformBuffer& other) = delete;
+	UniformBuffer(UniformBuffer&& temp) noexcept;
+
+	~UniformBuffer();
+
+	UniformBuffer& operator=(const UniformBuffer& other) = delete;
+	UniformBuffer& operator=(UniformBuffer&& temp) noexcept;
+
+	// Updates the data at the specified offset in the buffer with the new data provided.
+	void ModifyData(const void* data, size_t offset, size_t size);
+
+	// Binds the uniform buffer to the specified uniform block binding point.
+	// Shader uniform blocks which are assigned to the same binding point will then read from this buffer.
+	void BindBase(uint32_t bindingPoint) const;
+
+	// Binds the uniform buffer.
+	void Bind() const;
+
+	// Unbinds the uniform buffer.
+	void Unbind() const;
+
+	// Returns the ID of the uniform buffer.
+	uint32_t GetID() const;
+};
+
+#endif
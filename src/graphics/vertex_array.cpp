@@ -1,4 +1,5 @@
 #include <graphics/vertex_array.h>
+#include <graphics/gl_state_cache.h>
 #include <glad/glad.h>
 
 VertexArray::VertexArray()
@@ -9,13 +10,14 @@ VertexArray::VertexArray()
 VertexArray::~VertexArray()
 {
     glDeleteVertexArrays(1, &m_id);
+    GLStateCache::GetInstance().OnVertexArrayDeleted(m_id);
 }
 
 void VertexArray::AttachBuffers(const VertexBuffer& vbo, const IndexBuffer* ibo)
 {
     // Bind the VAO first then bind the buffer objects
     // This attaches the buffer objects to the VAO
-    glBindVertexArray(m_id);
+    GLStateCache::GetInstance().BindVertexArray(m_id);
     vbo.Bind();
 
     if (ibo)
@@ -31,22 +33,19 @@ void VertexArray::AttachBuffers(const VertexBuffer& vbo, const IndexBuffer* ibo)
         glVertexAttribDivisor(vertexLayout.m_index, vertexLayout.m_divisor);
     }
 
-    // Unbind the VAO and buffer objects
-    glBindVertexArray(0);
-    vbo.Unbind();
-
-    if (ibo)
-        ibo->Unbind();
+    // Unbind the VAO, the buffer objects are left bound since the state cache keeps track of them
+    // Note that the index buffer must not be unbound while the VAO is still bound, otherwise it would be detached from it
+    GLStateCache::GetInstance().BindVertexArray(0);
 }
 
 void VertexArray::Bind() const
 {
-    glBindVertexArray(m_id);
+    GLStateCache::GetInstance().BindVertexArray(m_id);
 }
 
 void VertexArray::Unbind() const
 {
-    glBindVertexArray(0);
+    GLStateCache::GetInstance().BindVertexArray(0);
 }
 
 uint32_t VertexArray::GetID() const
@@ -1,33 +1,43 @@
 #include <graphics/vertex_buffer.h>
+#include <graphics/gl_state_cache.h>
+#include <graphics/gpu_memory_tracker.h>
 #include <glad/glad.h>
 
 VertexBuffer::VertexBuffer() :
-    m_id(0)
+    m_id(0), m_size(0)
 {}
 
-VertexBuffer::VertexBuffer(const void* data, size_t size, uint32_t usage)
+VertexBuffer::VertexBuffer(const void* data, size_t size, uint32_t usage) :
+    m_size(size)
 {
     glGenBuffers(1, &m_id);
-    glBindBuffer(GL_ARRAY_BUFFER, m_id);
+    GLStateCache::GetInstance().BindBuffer(GL_ARRAY_BUFFER, m_id);
     glBufferData(GL_ARRAY_BUFFER, size, data, usage);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GPUMemoryTracker::GetInstance().OnAllocated(GPUMemoryTracker::Category::BUFFER, size);
 }
 
 VertexBuffer::VertexBuffer(VertexBuffer&& temp) noexcept :
-    m_id(temp.m_id)
+    m_id(temp.m_id), m_size(temp.m_size)
 {
     temp.m_id = 0;
+    temp.m_size = 0;
 }
 
 VertexBuffer::~VertexBuffer()
 {
     glDeleteBuffers(1, &m_id);
+    GLStateCache::GetInstance().OnBufferDeleted(m_id);
+    GPUMemoryTracker::GetInstance().OnFreed(GPUMemoryTracker::Category::BUFFER, m_size);
 }
 
 VertexBuffer& VertexBuffer::operator=(VertexBuffer&& temp) noexcept
 {
     m_id = temp.m_id;
+    m_size = temp.m_size;
+
     temp.m_id = 0;
+    temp.m_size = 0;
 
     return *this;
 }
@@ -40,19 +50,28 @@ void VertexBuffer::PushLayout(uint32_t index, uint32_t type, uint32_t size, size
 
 void VertexBuffer::ModifyData(const void* data, size_t offset, size_t size)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_id);
+    GLStateCache::GetInstance().BindBuffer(GL_ARRAY_BUFFER, m_id);
     glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexBuffer::Reallocate(const void* data, size_t size, uint32_t usage)
+{
+    GLStateCache::GetInstance().BindBuffer(GL_ARRAY_BUFFER, m_id);
+    glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+
+    GPUMemoryTracker::GetInstance().OnFreed(GPUMemoryTracker::Category::BUFFER, m_size);
+    GPUMemoryTracker::GetInstance().OnAllocated(GPUMemoryTracker::Category::BUFFER, size);
+    m_size = size;
 }
 
 void VertexBuffer::Bind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_id);
+    GLStateCache::GetInstance().BindBuffer(GL_ARRAY_BUFFER, m_id);
 }
 
 void VertexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::GetInstance().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 const std::vector<VertexBuffer::Layout>& VertexBuffer::GetVertexLayouts() const
@@ -60,6 +79,11 @@ const std::vector<VertexBuffer::Layout>& VertexBuffer::GetVertexLayouts() const
     return m_vertexLayouts;
 }
 
+size_t VertexBuffer::GetAllocatedSize() const
+{
+    return m_size;
+}
+
 uint32_t VertexBuffer::GetID() const
 {
     return m_id;
@@ -15,6 +15,7 @@ public:
 	};
 private:
 	uint32_t m_id;
+	size_t m_size; // The size of the buffer's data store in bytes
 	std::vector<Layout> m_vertexLayouts;
 public:
 	VertexBuffer();
@@ -34,6 +35,10 @@ public:
 	// Updates the data at the specified offset in the buffer with the new data provided.
 	void ModifyData(const void* data, size_t offset, size_t size);
 
+	// Replaces the buffer's data store with a new one of the specified size, filled with the data provided (if any).
+	// The ID of the buffer is kept, so vertex arrays which the buffer is attached to remain valid.
+	void Reallocate(const void* data, size_t size, uint32_t usage);
+
 	// Binds the vertex buffer.
 	void Bind() const;
 
@@ -43,6 +48,9 @@ public:
 	// Returns the vector containing all the specified vertex layouts.
 	const std::vector<Layout>& GetVertexLayouts() const;
 
+	// Returns the number of bytes of GPU memory allocated for the buffer's data store.
+	size_t GetAllocatedSize() const;
+
 	// Returns the ID of the vertex buffer.
 	uint32_t GetID() const;
 };
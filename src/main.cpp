@@ -1,18 +1,24 @@
 #include <core/window_frame.h>
 #include <core/asset_system.h>
 #include <core/input_system.h>
+#include <core/game_loop.h>
+#include <core/job_system.h>
+#include <core/render_thread.h>
 
 #include <graphics/vertex_array.h>
 #include <graphics/camera_3d.h>
 #include <graphics/renderer.h>
+#include <graphics/gl_state_cache.h>
 
 #include <util/formatted_exception.h>
 #include <util/logging_system.h>
-#include <util/time.h>
+#include <util/profiler.h>
+#include <util/frame_stats.h>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <filesystem>
 #include <glm/gtc/matrix_transform.hpp>
 
 int main()
@@ -20,109 +26,140 @@ int main()
 	try
 	{
 		// Initialize the GLFW library
-		if (!glfwInit())
-			throw FormattedException("Failed to initialize the GLFW library");
+		WindowFrame::InitLibrary();
 
 		// Create the application window
 		WindowFrame applicationFrame("Motorway Remastered", { 1600, 900 }, false, false, false);
 		applicationFrame.SetCursorMode(false);
 		applicationFrame.SetContextActive();
 		
+		Profiler::GetInstance().SetThreadName("Main");
+
 		LoggingSystem::GetInstance().Output("GLFW version: %s", LoggingSystem::Severity::INFO, applicationFrame.GetGLFWVersion().c_str());
 		LoggingSystem::GetInstance().Output("OpenGL version: %s", LoggingSystem::Severity::INFO, applicationFrame.GetOpenGLVersion().c_str());
 		
-		// Initialize the rendering and input system
+		// Mount the asset pack if the game has been packaged, so assets are read from it instead of individual files
+		if (std::filesystem::exists("assets.mpak"))
+			AssetSystem::GetInstance().MountPack("assets.mpak");
+
+		// Initialize the job, rendering and input system
+		JobSystem::GetInstance().Init();
+		LoggingSystem::GetInstance().Output("Job system threads: %u", LoggingSystem::Severity::INFO, JobSystem::GetInstance().GetThreadCount());
 		Renderer::GetInstance().Init();
 		InputSystem::GetInstance().SetFocusedWindow(applicationFrame);
 
 		// Setup other objects here (TEMPORARY)
-		AssetSystem::GetInstance().LoadTexture("Grass", "textures/test.jpg", false, false);
+		// Everything which creates GPU resources has to be done here, before the render thread takes the OpenGL context
 		Camera3D camera({ 0.0f, 0.0f, 0.0f }, { 1600.0f, 900.0f });
 
-		// The main loop of the application
-		constexpr float timeStep = 0.001f;
-		float accumulatedRenderTime = 0.0f, elapsedRenderTime = 0.0f;
+		Geometry::Material material;
+		material.m_diffuseTexture = AssetSystem::GetInstance().LoadTextureAsync("Grass", "textures/test.jpg", false, false);
+		material.m_enableTextures = true;
+
+		Geometry::Transform transform;
+		transform.m_size = { 1.2f, 1.2f, 1.0f };
+
+		transform.m_position = { 0.0f, 0.0f, -5.0f };
+		const Square square(transform, material);
+
+		transform.m_position = { 5.0f, 0.0f, -5.0f };
+		const Triangle triangle(transform, material);
 
-		while (!applicationFrame.WasRequestedClose())
+		transform.m_position = { 2.5f, 0.0f, -5.0f };
+		const Circle circle(transform, material);
+
+		// Hand the OpenGL context over to the render thread, which renders the frame packets recorded below
+		RenderThread renderThread;
+		renderThread.Start(applicationFrame, [](const FramePacket& packet)
+		{
+			AssetSystem::GetInstance().UploadPendingTextures();
+			AssetSystem::GetInstance().UploadPendingGeometry();
+			Renderer::GetInstance().RenderPacket(packet);
+			Renderer::GetInstance().EndFrame();
+			GLStateCache::GetInstance().EndFrame();
+			Profiler::GetInstance().EndFrame();
+		});
+
+		// The main loop of the application, the simulation runs at a fixed tick rate and the frames are rendered in between
+		GameLoop gameLoop(60.0, 5);
+		glm::vec3 previousCameraPosition = camera.GetPosition();
+		bool statsKeyHeld = false;
+
+		gameLoop.Run(applicationFrame, [&](float tickDuration)
 		{
-			// Update the application logic
-			accumulatedRenderTime += elapsedRenderTime;
-			while (accumulatedRenderTime >= timeStep)
+			PROFILE_SCOPE("Main::Tick");
+
+			previousCameraPosition = camera.GetPosition();
+
+			///////////////////////////////// CAMERA CONTROLS (TEMPORARY) /////////////////////////////////
+
+			const glm::vec3 cameraDirection = camera.GetDirection();
+			const glm::vec3 cameraPerpDirection = glm::cross(camera.GetDirection(), { 0.0f, 1.0f, 0.0f });
+			const float cameraSpeed = 5.0f;
+
+			if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_W))
+			{
+				camera.SetPosition(camera.GetPosition() + 
+					((glm::vec3(cameraDirection.x, 0.0f, cameraDirection.z) * cameraSpeed) * tickDuration));
+			}
+			else if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_S))
 			{
-				///////////////////////////////// CAMERA CONTROLS (TEMPORARY) /////////////////////////////////
-
-				const glm::vec3 cameraDirection = camera.GetDirection();
-				const glm::vec3 cameraPerpDirection = glm::cross(camera.GetDirection(), { 0.0f, 1.0f, 0.0f });
-				const float cameraSpeed = 5.0f;
-
-				if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_W))
-				{
-					camera.SetPosition(camera.GetPosition() + 
-						((glm::vec3(cameraDirection.x, 0.0f, cameraDirection.z) * cameraSpeed) * timeStep));
-				}
-				else if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_S))
-				{
-					camera.SetPosition(camera.GetPosition() -
-						((glm::vec3(cameraDirection.x, 0.0f, cameraDirection.z) * cameraSpeed) * timeStep));
-				}
-				
-				if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_A))
-					camera.SetPosition(camera.GetPosition() + ((-cameraPerpDirection * cameraSpeed) * timeStep));
-				else if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_D))
-					camera.SetPosition(camera.GetPosition() + ((cameraPerpDirection * cameraSpeed) * timeStep));
-
-				if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_SPACE))
-					camera.SetPosition(camera.GetPosition() + ((glm::vec3(0.0f, 1.0f, 0.0f) * cameraSpeed) * timeStep));
-				else if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_LEFT_SHIFT))
-					camera.SetPosition(camera.GetPosition() - ((glm::vec3(0.0f, 1.0f, 0.0f) * cameraSpeed) * timeStep));
-
-				///////////////////////////////////////////////////////////////////////////////////////////////
-				
-				if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_ESCAPE))
-				{
-					glfwTerminate();
-					return EXIT_SUCCESS;
-				}
-
-				InputSystem::GetInstance().Update();
-				camera.Update();
-
-				accumulatedRenderTime -= timeStep;
+				camera.SetPosition(camera.GetPosition() -
+					((glm::vec3(cameraDirection.x, 0.0f, cameraDirection.z) * cameraSpeed) * tickDuration));
 			}
+			
+			if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_A))
+				camera.SetPosition(camera.GetPosition() + ((-cameraPerpDirection * cameraSpeed) * tickDuration));
+			else if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_D))
+				camera.SetPosition(camera.GetPosition() + ((cameraPerpDirection * cameraSpeed) * tickDuration));
 
-			// Render to screen and calculate the amount time taken to render
-			const float preRenderTime = Time::GetSecondsSinceEpoch();
+			if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_SPACE))
+				camera.SetPosition(camera.GetPosition() + ((glm::vec3(0.0f, 1.0f, 0.0f) * cameraSpeed) * tickDuration));
+			else if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_LEFT_SHIFT))
+				camera.SetPosition(camera.GetPosition() - ((glm::vec3(0.0f, 1.0f, 0.0f) * cameraSpeed) * tickDuration));
 
-			Renderer::GetInstance().Clear(Renderer::ClearFlag::COLOR_BUFFER_BIT | Renderer::ClearFlag::DEPTH_BUFFER_BIT, 
-				{ 0.0f, 0.0f, 0.0f, 1.0f });
+			///////////////////////////////////////////////////////////////////////////////////////////////
 			
-			//////// TEMPORARY ///////
+			if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_ESCAPE))
+				applicationFrame.RequestClose();
 
-			Geometry::Transform transform;
-			transform.m_position = { 0.0f, 0.0f, -5.0f };
-			transform.m_size = { 1.2f, 1.2f, 1.0f };
+			// Capture a profile of the next 120 frames
+			if (InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_F9))
+				Profiler::GetInstance().BeginCapture(120, "profile_capture.json");
 
-			Geometry::Material material;
-			material.m_diffuseTexture = AssetSystem::GetInstance().GetTexture("Grass");
-			material.m_enableTextures = true;
+			// Write the frame time statistics gathered so far to the log, once per press
+			const bool statsKeyPressed = InputSystem::GetInstance().WasKeyPressed(InputSystem::KeyCode::KEY_F10);
+			if (statsKeyPressed && !statsKeyHeld)
+				FrameStats::GetInstance().Dump();
 
-			Renderer::GetInstance().Render(camera, Square(transform, material));
-
-			transform.m_position = { 5.0f, 0.0f, -5.0f, };
+			statsKeyHeld = statsKeyPressed;
+		},
+		[&](float interpolationAlpha)
+		{
+			// The camera is turned once per frame so that looking around stays responsive at any tick rate, however its 
+			// position is blended between the last two ticks
+			camera.Update();
 
-			Renderer::GetInstance().Render(camera, Triangle(transform, material));
+			FramePacket& packet = renderThread.BeginPacket();
+			packet.m_camera = camera;
+			packet.m_camera.SetPosition(glm::mix(previousCameraPosition, camera.GetPosition(), interpolationAlpha));
 
-			transform.m_position = { 2.5f, 0.0f, -5.0f, };
+			//////// TEMPORARY ///////
 
-			Renderer::GetInstance().Render(camera, Circle(transform, material));
+			packet.AddDraw(square);
+			packet.AddDraw(triangle);
+			packet.AddDraw(circle);
 
 			/////////////////////////
 
-			applicationFrame.Update();
+			renderThread.SubmitPacket();
 
-			const float postRenderTime = Time::GetSecondsSinceEpoch();
-			elapsedRenderTime = postRenderTime - preRenderTime;
-		}
+			// Evict the assets which haven't been used for a while if they're taking up more than the memory budget
+			AssetSystem::GetInstance().EndFrame();
+		});
+
+		renderThread.Stop();
+		FrameStats::GetInstance().Dump();
 	}
 	catch (std::exception& e)
 	{
@@ -133,14 +170,18 @@ int main()
 		else
 			LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::FATAL);
 
+		FrameStats::GetInstance().Dump(); // The frames leading up to the failure are often the ones of interest
+
 #ifdef _DEBUG
 		std::cin.get();
 #endif
 
+		JobSystem::GetInstance().Shutdown();
 		glfwTerminate();
 		return EXIT_FAILURE;
 	}
 
+	JobSystem::GetInstance().Shutdown();
 	glfwTerminate();
 	return EXIT_SUCCESS;
 }
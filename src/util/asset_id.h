@@ -0,0 +1,59 @@
+#ifndef ASSET_ID_H
+#define ASSET_ID_H
+
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Identifies an asset by the 64-bit FNV-1a hash of its name.
+// The hash is computed at compile time when the ID is created from a string literal using the _id suffix (e.g. "Geometry"_id),
+// so looking up an asset by its ID doesn't require any string allocation or hashing at runtime.
+class AssetID
+{
+private:
+	uint64_t m_hash;
+public:
+	constexpr AssetID() :
+		m_hash(0)
+	{}
+
+	constexpr explicit AssetID(std::string_view name) :
+		m_hash(AssetID::Hash(name))
+	{}
+
+	// Returns the hash of the asset name.
+	constexpr uint64_t GetHash() const
+	{
+		return m_hash;
+	}
+
+	constexpr bool operator==(const AssetID& other) const
+	{
+		return m_hash == other.m_hash;
+	}
+
+	constexpr bool operator!=(const AssetID& other) const
+	{
+		return m_hash != other.m_hash;
+	}
+
+	// Returns the 64-bit FNV-1a hash of the given string.
+	static constexpr uint64_t Hash(std::string_view str)
+	{
+		uint64_t hash = 0xCBF29CE484222325ull; // FNV offset basis
+		for (char character : str)
+		{
+			hash ^= (uint64_t)(uint8_t)character;
+			hash *= 0x100000001B3ull; // FNV prime
+		}
+
+		return hash;
+	}
+};
+
+constexpr AssetID operator""_id(const char* str, size_t length)
+{
+	return AssetID(std::string_view(str, length));
+}
+
+#endif
@@ -0,0 +1,206 @@
+#include <util/asset_pack.h>
+#include <util/asset_id.h>
+#include <util/formatted_exception.h>
+
+#include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+AssetPack::AssetPack(const std::string& filePath) :
+	m_filePath(filePath), m_data(nullptr), m_size(0), m_entries(nullptr), m_entryCount(0)
+#ifdef _PLATFORM_WINDOWS
+	, m_fileHandle(nullptr), m_mappingHandle(nullptr)
+#endif
+{
+#ifdef _PLATFORM_WINDOWS
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+	LARGE_INTEGER fileSize = {};
+	if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize))
+	{
+		if (fileHandle != INVALID_HANDLE_VALUE)
+			CloseHandle(fileHandle);
+
+		throw FormattedException("Failed to open the asset pack file at path: %s.", filePath.c_str());
+	}
+
+	m_fileHandle = fileHandle;
+	m_size = (size_t)fileSize.QuadPart;
+
+	if (m_size > 0)
+	{
+		m_mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mappingHandle)
+			m_data = (const uint8_t*)MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	const int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+
+	struct stat fileStatus = {};
+	if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStatus) != 0)
+	{
+		if (fileDescriptor >= 0)
+			close(fileDescriptor);
+
+		throw FormattedException("Failed to open the asset pack file at path: %s.", filePath.c_str());
+	}
+
+	m_size = (size_t)fileStatus.st_size;
+
+	if (m_size > 0)
+	{
+		void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mapping != MAP_FAILED)
+			m_data = (const uint8_t*)mapping;
+	}
+
+	close(fileDescriptor); // The mapping keeps the file open
+#endif
+
+	if (!m_data)
+	{
+		this->Unmap();
+		throw FormattedException("Failed to memory map the asset pack file at path: %s.", filePath.c_str());
+	}
+
+	try
+	{
+		this->ParseTableOfContents();
+	}
+	catch (...)
+	{
+		this->Unmap();
+		throw;
+	}
+}
+
+AssetPack::~AssetPack()
+{
+	this->Unmap();
+}
+
+void AssetPack::Unmap()
+{
+#ifdef _PLATFORM_WINDOWS
+	if (m_data)
+		UnmapViewOfFile(m_data);
+
+	if (m_mappingHandle)
+		CloseHandle(m_mappingHandle);
+
+	if (m_fileHandle)
+		CloseHandle(m_fileHandle);
+
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+#else
+	if (m_data)
+		munmap((void*)m_data, m_size);
+#endif
+
+	m_data = nullptr;
+	m_entries = nullptr;
+	m_entryCount = 0;
+}
+
+void AssetPack::ParseTableOfContents()
+{
+	Header header;
+	if (m_size < sizeof(Header))
+		throw FormattedException("The asset pack file at path: %s, is too small to hold a header.", m_filePath.c_str());
+
+	std::memcpy(&header, m_data, sizeof(Header));
+	if (std::memcmp(header.m_magic, AssetPack::fileMagic, sizeof(header.m_magic)) != 0 || header.m_version != AssetPack::fileVersion)
+		throw FormattedException("The file at path: %s, isn't an asset pack of a supported version.", m_filePath.c_str());
+
+	// The entries are read in place, so the table has to be aligned
+	if (header.m_tableOffset % alignof(Entry) != 0 || header.m_tableOffset > m_size ||
+		header.m_entryCount > (m_size - header.m_tableOffset) / sizeof(Entry))
+	{
+		throw FormattedException("The table of contents of the asset pack file at path: %s, is invalid.", m_filePath.c_str());
+	}
+
+	m_entries = (const Entry*)(m_data + header.m_tableOffset);
+	m_entryCount = header.m_entryCount;
+
+	for (uint64_t entryIndex = 0; entryIndex < m_entryCount; entryIndex++)
+	{
+		const Entry& entry = m_entries[entryIndex];
+
+		const bool sorted = entryIndex == 0 || m_entries[entryIndex - 1].m_pathHash < entry.m_pathHash;
+		const bool inBounds = entry.m_offset <= m_size && entry.m_size <= m_size - entry.m_offset;
+		const bool validCompression = entry.m_compression == Compression::NONE ? entry.m_size == entry.m_uncompressedSize :
+			entry.m_compression == Compression::ZLIB;
+
+		if (!sorted || !inBounds || !validCompression)
+		{
+			throw FormattedException("Entry %llu of the asset pack file at path: %s, is invalid.", (unsigned long long)entryIndex,
+				m_filePath.c_str());
+		}
+	}
+}
+
+const AssetPack::Entry* AssetPack::FindEntry(std::string_view path) const
+{
+	const uint64_t pathHash = AssetPack::HashPath(path);
+	const Entry* entriesEnd = m_entries + m_entryCount;
+
+	const Entry* entry = std::lower_bound(m_entries, entriesEnd, pathHash, [](const Entry& entry, uint64_t hash)
+		{ return entry.m_pathHash < hash; });
+
+	return entry != entriesEnd && entry->m_pathHash == pathHash ? entry : nullptr;
+}
+
+ByteView AssetPack::GetData(const Entry& entry, std::vector<uint8_t>& decompressedData) const
+{
+	if (entry.m_compression == Compression::NONE)
+		return { m_data + entry.m_offset, (size_t)entry.m_size };
+
+	decompressedData.resize((size_t)entry.m_uncompressedSize);
+	const int decompressedSize = stbi_zlib_decode_buffer((char*)decompressedData.data(), (int)decompressedData.size(),
+		(const char*)m_data + entry.m_offset, (int)entry.m_size);
+
+	if (decompressedSize < 0 || (uint64_t)decompressedSize != entry.m_uncompressedSize)
+	{
+		throw FormattedException("Failed to decompress the file with hash 0x%016llX in the asset pack file at path: %s.",
+			(unsigned long long)entry.m_pathHash, m_filePath.c_str());
+	}
+
+	return { decompressedData.data(), decompressedData.size() };
+}
+
+uint64_t AssetPack::GetEntryCount() const
+{
+	return m_entryCount;
+}
+
+const std::string& AssetPack::GetFilePath() const
+{
+	return m_filePath;
+}
+
+std::string AssetPack::NormalizePath(std::string_view path)
+{
+	std::string normalizedPath(path);
+	std::replace(normalizedPath.begin(), normalizedPath.end(), '\\', '/');
+
+	while (normalizedPath.compare(0, 2, "./") == 0)
+		normalizedPath.erase(0, 2);
+
+	return normalizedPath;
+}
+
+uint64_t AssetPack::HashPath(std::string_view path)
+{
+	return AssetID::Hash(AssetPack::NormalizePath(path));
+}
@@ -0,0 +1,107 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// A read-only view of a range of bytes, which doesn't own them.
+struct ByteView
+{
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+
+	// Returns TRUE if the view doesn't contain any bytes.
+	bool IsEmpty() const
+	{
+		return m_size == 0;
+	}
+
+	// Returns the bytes as a string, which isn't null terminated.
+	std::string_view AsString() const
+	{
+		return std::string_view((const char*)m_data, m_size);
+	}
+};
+
+// A single archive (.mpak) holding the files of many assets, which is memory mapped so that its files can be read without being
+// opened or copied. The archive starts with a header, followed by the file data and then a table of contents holding an entry
+// for each file, sorted by the hashes of their paths so that files are found with a binary search.
+// Files can optionally be stored zlib compressed, in which case they are decompressed when read.
+class AssetPack
+{
+public:
+	enum class Compression : uint32_t { NONE, ZLIB };
+
+	// The header at the start of a pack file.
+	struct Header
+	{
+		char m_magic[4];
+		uint32_t m_version;
+		uint64_t m_entryCount;
+		uint64_t m_tableOffset; // The offset of the table of contents from the start of the file, a multiple of 8
+	};
+
+	// An entry in the table of contents of a pack file.
+	struct Entry
+	{
+		uint64_t m_pathHash; // The hash of the file's normalized path, see NormalizePath()
+		uint64_t m_offset, m_size; // The location of the file's (possibly compressed) data from the start of the pack file
+		uint64_t m_uncompressedSize;
+		Compression m_compression;
+		uint32_t m_reserved;
+	};
+
+	static constexpr char fileMagic[4] = { 'M', 'P', 'A', 'K' };
+	static constexpr uint32_t fileVersion = 1;
+	static constexpr uint64_t dataAlignment = 16; // The alignment of each file's data from the start of the pack file
+private:
+	std::string m_filePath;
+	const uint8_t* m_data;
+	size_t m_size;
+
+	const Entry* m_entries;
+	uint64_t m_entryCount;
+
+#ifdef _PLATFORM_WINDOWS
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#endif
+
+	// Unmaps the pack file.
+	void Unmap();
+
+	// Checks that the header and table of contents of the mapped file are valid, then points the entries at the table.
+	void ParseTableOfContents();
+public:
+	// Memory maps the pack file at the given path, and reads its table of contents.
+	explicit AssetPack(const std::string& filePath);
+	AssetPack(const AssetPack& other) = delete;
+
+	~AssetPack();
+
+	AssetPack& operator=(const AssetPack& other) = delete;
+
+	// Returns the entry of the file with the given path, or nullptr if the pack doesn't contain the file.
+	const Entry* FindEntry(std::string_view path) const;
+
+	// Returns a view of the file's data in the mapped pack file.
+	// If the file is compressed, it's decompressed into the buffer given and a view of the buffer is returned instead.
+	ByteView GetData(const Entry& entry, std::vector<uint8_t>& decompressedData) const;
+
+	// Returns the number of files in the pack.
+	uint64_t GetEntryCount() const;
+
+	// Returns the path of the pack file.
+	const std::string& GetFilePath() const;
+
+	// Returns the path in the form used to hash it, with forward slashes as separators and without a leading "./".
+	static std::string NormalizePath(std::string_view path);
+
+	// Returns the hash of the normalized form of the path.
+	static uint64_t HashPath(std::string_view path);
+};
+
+#endif
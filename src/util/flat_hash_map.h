@@ -0,0 +1,62 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// An open addressing hash map with 64-bit keys, which are expected to already be well distributed hashes (e.g. an AssetID).
+// All the entries are stored in a single contiguous array and collisions are resolved by linear probing, so lookups 
+// don't chase pointers the way std::unordered_map does.
+// Note that inserting or erasing an entry may move other entries, invalidating any pointers to their values.
+template<typename Value>
+class FlatHashMap
+{
+private:
+	struct Slot
+	{
+		uint64_t m_key = 0;
+		Value m_value = Value();
+		bool m_occupied = false;
+	};
+
+	std::vector<Slot> m_slots;
+	size_t m_size;
+
+	// Returns the index of the slot which holds the given key, or of the empty slot where the key would be inserted.
+	size_t FindSlot(uint64_t key) const;
+
+	// Doubles the number of slots and re-inserts all the entries.
+	void Grow();
+public:
+	FlatHashMap();
+	~FlatHashMap() = default;
+
+	// Inserts the value with the given key.
+	// Returns FALSE, without modifying the map, if an entry with the key already exists.
+	bool Insert(uint64_t key, const Value& value);
+
+	// Removes the entry with the given key.
+	// Returns FALSE if no entry with the key exists.
+	bool Erase(uint64_t key);
+
+	// Removes all the entries in the map.
+	void Clear();
+
+	// Returns a pointer to the value of the entry with the given key, or nullptr if there is no such entry.
+	Value* Find(uint64_t key);
+	const Value* Find(uint64_t key) const;
+
+	// Calls the given function with the key and value of every entry in the map.
+	// The map must not be modified while iterating over it.
+	template<typename Function>
+	void ForEach(Function function) const;
+
+	// Returns the number of entries in the map.
+	size_t GetSize() const;
+};
+
+#include <util/flat_hash_map.tpp>
+
+#endif
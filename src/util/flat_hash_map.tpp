@@ -0,0 +1,124 @@
+namespace FlatHashMapParams
+{
+    constexpr size_t initialCapacity = 16; // Must be a power of two
+    constexpr size_t maxLoadPercentage = 70;
+}
+
+template<typename Value>
+FlatHashMap<Value>::FlatHashMap() :
+    m_slots(FlatHashMapParams::initialCapacity), m_size(0)
+{}
+
+template<typename Value>
+size_t FlatHashMap<Value>::FindSlot(uint64_t key) const
+{
+    // The capacity is always a power of two, so the key can be wrapped into the slot range with a mask
+    const size_t mask = m_slots.size() - 1;
+    size_t index = (size_t)key & mask;
+
+    while (m_slots[index].m_occupied && m_slots[index].m_key != key)
+        index = (index + 1) & mask;
+
+    return index;
+}
+
+template<typename Value>
+void FlatHashMap<Value>::Grow()
+{
+    std::vector<Slot> previousSlots(m_slots.size() * 2);
+    previousSlots.swap(m_slots);
+
+    for (Slot& slot : previousSlots)
+    {
+        if (slot.m_occupied)
+            m_slots[this->FindSlot(slot.m_key)] = std::move(slot);
+    }
+}
+
+template<typename Value>
+bool FlatHashMap<Value>::Insert(uint64_t key, const Value& value)
+{
+    if ((m_size + 1) * 100 > m_slots.size() * FlatHashMapParams::maxLoadPercentage)
+        this->Grow();
+
+    Slot& slot = m_slots[this->FindSlot(key)];
+    if (slot.m_occupied)
+        return false;
+
+    slot.m_key = key;
+    slot.m_value = value;
+    slot.m_occupied = true;
+    ++m_size;
+
+    return true;
+}
+
+template<typename Value>
+bool FlatHashMap<Value>::Erase(uint64_t key)
+{
+    const size_t mask = m_slots.size() - 1;
+    size_t emptyIndex = this->FindSlot(key);
+
+    if (!m_slots[emptyIndex].m_occupied)
+        return false;
+
+    // Shift back any following entries in the same probe run which would no longer be reachable with the slot emptied
+    // This avoids the need for tombstone markers
+    for (size_t index = (emptyIndex + 1) & mask; m_slots[index].m_occupied; index = (index + 1) & mask)
+    {
+        const size_t idealIndex = (size_t)m_slots[index].m_key & mask;
+        const bool canMove = (emptyIndex <= index) ? (idealIndex <= emptyIndex || idealIndex > index) : 
+            (idealIndex <= emptyIndex && idealIndex > index);
+
+        if (canMove)
+        {
+            m_slots[emptyIndex] = std::move(m_slots[index]);
+            emptyIndex = index;
+        }
+    }
+
+    m_slots[emptyIndex] = Slot();
+    --m_size;
+
+    return true;
+}
+
+template<typename Value>
+void FlatHashMap<Value>::Clear()
+{
+    for (Slot& slot : m_slots)
+        slot = Slot();
+
+    m_size = 0;
+}
+
+template<typename Value>
+Value* FlatHashMap<Value>::Find(uint64_t key)
+{
+    Slot& slot = m_slots[this->FindSlot(key)];
+    return slot.m_occupied ? &slot.m_value : nullptr;
+}
+
+template<typename Value>
+const Value* FlatHashMap<Value>::Find(uint64_t key) const
+{
+    const Slot& slot = m_slots[this->FindSlot(key)];
+    return slot.m_occupied ? &slot.m_value : nullptr;
+}
+
+template<typename Value>
+template<typename Function>
+void FlatHashMap<Value>::ForEach(Function function) const
+{
+    for (const Slot& slot : m_slots)
+    {
+        if (slot.m_occupied)
+            function(slot.m_key, slot.m_value);
+    }
+}
+
+template<typename Value>
+size_t FlatHashMap<Value>::GetSize() const
+{
+    return m_size;
+}
@@ -0,0 +1,254 @@
+#include <util/frame_stats.h>
+#include <util/logging_system.h>
+#include <util/time.h>
+
+#include <algorithm>
+
+namespace FrameStatsParams
+{
+    // The number of most recent frames which the percentiles are computed over.
+    constexpr size_t windowFrameCount = 3600;
+
+    // The number of most recent hitches which are kept for querying.
+    constexpr size_t recentHitchCapacity = 32;
+
+    // The frame budget used until another is set, which is a 60 Hz frame.
+    constexpr uint64_t defaultFrameBudgetNanoseconds = 16666667;
+
+    // The number of frames after a frame ends that it's attributed, since handing over the packet of a frame only waits for 
+    // the render thread to take the previous packet, by which point it has finished rendering the one before that.
+    constexpr uint64_t attributionDelayFrameCount = 2;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+FrameStats::FrameStats() :
+    m_frameBudgetNanoseconds(FrameStatsParams::defaultFrameBudgetNanoseconds), m_frameCount(0), m_windowPosition(0), 
+    m_histogram(FrameStats::histogramBucketCount, 0), m_recentHitchPosition(0), m_totalHitchCount(0), m_longestFrameNanoseconds(0)
+{
+    for (FrameRecord& record : m_frameRecords)
+    {
+        record.m_frameIndex.store(FrameStats::currentFrameIndex, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& subsystemNanoseconds : record.m_subsystemNanoseconds)
+            subsystemNanoseconds.store(0, std::memory_order_relaxed);
+
+        record.m_durationNanoseconds = 0;
+        record.m_endTimestampNanoseconds = 0;
+    }
+
+    m_windowDurations.reserve(FrameStatsParams::windowFrameCount);
+    m_recentHitches.reserve(FrameStatsParams::recentHitchCapacity);
+    m_hitchCounts.fill(0);
+}
+
+double FrameStats::ComputePercentile(double percentile) const
+{
+    if (m_windowDurations.empty())
+        return 0.0;
+
+    // Walk the histogram until the bucket holding the percentile is reached, then report the upper edge of that bucket
+    const uint64_t targetCount = std::max<uint64_t>(1, (uint64_t)(percentile * m_windowDurations.size() + 0.5));
+    uint64_t runningCount = 0;
+
+    for (size_t bucketIndex = 0; bucketIndex < FrameStats::histogramBucketCount - 1; bucketIndex++)
+    {
+        runningCount += m_histogram[bucketIndex];
+        if (runningCount >= targetCount)
+            return (double)((bucketIndex + 1) * FrameStats::histogramBucketNanoseconds) / 1e6;
+    }
+
+    // The percentile is in the overflow bucket, so the longest frame in the window is the closest bound available
+    return (double)*std::max_element(m_windowDurations.begin(), m_windowDurations.end()) / 1e6;
+}
+
+void FrameStats::AttributeFrame(uint64_t frameNumber)
+{
+    FrameRecord& record = m_frameRecords[frameNumber % FrameStats::frameRecordCount];
+
+    std::array<uint64_t, (size_t)Subsystem::COUNT> subsystemNanoseconds;
+    for (size_t subsystemIndex = 0; subsystemIndex < subsystemNanoseconds.size(); subsystemIndex++)
+        subsystemNanoseconds[subsystemIndex] = record.m_subsystemNanoseconds[subsystemIndex].exchange(0, std::memory_order_relaxed);
+
+    record.m_frameIndex.store(FrameStats::currentFrameIndex, std::memory_order_relaxed);
+
+    // Attribute the hitch to the subsystem which took the most time during the frame
+    if (record.m_durationNanoseconds > m_frameBudgetNanoseconds)
+    {
+        Hitch hitch;
+        hitch.m_frameIndex = frameNumber;
+        hitch.m_timestampNanoseconds = record.m_endTimestampNanoseconds;
+        hitch.m_durationNanoseconds = record.m_durationNanoseconds;
+        hitch.m_subsystem = (Subsystem)(std::max_element(subsystemNanoseconds.begin(), subsystemNanoseconds.end()) - 
+            subsystemNanoseconds.begin());
+        hitch.m_subsystemNanoseconds = subsystemNanoseconds;
+
+        if (m_recentHitches.size() < FrameStatsParams::recentHitchCapacity)
+            m_recentHitches.push_back(hitch);
+        else
+            m_recentHitches[m_recentHitchPosition] = hitch;
+
+        m_recentHitchPosition = (m_recentHitchPosition + 1) % FrameStatsParams::recentHitchCapacity;
+        ++m_hitchCounts[(size_t)hitch.m_subsystem];
+        ++m_totalHitchCount;
+    }
+}
+
+void FrameStats::SetFrameBudget(double seconds)
+{
+    m_frameBudgetNanoseconds = (uint64_t)(seconds * 1e9);
+}
+
+void FrameStats::RecordSubsystemTime(Subsystem subsystem, uint64_t nanoseconds, uint64_t frameIndex)
+{
+    // Frames are only attributed once the render thread is done with them, so a frame still tagged with the index is the one 
+    // it belongs to
+    FrameRecord* frameRecord = &m_frameRecords[m_frameCount.load(std::memory_order_relaxed) % FrameStats::frameRecordCount];
+    if (frameIndex != FrameStats::currentFrameIndex)
+    {
+        for (FrameRecord& record : m_frameRecords)
+        {
+            if (record.m_frameIndex.load(std::memory_order_relaxed) == frameIndex)
+                frameRecord = &record;
+        }
+    }
+
+    frameRecord->m_subsystemNanoseconds[(size_t)subsystem].fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void FrameStats::SetFrameIndex(uint64_t frameIndex)
+{
+    m_frameRecords[m_frameCount.load(std::memory_order_relaxed) % FrameStats::frameRecordCount].m_frameIndex.store(frameIndex,
+        std::memory_order_relaxed);
+}
+
+void FrameStats::EndFrame(uint64_t frameNanoseconds)
+{
+    static_assert(FrameStatsParams::attributionDelayFrameCount + 1 < FrameStats::frameRecordCount, 
+        "The records of the frames waiting to be attributed mustn't be reused by the current frame.");
+
+    const uint64_t frameNumber = m_frameCount.load(std::memory_order_relaxed);
+    FrameRecord& record = m_frameRecords[frameNumber % FrameStats::frameRecordCount];
+    record.m_durationNanoseconds = frameNanoseconds;
+    record.m_endTimestampNanoseconds = Time::GetNanosecondsSinceEpoch();
+
+    // Add the frame to the rolling window, replacing the oldest frame once the window is full
+    const size_t bucketIndex = std::min<size_t>(frameNanoseconds / FrameStats::histogramBucketNanoseconds, 
+        FrameStats::histogramBucketCount - 1);
+
+    if (m_windowDurations.size() < FrameStatsParams::windowFrameCount)
+        m_windowDurations.push_back(frameNanoseconds);
+    else
+    {
+        const size_t oldBucketIndex = std::min<size_t>(m_windowDurations[m_windowPosition] / FrameStats::histogramBucketNanoseconds,
+            FrameStats::histogramBucketCount - 1);
+
+        --m_histogram[oldBucketIndex];
+        m_windowDurations[m_windowPosition] = frameNanoseconds;
+    }
+
+    m_windowPosition = (m_windowPosition + 1) % FrameStatsParams::windowFrameCount;
+    ++m_histogram[bucketIndex];
+
+    m_longestFrameNanoseconds = std::max(m_longestFrameNanoseconds, frameNanoseconds);
+
+    if (frameNumber >= FrameStatsParams::attributionDelayFrameCount)
+        this->AttributeFrame(frameNumber - FrameStatsParams::attributionDelayFrameCount);
+
+    m_frameCount.store(frameNumber + 1, std::memory_order_relaxed);
+}
+
+FrameStats::Summary FrameStats::GetSummary() const
+{
+    Summary summary;
+    summary.m_frameCount = (uint32_t)m_windowDurations.size();
+    summary.m_p50Milliseconds = this->ComputePercentile(0.50);
+    summary.m_p95Milliseconds = this->ComputePercentile(0.95);
+    summary.m_p99Milliseconds = this->ComputePercentile(0.99);
+    summary.m_maxMilliseconds = m_windowDurations.empty() ? 0.0 : 
+        (double)*std::max_element(m_windowDurations.begin(), m_windowDurations.end()) / 1e6;
+
+    return summary;
+}
+
+std::vector<FrameStats::Hitch> FrameStats::GetRecentHitches() const
+{
+    // Once the ring is full, the oldest hitch is the one which will be replaced next
+    std::vector<Hitch> hitches;
+    hitches.reserve(m_recentHitches.size());
+
+    const size_t oldestPosition = m_recentHitches.size() < FrameStatsParams::recentHitchCapacity ? 0 : m_recentHitchPosition;
+    for (size_t offset = 0; offset < m_recentHitches.size(); offset++)
+        hitches.push_back(m_recentHitches[(oldestPosition + offset) % m_recentHitches.size()]);
+
+    return hitches;
+}
+
+uint64_t FrameStats::GetHitchCount(Subsystem subsystem) const
+{
+    return m_hitchCounts[(size_t)subsystem];
+}
+
+uint64_t FrameStats::GetFrameCount() const
+{
+    return m_frameCount.load(std::memory_order_relaxed);
+}
+
+void FrameStats::Dump() const
+{
+    const Summary summary = this->GetSummary();
+
+    LOG_INFO("Frame stats: %llu frames, %llu hitches over %.2f ms, longest frame %.2f ms.", (unsigned long long)this->GetFrameCount(), 
+        (unsigned long long)m_totalHitchCount, (double)m_frameBudgetNanoseconds / 1e6, (double)m_longestFrameNanoseconds / 1e6);
+
+    LOG_INFO("Frame stats (last %u frames): p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms.", summary.m_frameCount, 
+        summary.m_p50Milliseconds, summary.m_p95Milliseconds, summary.m_p99Milliseconds, summary.m_maxMilliseconds);
+
+    for (size_t subsystemIndex = 0; subsystemIndex < (size_t)Subsystem::COUNT; subsystemIndex++)
+    {
+        LOG_INFO("Hitches caused by %s: %llu", FrameStats::GetSubsystemName((Subsystem)subsystemIndex), 
+            (unsigned long long)m_hitchCounts[subsystemIndex]);
+    }
+
+    for (const Hitch& hitch : this->GetRecentHitches())
+    {
+        LOG_INFO("Hitch at frame %llu (%.3f s): %.2f ms, %s took %.2f ms.", (unsigned long long)hitch.m_frameIndex, 
+            (double)hitch.m_timestampNanoseconds / 1e9, (double)hitch.m_durationNanoseconds / 1e6, 
+            FrameStats::GetSubsystemName(hitch.m_subsystem), (double)hitch.m_subsystemNanoseconds[(size_t)hitch.m_subsystem] / 1e6);
+    }
+}
+
+const char* FrameStats::GetSubsystemName(Subsystem subsystem)
+{
+    switch (subsystem)
+    {
+    case Subsystem::INPUT:
+        return "input";
+    case Subsystem::SIMULATION:
+        return "simulation";
+    case Subsystem::ASSET_LOAD:
+        return "asset loading";
+    case Subsystem::RENDER:
+        return "rendering";
+    case Subsystem::SWAP:
+        return "buffer swapping";
+    default:
+        return "unknown";
+    }
+}
+
+FrameStats& FrameStats::GetInstance()
+{
+    static FrameStats instance;
+    return instance;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SubsystemTimer::SubsystemTimer(FrameStats::Subsystem subsystem, uint64_t frameIndex) :
+    m_subsystem(subsystem), m_frameIndex(frameIndex), m_startNanoseconds(Time::GetNanosecondsSinceEpoch())
+{}
+
+SubsystemTimer::~SubsystemTimer()
+{
+    FrameStats::GetInstance().RecordSubsystemTime(m_subsystem, Time::GetNanosecondsSinceEpoch() - m_startNanoseconds, m_frameIndex);
+}
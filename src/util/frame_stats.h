@@ -0,0 +1,144 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Collects frame time statistics over a rolling window of recent frames, and attributes frames which go over the frame budget
+// (hitches) to the subsystem which took the most time during them.
+// Subsystem time can be recorded from any thread, all other functions must be called from the thread which ends the frames.
+// Time recorded on the render thread is added to the frame its packet was recorded during, so a frame's hitch is only
+// attributed once the render thread is done with it, a couple of frames after it ends.
+class FrameStats
+{
+public:
+	// Passed instead of a frame index to add time to the current frame.
+	static constexpr uint64_t currentFrameIndex = UINT64_MAX;
+
+	// The instrumented subsystems which hitches can be attributed to.
+	enum class Subsystem : uint32_t
+	{
+		INPUT,
+		SIMULATION,
+		ASSET_LOAD,
+		RENDER,
+		SWAP,
+		COUNT
+	};
+
+	// The frame time percentiles over the rolling window, in milliseconds.
+	struct Summary
+	{
+		uint32_t m_frameCount; // The number of frames in the window
+		double m_p50Milliseconds, m_p95Milliseconds, m_p99Milliseconds, m_maxMilliseconds;
+	};
+
+	// A frame which went over the frame budget.
+	struct Hitch
+	{
+		uint64_t m_frameIndex;
+		uint64_t m_timestampNanoseconds; // When the frame ended, from Time::GetNanosecondsSinceEpoch()
+		uint64_t m_durationNanoseconds;
+		Subsystem m_subsystem; // The subsystem which took the most time during the frame
+		std::array<uint64_t, (size_t)Subsystem::COUNT> m_subsystemNanoseconds;
+	};
+private:
+	// The frame durations are counted in fixed width buckets, frames longer than the last bucket are counted in it
+	static constexpr uint64_t histogramBucketNanoseconds = 100000;
+	static constexpr size_t histogramBucketCount = 1000;
+
+	// The number of frames whose time is still being recorded, the current one and those still being rendered
+	static constexpr size_t frameRecordCount = 4;
+
+	// The time recorded for a frame, reused for every frameRecordCount-th frame
+	struct FrameRecord
+	{
+		std::atomic<uint64_t> m_frameIndex; // The index of the frame packet recorded during the frame, if one was
+		std::array<std::atomic<uint64_t>, (size_t)Subsystem::COUNT> m_subsystemNanoseconds;
+		uint64_t m_durationNanoseconds, m_endTimestampNanoseconds; // Only accessed by the thread which ends the frames
+	};
+
+	std::array<FrameRecord, frameRecordCount> m_frameRecords;
+
+	uint64_t m_frameBudgetNanoseconds;
+	std::atomic<uint64_t> m_frameCount; // The number of frames which have ended, which is also the number of the current frame
+
+	// The durations of the frames in the rolling window, along with a histogram of them
+	std::vector<uint64_t> m_windowDurations;
+	size_t m_windowPosition;
+	std::vector<uint32_t> m_histogram;
+
+	std::vector<Hitch> m_recentHitches; // A ring of the most recent hitches
+	size_t m_recentHitchPosition;
+	std::array<uint64_t, (size_t)Subsystem::COUNT> m_hitchCounts;
+	uint64_t m_totalHitchCount, m_longestFrameNanoseconds;
+
+	FrameStats();
+
+	// Returns the duration at the given percentile (between 0 and 1) of the frames in the rolling window, in milliseconds.
+	double ComputePercentile(double percentile) const;
+
+	// Records the ended frame with the given number as a hitch if it went over budget, then clears its record for reuse.
+	void AttributeFrame(uint64_t frameNumber);
+public:
+	~FrameStats() = default;
+
+	// Sets the frame duration above which a frame counts as a hitch.
+	void SetFrameBudget(double seconds);
+
+	// Adds the given time to the subsystem's time for the frame whose packet has the given frame index, or for the current 
+	// frame if it's currentFrameIndex or the frame's no longer being recorded.
+	// This can be called from any thread.
+	void RecordSubsystemTime(Subsystem subsystem, uint64_t nanoseconds, uint64_t frameIndex = currentFrameIndex);
+
+	// Tags the current frame with the index of the frame packet recorded during it, so that time recorded while the packet is
+	// rendered is added to it.
+	void SetFrameIndex(uint64_t frameIndex);
+
+	// Records the duration of the frame which just ended and starts a new one.
+	// Once the render thread is done with it, a frame which went over budget is recorded as a hitch against the subsystem which 
+	// took the most time.
+	void EndFrame(uint64_t frameNanoseconds);
+
+	// Returns the frame time percentiles over the rolling window of recent frames.
+	Summary GetSummary() const;
+
+	// Returns the most recent hitches, from oldest to newest.
+	std::vector<Hitch> GetRecentHitches() const;
+
+	// Returns the number of hitches attributed to the given subsystem since startup.
+	uint64_t GetHitchCount(Subsystem subsystem) const;
+
+	// Returns the number of frames recorded since startup.
+	uint64_t GetFrameCount() const;
+
+	// Writes the frame time percentiles, the hitch counts of each subsystem and the most recent hitches to the log.
+	void Dump() const;
+
+	// Returns the name of the given subsystem.
+	static const char* GetSubsystemName(Subsystem subsystem);
+
+	// Returns singleton instance of the class.
+	static FrameStats& GetInstance();
+};
+
+// Adds the time taken until the end of the scope to a subsystem's frame time.
+class SubsystemTimer
+{
+private:
+	FrameStats::Subsystem m_subsystem;
+	uint64_t m_frameIndex;
+	uint64_t m_startNanoseconds;
+public:
+	explicit SubsystemTimer(FrameStats::Subsystem subsystem, uint64_t frameIndex = FrameStats::currentFrameIndex);
+	SubsystemTimer(const SubsystemTimer& other) = delete;
+
+	~SubsystemTimer();
+
+	SubsystemTimer& operator=(const SubsystemTimer& other) = delete;
+};
+
+#endif
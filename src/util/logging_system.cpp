@@ -2,64 +2,622 @@
 #include <util/formatted_exception.h>
 #include <util/time.h>
 
-#include <iostream>
-#include <ctime>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _PLATFORM_WINDOWS
 #include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
-LoggingSystem::LoggingSystem()
+namespace Logging
+{
+	// The number of records each thread can have waiting to be written before logging on the thread has to wait.
+	constexpr size_t threadRingCapacity = 1024;
+
+	// The longest time the writer thread sleeps for before checking the rings for new records.
+	constexpr std::chrono::milliseconds writerSleepDuration(2);
+
+	// The kind of value a format specifier reads from the arguments.
+	enum class ArgumentType { SIGNED_INTEGER, UNSIGNED_INTEGER, DOUBLE, LONG_DOUBLE, STRING, POINTER, UNSUPPORTED };
+
+	// A format specifier, parsed from the '%' up to and including its conversion character.
+	struct FormatSpecifier
+	{
+		const char* m_begin;
+		size_t m_flagsLength; // The length of the flags, width and precision following the '%'
+		char m_lengthModifier[3];
+		char m_conversion;
+		uint32_t m_starCount; // The number of '*' widths and precisions, which each read an int from the arguments
+		ArgumentType m_type;
+	};
+
+	// Parses the format specifier starting at the '%' given, and returns a pointer past the end of it.
+	static const char* ParseSpecifier(const char* begin, FormatSpecifier& specifier)
+	{
+		specifier = { begin, 0, { 0, 0, 0 }, 0, 0, ArgumentType::UNSUPPORTED };
+
+		const char* character = begin + 1;
+		while (*character && std::strchr("-+ #0123456789.*", *character))
+		{
+			if (*character == '*')
+				++specifier.m_starCount;
+
+			++character;
+		}
+
+		specifier.m_flagsLength = character - (begin + 1);
+
+		size_t modifierLength = 0;
+		while (*character && std::strchr("hljztL", *character) && modifierLength < 2)
+			specifier.m_lengthModifier[modifierLength++] = *character++;
+
+		specifier.m_conversion = *character;
+		switch (specifier.m_conversion)
+		{
+		case 'd': case 'i': case 'c':
+			specifier.m_type = ArgumentType::SIGNED_INTEGER;
+			break;
+		case 'u': case 'o': case 'x': case 'X':
+			specifier.m_type = ArgumentType::UNSIGNED_INTEGER;
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			specifier.m_type = specifier.m_lengthModifier[0] == 'L' ? ArgumentType::LONG_DOUBLE : ArgumentType::DOUBLE;
+			break;
+		case 's':
+			specifier.m_type = specifier.m_lengthModifier[0] ? ArgumentType::UNSUPPORTED : ArgumentType::STRING; // No wide strings
+			break;
+		case 'p':
+			specifier.m_type = ArgumentType::POINTER;
+			break;
+		default:
+			break;
+		}
+
+		return *character ? character + 1 : character;
+	}
+
+	// Reads a signed integer argument of the size given by the length modifier.
+	static int64_t ReadSignedArgument(const char* modifier, va_list& args)
+	{
+		if (std::strcmp(modifier, "hh") == 0)
+			return (signed char)va_arg(args, int);
+		else if (std::strcmp(modifier, "h") == 0)
+			return (short)va_arg(args, int);
+		else if (std::strcmp(modifier, "l") == 0)
+			return va_arg(args, long);
+		else if (std::strcmp(modifier, "ll") == 0)
+			return va_arg(args, long long);
+		else if (std::strcmp(modifier, "j") == 0)
+			return va_arg(args, intmax_t);
+		else if (std::strcmp(modifier, "z") == 0 || std::strcmp(modifier, "t") == 0)
+			return va_arg(args, ptrdiff_t);
+
+		return va_arg(args, int);
+	}
+
+	// Reads an unsigned integer argument of the size given by the length modifier.
+	static uint64_t ReadUnsignedArgument(const char* modifier, va_list& args)
+	{
+		if (std::strcmp(modifier, "hh") == 0)
+			return (unsigned char)va_arg(args, unsigned int);
+		else if (std::strcmp(modifier, "h") == 0)
+			return (unsigned short)va_arg(args, unsigned int);
+		else if (std::strcmp(modifier, "l") == 0)
+			return va_arg(args, unsigned long);
+		else if (std::strcmp(modifier, "ll") == 0)
+			return va_arg(args, unsigned long long);
+		else if (std::strcmp(modifier, "j") == 0)
+			return va_arg(args, uintmax_t);
+		else if (std::strcmp(modifier, "z") == 0 || std::strcmp(modifier, "t") == 0)
+			return va_arg(args, size_t);
+
+		return va_arg(args, unsigned int);
+	}
+
+	// Appends the value formatted with the given format specifier to the output.
+	template<typename T>
+	static void AppendFormatted(std::string& output, const char* format, const int* stars, uint32_t starCount, T value)
+	{
+		char buffer[256];
+		const auto formatInto = [&](char* destination, size_t size)
+		{
+			if (starCount == 0)
+				return std::snprintf(destination, size, format, value);
+			else if (starCount == 1)
+				return std::snprintf(destination, size, format, stars[0], value);
+
+			return std::snprintf(destination, size, format, stars[0], stars[1], value);
+		};
+
+		const int length = formatInto(buffer, sizeof(buffer));
+		if (length < 0)
+			return;
+
+		if ((size_t)length < sizeof(buffer))
+			output.append(buffer, length);
+		else
+		{
+			const size_t offset = output.size();
+			output.resize(offset + length + 1);
+			formatInto(&output[offset], length + 1);
+			output.pop_back(); // Remove the null terminator
+		}
+	}
+
+	// Returns the text written before messages of the given severity.
+	static const char* GetSeverityLabel(LoggingSystem::Severity severity)
+	{
+		switch (severity)
+		{
+		case LoggingSystem::Severity::INFO:
+			return " INFO -> ";
+		case LoggingSystem::Severity::WARNING:
+			return " WARNING -> ";
+		default:
+			return " ERROR -> ";
+		}
+	}
+
+	// Returns the ANSI escape code which sets the console color used for messages of the given severity.
+	static const char* GetSeverityColor(LoggingSystem::Severity severity)
+	{
+		switch (severity)
+		{
+		case LoggingSystem::Severity::INFO:
+			return "\x1b[97m"; // White
+		case LoggingSystem::Severity::WARNING:
+			return "\x1b[93m"; // Yellow
+		default:
+			return "\x1b[91m"; // Red
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LoggingSystem::LoggingSystem() :
+	m_outputStream(nullptr), m_colorOutput(false), m_running(true), m_requestedFlushCount(0), m_completedFlushCount(0),
+	m_cachedTimestampSecond(UINT64_MAX)
 {
 #ifndef _DEBUG
-	fopen_s(&m_logFileStream, "runtime_log.txt", "w"); // Open the logging file
+	// Open the logging file
+#ifdef _PLATFORM_WINDOWS
+	fopen_s(&m_outputStream, "runtime_log.txt", "w");
+#else
+	m_outputStream = std::fopen("runtime_log.txt", "w");
+#endif
+#else
+	m_outputStream = stdout;
+
+	// Colors are set using ANSI escape codes, which Windows consoles only support once enabled
+#ifdef _PLATFORM_WINDOWS
+	HANDLE consoleOut = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD consoleMode = 0;
+	m_colorOutput = GetConsoleMode(consoleOut, &consoleMode) &&
+		SetConsoleMode(consoleOut, consoleMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
 #else
-	m_consoleOut = GetStdHandle(STD_OUTPUT_HANDLE); // Get console output handle
+	m_colorOutput = isatty(fileno(stdout));
+#endif
 #endif
+
+	m_writerThread = std::thread(&LoggingSystem::WriterMain, this);
 }
 
 LoggingSystem::~LoggingSystem()
 {
+	{
+		std::lock_guard<std::mutex> lock(m_writerMutex);
+		m_running.store(false);
+	}
+
+	m_writerCondition.notify_one();
+	m_writerThread.join(); // The writer thread writes any remaining records before it stops
+
 #ifndef _DEBUG
-	fclose(m_logFileStream);
-	m_logFileStream = nullptr;
+	if (m_outputStream)
+		std::fclose(m_outputStream);
 #endif
+
+	m_outputStream = nullptr;
 }
 
-void LoggingSystem::Output(std::string_view str, Severity severity, va_list args)
+LoggingSystem::ThreadRing::ThreadRing() :
+	m_records(Logging::threadRingCapacity), m_abandoned(false)
+{}
+
+LoggingSystem::ThreadRingOwner::~ThreadRingOwner()
 {
-#ifndef _DEBUG
-	if (m_logFileStream)
+	// The ring is shared with the logging system, so it stays alive even if the logging system is destroyed first
+	if (m_ring)
+		m_ring->m_abandoned.store(true, std::memory_order_release);
+}
+
+SPSCRingBuffer<LoggingSystem::Record>& LoggingSystem::GetThreadRing()
+{
+	thread_local ThreadRingOwner threadRingOwner;
+	if (!threadRingOwner.m_ring)
 	{
-		// Output the log to the runtime logging file
-		switch (severity)
+		std::lock_guard<std::mutex> lock(m_threadRingsMutex);
+		m_threadRings.push_back(std::make_shared<ThreadRing>());
+		threadRingOwner.m_ring = m_threadRings.back();
+	}
+
+	return threadRingOwner.m_ring->m_records;
+}
+
+void LoggingSystem::PushRecord(const Record& record)
+{
+	SPSCRingBuffer<Record>& threadRing = this->GetThreadRing();
+	while (!threadRing.TryPush(record))
+	{
+		// Wake the writer thread up early to make space, rather than waiting for it to check the rings again
+		m_writerCondition.notify_one();
+		std::this_thread::yield();
+	}
+}
+
+bool LoggingSystem::PackArguments(const char* format, va_list args, uint8_t* payload, uint32_t& payloadSize)
+{
+	va_list remainingArgs;
+	va_copy(remainingArgs, args);
+
+	const auto packValue = [&](const void* value, size_t size)
+	{
+		if (payloadSize + size > LoggingSystem::recordPayloadCapacity)
+			return false;
+
+		std::memcpy(payload + payloadSize, value, size);
+		payloadSize += (uint32_t)size;
+		return true;
+	};
+
+	bool packed = true;
+	const char* character = format;
+	while (packed && *character)
+	{
+		if (*character != '%')
+		{
+			++character;
+			continue;
+		}
+
+		if (character[1] == '%')
+		{
+			character += 2;
+			continue;
+		}
+
+		Logging::FormatSpecifier specifier;
+		character = Logging::ParseSpecifier(character, specifier);
+
+		for (uint32_t starIndex = 0; starIndex < specifier.m_starCount && packed; starIndex++)
+		{
+			const int star = va_arg(remainingArgs, int);
+			packed = packValue(&star, sizeof(star));
+		}
+
+		if (!packed)
+			break;
+
+		switch (specifier.m_type)
+		{
+		case Logging::ArgumentType::SIGNED_INTEGER:
 		{
-		case Severity::INFO:
-			std::vfprintf(m_logFileStream, (Time::GetCurrentTimestamp() + " INFO -> " + str.data() + "\n").c_str(), args);
+			const int64_t value = Logging::ReadSignedArgument(specifier.m_lengthModifier, remainingArgs);
+			packed = packValue(&value, sizeof(value));
 			break;
-		case Severity::WARNING:
-			std::vfprintf(m_logFileStream, (Time::GetCurrentTimestamp() + " WARNING -> " + str.data() + "\n").c_str(), args);
+		}
+		case Logging::ArgumentType::UNSIGNED_INTEGER:
+		{
+			const uint64_t value = Logging::ReadUnsignedArgument(specifier.m_lengthModifier, remainingArgs);
+			packed = packValue(&value, sizeof(value));
 			break;
-		case Severity::FATAL:
-			std::vfprintf(m_logFileStream, (Time::GetCurrentTimestamp() + " ERROR -> " + str.data() + "\n").c_str(), args);
+		}
+		case Logging::ArgumentType::DOUBLE:
+		{
+			const double value = va_arg(remainingArgs, double);
+			packed = packValue(&value, sizeof(value));
 			break;
-		};
+		}
+		case Logging::ArgumentType::LONG_DOUBLE:
+		{
+			const long double value = va_arg(remainingArgs, long double);
+			packed = packValue(&value, sizeof(value));
+			break;
+		}
+		case Logging::ArgumentType::STRING:
+		{
+			// The string is copied, since it may not be alive by the time the message is written
+			const char* value = va_arg(remainingArgs, const char*);
+			if (!value)
+				value = "(null)";
+
+			packed = packValue(value, std::strlen(value) + 1);
+			break;
+		}
+		case Logging::ArgumentType::POINTER:
+		{
+			const void* value = va_arg(remainingArgs, const void*);
+			packed = packValue(&value, sizeof(value));
+			break;
+		}
+		default:
+			packed = false;
+			break;
+		}
 	}
-#else
-	// Output the log to the console
-	switch (severity)
-	{
-	case Severity::INFO:
-		SetConsoleTextAttribute(m_consoleOut, 15);
-		std::vprintf((Time::GetCurrentTimestamp() + " INFO -> " + str.data() + "\n").c_str(), args);
-		break;
-	case Severity::WARNING:
-		SetConsoleTextAttribute(m_consoleOut, 14);
-		std::vprintf((Time::GetCurrentTimestamp() + " WARNING -> " + str.data() + "\n").c_str(), args);
-		break;
-	case Severity::FATAL:
-		SetConsoleTextAttribute(m_consoleOut, 12);
-		std::vprintf((Time::GetCurrentTimestamp() + " ERROR -> " + str.data() + "\n").c_str(), args);
-		break;
-	};
-#endif
+
+	va_end(remainingArgs);
+	return packed;
+}
+
+void LoggingSystem::AppendMessage(const Record& record, std::string& output)
+{
+	if (!record.m_format)
+	{
+		output.append((const char*)record.m_payload, record.m_payloadSize);
+		return;
+	}
+
+	// Walk the format string the same way it was walked when packing, reading the arguments back out of the payload
+	const uint8_t* payload = record.m_payload;
+	const char* character = record.m_format;
+	std::string specifierFormat;
+
+	while (*character)
+	{
+		const char* literalEnd = std::strchr(character, '%');
+		if (!literalEnd)
+		{
+			output.append(character);
+			break;
+		}
+
+		output.append(character, literalEnd - character);
+		if (literalEnd[1] == '%')
+		{
+			output.push_back('%');
+			character = literalEnd + 2;
+			continue;
+		}
+
+		Logging::FormatSpecifier specifier;
+		character = Logging::ParseSpecifier(literalEnd, specifier);
+
+		int stars[2] = { 0, 0 };
+		for (uint32_t starIndex = 0; starIndex < specifier.m_starCount && starIndex < 2; starIndex++)
+		{
+			std::memcpy(&stars[starIndex], payload, sizeof(int));
+			payload += sizeof(int);
+		}
+
+		// Rebuild the specifier with the length modifier of the type the argument was packed as
+		specifierFormat.assign(specifier.m_begin, specifier.m_flagsLength + 1);
+
+		switch (specifier.m_type)
+		{
+		case Logging::ArgumentType::SIGNED_INTEGER:
+		{
+			int64_t value;
+			std::memcpy(&value, payload, sizeof(value));
+			payload += sizeof(value);
+
+			if (specifier.m_conversion == 'c')
+			{
+				specifierFormat.push_back('c');
+				Logging::AppendFormatted(output, specifierFormat.c_str(), stars, specifier.m_starCount, (int)value);
+			}
+			else
+			{
+				specifierFormat.append("ll").push_back(specifier.m_conversion);
+				Logging::AppendFormatted(output, specifierFormat.c_str(), stars, specifier.m_starCount, (long long)value);
+			}
+
+			break;
+		}
+		case Logging::ArgumentType::UNSIGNED_INTEGER:
+		{
+			uint64_t value;
+			std::memcpy(&value, payload, sizeof(value));
+			payload += sizeof(value);
+
+			specifierFormat.append("ll").push_back(specifier.m_conversion);
+			Logging::AppendFormatted(output, specifierFormat.c_str(), stars, specifier.m_starCount, (unsigned long long)value);
+			break;
+		}
+		case Logging::ArgumentType::DOUBLE:
+		{
+			double value;
+			std::memcpy(&value, payload, sizeof(value));
+			payload += sizeof(value);
+
+			specifierFormat.push_back(specifier.m_conversion);
+			Logging::AppendFormatted(output, specifierFormat.c_str(), stars, specifier.m_starCount, value);
+			break;
+		}
+		case Logging::ArgumentType::LONG_DOUBLE:
+		{
+			long double value;
+			std::memcpy(&value, payload, sizeof(value));
+			payload += sizeof(value);
+
+			specifierFormat.append("L").push_back(specifier.m_conversion);
+			Logging::AppendFormatted(output, specifierFormat.c_str(), stars, specifier.m_starCount, value);
+			break;
+		}
+		case Logging::ArgumentType::STRING:
+		{
+			const char* value = (const char*)payload;
+			payload += std::strlen(value) + 1;
+
+			specifierFormat.push_back('s');
+			Logging::AppendFormatted(output, specifierFormat.c_str(), stars, specifier.m_starCount, value);
+			break;
+		}
+		case Logging::ArgumentType::POINTER:
+		{
+			const void* value;
+			std::memcpy(&value, payload, sizeof(value));
+			payload += sizeof(value);
+
+			specifierFormat.push_back('p');
+			Logging::AppendFormatted(output, specifierFormat.c_str(), stars, specifier.m_starCount, value);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
+
+const std::string& LoggingSystem::GetTimestamp(uint64_t timestampNanoseconds)
+{
+	const uint64_t timestampSecond = timestampNanoseconds / 1000000000;
+	if (timestampSecond != m_cachedTimestampSecond)
+	{
+		m_cachedTimestamp = Time::FormatTimestamp((std::time_t)timestampSecond);
+		m_cachedTimestampSecond = timestampSecond;
+	}
+
+	return m_cachedTimestamp;
+}
+
+void LoggingSystem::WritePendingRecords()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_threadRingsMutex);
+		for (size_t ringIndex = 0; ringIndex < m_threadRings.size();)
+		{
+			ThreadRing& threadRing = *m_threadRings[ringIndex];
+
+			// Read before the ring is emptied, so every record the thread pushed before it exited is taken below
+			const bool abandoned = threadRing.m_abandoned.load(std::memory_order_acquire);
+
+			// A message held back by the previous drain comes before anything the thread has pushed since
+			m_pendingRecords.insert(m_pendingRecords.end(), threadRing.m_incompleteRecords.begin(), 
+				threadRing.m_incompleteRecords.end());
+			threadRing.m_incompleteRecords.clear();
+
+			size_t messageStart = m_pendingRecords.size();
+			Record record;
+			while (threadRing.m_records.TryPop(record))
+			{
+				m_pendingRecords.push_back(record);
+				if (!record.m_continued)
+					messageStart = m_pendingRecords.size();
+			}
+
+			// Hold back the start of a message whose remaining records haven't been pushed yet, so it isn't written until whole
+			threadRing.m_incompleteRecords.assign(m_pendingRecords.begin() + messageStart, m_pendingRecords.end());
+			m_pendingRecords.erase(m_pendingRecords.begin() + messageStart, m_pendingRecords.end());
+
+			// A thread which has exited finished pushing its last message, so its ring is now empty and can be freed
+			if (abandoned)
+				m_threadRings.erase(m_threadRings.begin() + ringIndex);
+			else
+				++ringIndex;
+		}
+	}
+
+	if (m_pendingRecords.empty())
+		return;
+
+	// Interleave the records of each thread in the order they were logged, each thread's records are already in order.
+	// The records of a message share its timestamp, so they stay together
+	std::stable_sort(m_pendingRecords.begin(), m_pendingRecords.end(), [](const Record& lhs, const Record& rhs)
+		{ return lhs.m_timestampNanoseconds < rhs.m_timestampNanoseconds; });
+
+	m_outputBatch.clear();
+	bool continuingMessage = false;
+
+	for (const Record& record : m_pendingRecords)
+	{
+		if (!continuingMessage)
+		{
+			if (m_colorOutput)
+				m_outputBatch.append(Logging::GetSeverityColor(record.m_severity));
+
+			m_outputBatch.append(this->GetTimestamp(record.m_timestampNanoseconds));
+			m_outputBatch.append(Logging::GetSeverityLabel(record.m_severity));
+		}
+
+		LoggingSystem::AppendMessage(record, m_outputBatch);
+		continuingMessage = record.m_continued;
+
+		if (continuingMessage)
+			continue;
+
+		if (m_colorOutput)
+			m_outputBatch.append("\x1b[0m");
+
+		m_outputBatch.push_back('\n');
+	}
+
+	m_pendingRecords.clear();
+
+	if (m_outputStream)
+	{
+		std::fwrite(m_outputBatch.data(), 1, m_outputBatch.size(), m_outputStream);
+		std::fflush(m_outputStream);
+	}
+}
+
+void LoggingSystem::WriterMain()
+{
+	while (true)
+	{
+		// Every record pushed before a flush was requested is written by the time the flush is marked as complete
+		const uint64_t requestedFlushCount = m_requestedFlushCount.load(std::memory_order_acquire);
+		const bool running = m_running.load(std::memory_order_acquire);
+
+		this->WritePendingRecords();
+		m_completedFlushCount.store(requestedFlushCount, std::memory_order_release);
+
+		if (!running)
+			break;
+
+		std::unique_lock<std::mutex> lock(m_writerMutex);
+		m_writerCondition.wait_for(lock, Logging::writerSleepDuration, [this, requestedFlushCount]()
+			{ return !m_running.load() || m_requestedFlushCount.load() != requestedFlushCount; });
+	}
+}
+
+void LoggingSystem::Output(std::string_view str, Severity severity, va_list args)
+{
+	// Format the message now, since the arguments (and possibly the format string) won't outlive the call
+	va_list sizeArgs;
+	va_copy(sizeArgs, args);
+	const int length = std::vsnprintf(nullptr, 0, str.data(), sizeArgs);
+	va_end(sizeArgs);
+
+	std::string message(std::max(length, 0) + 1, '\0');
+	std::vsnprintf(&message[0], message.size(), str.data(), args);
+	message.pop_back(); // Remove the null terminator
+
+	Record record;
+	record.m_format = nullptr;
+	record.m_timestampNanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	record.m_severity = severity;
+
+	// Split the message across as many records as it needs
+	size_t messageOffset = 0;
+	do
+	{
+		record.m_payloadSize = (uint32_t)std::min(message.size() - messageOffset, LoggingSystem::recordPayloadCapacity);
+		std::memcpy(record.m_payload, message.data() + messageOffset, record.m_payloadSize);
+
+		messageOffset += record.m_payloadSize;
+		record.m_continued = messageOffset < message.size();
+
+		this->PushRecord(record);
+	} while (record.m_continued);
+
+	if (severity == Severity::FATAL)
+		this->Flush();
 }
 
 void LoggingSystem::Output(std::string_view str, Severity severity, ...)
@@ -67,13 +625,71 @@ void LoggingSystem::Output(std::string_view str, Severity severity, ...)
 	va_list args;
 	va_start(args, severity);
 
-	this->Output(str, severity, args);
+	Record record;
+	record.m_format = str.data();
+	record.m_timestampNanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	record.m_severity = severity;
+	record.m_continued = false;
+	record.m_payloadSize = 0;
+
+	// Fatal messages are written immediately, and messages whose arguments don't fit in a record are formatted now instead
+	if (severity != Severity::FATAL && LoggingSystem::PackArguments(str.data(), args, record.m_payload, record.m_payloadSize))
+		this->PushRecord(record);
+	else
+		this->Output(str, severity, args);
 
 	va_end(args);
 }
 
+void LoggingSystem::Flush()
+{
+	const uint64_t flushIndex = m_requestedFlushCount.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+	{ std::lock_guard<std::mutex> lock(m_writerMutex); }
+	m_writerCondition.notify_one();
+
+	while (m_completedFlushCount.load(std::memory_order_acquire) < flushIndex)
+		std::this_thread::yield();
+}
+
 LoggingSystem& LoggingSystem::GetInstance()
 {
 	static LoggingSystem instance;
 	return instance;
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LogRateLimiter::LogRateLimiter(uint32_t messagesPerSecond) :
+	m_messagesPerInterval(std::max(messagesPerSecond, 1u)), m_intervalStartNanoseconds(LogRateLimiter::noInterval), 
+	m_occurrenceCount(0)
+{}
+
+bool LogRateLimiter::Allow(uint32_t& previousOccurrenceCount)
+{
+	previousOccurrenceCount = 0;
+
+	const uint64_t currentNanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	// Start a new interval if the current one is over, only one of the threads racing to start it will succeed
+	uint64_t intervalStartNanoseconds = m_intervalStartNanoseconds.load(std::memory_order_relaxed);
+	if (intervalStartNanoseconds == LogRateLimiter::noInterval || 
+		currentNanoseconds - intervalStartNanoseconds >= LogRateLimiter::intervalNanoseconds)
+	{
+		if (m_intervalStartNanoseconds.compare_exchange_strong(intervalStartNanoseconds, currentNanoseconds, 
+			std::memory_order_relaxed))
+		{
+			previousOccurrenceCount = m_occurrenceCount.exchange(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return m_occurrenceCount.fetch_add(1, std::memory_order_relaxed) < m_messagesPerInterval;
+}
+
+uint32_t LogRateLimiter::GetMessagesPerSecond() const
+{
+	return m_messagesPerInterval;
+}
@@ -1,33 +1,213 @@
 #ifndef LOGGING_SYSTEM_H
 #define LOGGING_SYSTEM_H
 
-#include <string>
+#include <util/spsc_ring_buffer.h>
 
-typedef void* HANDLE;
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdint>
 
+// Writes log messages from any thread without blocking on I/O.
+// Each call packs the format string pointer, severity, timestamp and arguments into a compact record which is pushed into a
+// lock-free ring owned by the calling thread. A background thread drains the rings, formats the records in timestamp order and
+// writes them out in batches.
 class LoggingSystem
 {
+public:
+	enum class Severity { INFO, WARNING, FATAL };
 private:
-#ifndef _DEBUG
-	FILE* m_logFileStream = nullptr;
-#else
-	HANDLE m_consoleOut;
-#endif
+	static constexpr size_t recordPayloadCapacity = 224;
+
+	// A log message waiting to be formatted and written.
+	struct Record
+	{
+		const char* m_format; // nullptr if the payload holds the already formatted message
+		uint64_t m_timestampNanoseconds; // The wall-clock time the message was logged, since the system clock's epoch
+		Severity m_severity;
+		bool m_continued; // Set if the formatted message is too long for the payload and continues in the next record
+		uint32_t m_payloadSize;
+		uint8_t m_payload[recordPayloadCapacity]; // The packed arguments, or the formatted message
+	};
+
+	// The records logged by a thread, which are freed once the thread has exited and its records have been written.
+	struct ThreadRing
+	{
+		SPSCRingBuffer<Record> m_records;
+		std::vector<Record> m_incompleteRecords; // The start of a message still being pushed, only used by the writer thread
+		std::atomic<bool> m_abandoned; // Set once the thread has exited
+
+		ThreadRing();
+	};
+
+	// Held by each thread which has logged a message, marks the thread's ring as abandoned when the thread exits.
+	struct ThreadRingOwner
+	{
+		std::shared_ptr<ThreadRing> m_ring;
+
+		~ThreadRingOwner();
+	};
+
+	FILE* m_outputStream;
+	bool m_colorOutput; // Set if the output stream is a console which supports ANSI escape codes
+
+	std::mutex m_threadRingsMutex; // Only locked when a thread first logs a message, or when the rings are drained
+	std::vector<std::shared_ptr<ThreadRing>> m_threadRings;
+
+	std::thread m_writerThread;
+	std::mutex m_writerMutex;
+	std::condition_variable m_writerCondition;
+	std::atomic<bool> m_running;
+	std::atomic<uint64_t> m_requestedFlushCount, m_completedFlushCount;
+
+	// Used only by the writer thread
+	std::vector<Record> m_pendingRecords;
+	std::string m_outputBatch;
+	uint64_t m_cachedTimestampSecond;
+	std::string m_cachedTimestamp;
 
 	LoggingSystem();
-public:
-	enum class Severity { INFO, WARNING, FATAL };
 
+	// Returns the ring of the calling thread, creating it the first time it's called on the thread.
+	SPSCRingBuffer<Record>& GetThreadRing();
+
+	// Pushes the record into the calling thread's ring, waiting for space if the ring is full.
+	void PushRecord(const Record& record);
+
+	// Copies the arguments described by the format string into the payload.
+	// Returns FALSE if they don't fit, or the format string has specifiers which can't be packed.
+	static bool PackArguments(const char* format, va_list args, uint8_t* payload, uint32_t& payloadSize);
+
+	// Appends the message of the record to the output, formatting the packed arguments with its format string if needed.
+	static void AppendMessage(const Record& record, std::string& output);
+
+	// Returns the timestamp string of the given time, which is reformatted at most once per second.
+	const std::string& GetTimestamp(uint64_t timestampNanoseconds);
+
+	// Moves the complete messages out of every thread's ring, then formats and writes them in timestamp order.
+	// The rings of threads which have exited are freed once they've been emptied.
+	void WritePendingRecords();
+
+	// The main function of the writer thread.
+	void WriterMain();
+public:
 	~LoggingSystem();
 
 	// Writes the given string to a logging output.
 	// This will be the console if in Debug mode, or a log file if in Release mode.
-	// Note that this function follows the same formatting rules as the printf() functions.
+	// Note that this function follows the same formatting rules as the printf() functions, however the format string is only 
+	// read once the message is written, so it must remain alive until then (a string literal is always safe).
+	// Fatal messages are formatted immediately and written before the function returns.
 	void Output(std::string_view str, Severity severity, ...);
+
+	// Writes the given string to a logging output, formatting it with the given arguments immediately.
 	void Output(std::string_view str, Severity severity, va_list args);
 
+	// Waits until every message logged before the call has been written.
+	void Flush();
+
 	// Returns singleton instance of the class.
 	static LoggingSystem& GetInstance();
 };
 
+// Limits how often a single logging call site writes its message, so that a message logged every frame can't flood the log.
+// Occurrences over the limit are counted instead of written, and the count is reported by the next message written.
+class LogRateLimiter
+{
+private:
+	static constexpr uint64_t intervalNanoseconds = 1000000000;
+	static constexpr uint64_t noInterval = UINT64_MAX;
+
+	const uint32_t m_messagesPerInterval;
+	std::atomic<uint64_t> m_intervalStartNanoseconds;
+	std::atomic<uint32_t> m_occurrenceCount; // The number of occurrences since the current interval started
+public:
+	explicit LogRateLimiter(uint32_t messagesPerSecond = 1);
+	LogRateLimiter(const LogRateLimiter& other) = delete;
+
+	~LogRateLimiter() = default;
+
+	// Records an occurrence and returns TRUE if its message should be written.
+	// When the occurrence starts a new interval, the number of occurrences in the previous interval is returned through 
+	// previousOccurrenceCount, otherwise it's set to 0.
+	bool Allow(uint32_t& previousOccurrenceCount);
+
+	// Returns the number of messages written per second.
+	uint32_t GetMessagesPerSecond() const;
+
+	LogRateLimiter& operator=(const LogRateLimiter& other) = delete;
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOG_FORMAT_FUNCTION __attribute__((format(printf, 1, 2)))
+#define LOG_FORMAT_STRING
+#elif defined(_MSC_VER)
+#include <sal.h>
+#define LOG_FORMAT_FUNCTION
+#define LOG_FORMAT_STRING _Printf_format_string_
+#else
+#define LOG_FORMAT_FUNCTION
+#define LOG_FORMAT_STRING
+#endif
+
+// Does nothing, it's only called so that the compiler checks the logging macros' format strings against their arguments.
+LOG_FORMAT_FUNCTION inline void CheckLogFormat(LOG_FORMAT_STRING const char*, ...) {}
+
+// Messages logged through the macros with a lower severity than this are compiled out, along with their arguments.
+// Define as INFO, WARNING or FATAL.
+#ifndef LOG_MINIMUM_SEVERITY
+#define LOG_MINIMUM_SEVERITY INFO
+#endif
+
+// Logs a message with the given severity, the format must be a string literal.
+#define LOG_MESSAGE(severity, format, ...) \
+	do \
+	{ \
+		if constexpr (severity >= LoggingSystem::Severity::LOG_MINIMUM_SEVERITY) \
+		{ \
+			if (false) \
+				CheckLogFormat(format, ##__VA_ARGS__); \
+			LoggingSystem::GetInstance().Output(format, severity, ##__VA_ARGS__); \
+		} \
+	} while (false)
+
+// Logs a message with the given severity at most the given number of times per second from the call site.
+// The arguments are only evaluated when the message is written.
+#define LOG_MESSAGE_RATE_LIMITED(messagesPerSecond, severity, format, ...) \
+	do \
+	{ \
+		if constexpr (severity >= LoggingSystem::Severity::LOG_MINIMUM_SEVERITY) \
+		{ \
+			if (false) \
+				CheckLogFormat(format, ##__VA_ARGS__); \
+			static LogRateLimiter logRateLimiter(messagesPerSecond); \
+			uint32_t previousOccurrenceCount = 0; \
+			if (logRateLimiter.Allow(previousOccurrenceCount)) \
+			{ \
+				if (previousOccurrenceCount > logRateLimiter.GetMessagesPerSecond()) \
+				{ \
+					LoggingSystem::GetInstance().Output(format " (logged %u of %u occurrences in the last second)", severity, \
+						##__VA_ARGS__, logRateLimiter.GetMessagesPerSecond(), previousOccurrenceCount); \
+				} \
+				else \
+					LoggingSystem::GetInstance().Output(format, severity, ##__VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
+#define LOG_INFO(format, ...) LOG_MESSAGE(LoggingSystem::Severity::INFO, format, ##__VA_ARGS__)
+#define LOG_WARNING(format, ...) LOG_MESSAGE(LoggingSystem::Severity::WARNING, format, ##__VA_ARGS__)
+#define LOG_FATAL(format, ...) LOG_MESSAGE(LoggingSystem::Severity::FATAL, format, ##__VA_ARGS__)
+
+// Rate limited to one message per second from each call site, for diagnostics which can be hit every frame.
+#define LOG_INFO_RATE_LIMITED(format, ...) LOG_MESSAGE_RATE_LIMITED(1, LoggingSystem::Severity::INFO, format, ##__VA_ARGS__)
+#define LOG_WARNING_RATE_LIMITED(format, ...) LOG_MESSAGE_RATE_LIMITED(1, LoggingSystem::Severity::WARNING, format, ##__VA_ARGS__)
+
 #endif
@@ -0,0 +1,335 @@
+#include <util/profiler.h>
+#include <util/logging_system.h>
+#include <util/formatted_exception.h>
+
+#include <glad/glad.h>
+#include <nlohmann/json.hpp>
+#include <fstream>
+
+namespace ProfilerParams
+{
+    // The number of events each thread can record between two calls to Profiler::EndFrame() before events are dropped.
+    constexpr size_t threadBufferCapacity = 65536;
+
+    // The thread index which GPU events are recorded with, so that they're shown on their own track in traces.
+    constexpr uint32_t gpuThreadIndex = 0xFFFF;
+
+    constexpr uint32_t invalidQueryIndex = 0xFFFFFFFF;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Profiler::ThreadBuffer::ThreadBuffer(size_t capacity, uint32_t threadIndex) :
+    m_events(capacity), m_droppedEventCount(0), m_abandoned(false), m_threadIndex(threadIndex), 
+    m_threadName("Thread " + std::to_string(threadIndex))
+{}
+
+Profiler::ThreadBufferOwner::~ThreadBufferOwner()
+{
+    // The buffer is shared with the profiler, so it stays alive even if the profiler is destroyed first
+    if (m_buffer)
+        m_buffer->m_abandoned.store(true, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Profiler::Profiler() :
+    m_startTime(std::chrono::steady_clock::now()), m_nextThreadIndex(0), m_capturing(false), m_remainingCaptureFrames(0), 
+    m_requestedCaptureFrames(0), m_gpuFrameIndex(0), 
+    m_gpuQueriesCreated(false), m_gpuScopeActive(false), m_droppedGPUQueryCount(0)
+{
+    for (GPUFrame& gpuFrame : m_gpuFrames)
+    {
+        gpuFrame.m_queries.fill({ 0, nullptr, 0, false });
+        gpuFrame.m_usedQueryCount = 0;
+    }
+}
+
+Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+{
+    thread_local ThreadBufferOwner threadBufferOwner;
+    if (!threadBufferOwner.m_buffer)
+    {
+        std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+        m_threadBuffers.push_back(std::make_shared<ThreadBuffer>(ProfilerParams::threadBufferCapacity, m_nextThreadIndex++));
+        threadBufferOwner.m_buffer = m_threadBuffers.back();
+    }
+
+    return *threadBufferOwner.m_buffer;
+}
+
+void Profiler::CollectThreadEvents()
+{
+    std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+    const bool capturing = m_capturing.load(std::memory_order_relaxed);
+
+    for (size_t bufferIndex = 0; bufferIndex < m_threadBuffers.size();)
+    {
+        ThreadBuffer& threadBuffer = *m_threadBuffers[bufferIndex];
+
+        // Read before the buffer is emptied, so every event the thread recorded before it exited is taken below
+        const bool abandoned = threadBuffer.m_abandoned.load(std::memory_order_acquire);
+
+        Event event;
+        while (threadBuffer.m_events.TryPop(event))
+        {
+            if (capturing)
+                m_capturedEvents.push_back(event);
+        }
+
+        // A capture which hasn't been exported yet still needs the thread's name and dropped event count
+        if (abandoned && m_traceFilePath.empty())
+            m_threadBuffers.erase(m_threadBuffers.begin() + bufferIndex);
+        else
+            bufferIndex++;
+    }
+}
+
+void Profiler::CollectGPUEvents()
+{
+    for (GPUFrame& gpuFrame : m_gpuFrames)
+    {
+        for (uint32_t queryIndex = 0; queryIndex < gpuFrame.m_usedQueryCount; queryIndex++)
+        {
+            GPUQuery& query = gpuFrame.m_queries[queryIndex];
+            if (!query.m_pending)
+                continue;
+
+            int resultAvailable = 0;
+            glGetQueryObjectiv(query.m_id, GL_QUERY_RESULT_AVAILABLE, &resultAvailable);
+            if (!resultAvailable)
+                continue;
+
+            uint64_t elapsedNanoseconds = 0;
+            glGetQueryObjectui64v(query.m_id, GL_QUERY_RESULT, &elapsedNanoseconds);
+
+            m_capturedEvents.push_back({ query.m_name, query.m_startNanoseconds, elapsedNanoseconds, ProfilerParams::gpuThreadIndex });
+            query.m_pending = false;
+        }
+    }
+}
+
+bool Profiler::HasPendingGPUQueries() const
+{
+    for (const GPUFrame& gpuFrame : m_gpuFrames)
+    {
+        for (uint32_t queryIndex = 0; queryIndex < gpuFrame.m_usedQueryCount; queryIndex++)
+        {
+            if (gpuFrame.m_queries[queryIndex].m_pending)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void Profiler::SetThreadName(std::string_view name)
+{
+    ThreadBuffer& threadBuffer = this->GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+    threadBuffer.m_threadName = name;
+}
+
+void Profiler::BeginCapture(uint32_t frameCount, std::string_view traceFilePath)
+{
+    if (frameCount == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_captureRequestMutex);
+    m_requestedCaptureFrames = frameCount;
+    m_requestedTraceFilePath = traceFilePath;
+}
+
+bool Profiler::IsCapturing() const
+{
+    return m_capturing.load(std::memory_order_relaxed);
+}
+
+void Profiler::RecordEvent(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds)
+{
+    ThreadBuffer& threadBuffer = this->GetThreadBuffer();
+    if (!threadBuffer.m_events.TryPush({ name, startNanoseconds, endNanoseconds - startNanoseconds, threadBuffer.m_threadIndex }))
+        threadBuffer.m_droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t Profiler::BeginGPUScope(const char* name)
+{
+    if (!m_capturing.load(std::memory_order_relaxed) || m_gpuScopeActive)
+        return ProfilerParams::invalidQueryIndex;
+
+    if (!m_gpuQueriesCreated)
+    {
+        for (GPUFrame& gpuFrame : m_gpuFrames)
+        {
+            for (GPUQuery& query : gpuFrame.m_queries)
+                glGenQueries(1, &query.m_id);
+        }
+
+        m_gpuQueriesCreated = true;
+    }
+
+    GPUFrame& gpuFrame = m_gpuFrames[m_gpuFrameIndex];
+    if (gpuFrame.m_usedQueryCount == maxGPUScopesPerFrame)
+    {
+        ++m_droppedGPUQueryCount;
+        return ProfilerParams::invalidQueryIndex;
+    }
+
+    const uint32_t queryIndex = gpuFrame.m_usedQueryCount++;
+    GPUQuery& query = gpuFrame.m_queries[queryIndex];
+    query.m_name = name;
+    query.m_startNanoseconds = this->GetNanoseconds();
+    query.m_pending = false;
+
+    glBeginQuery(GL_TIME_ELAPSED, query.m_id);
+    m_gpuScopeActive = true;
+
+    return queryIndex;
+}
+
+void Profiler::EndGPUScope(uint32_t queryIndex)
+{
+    if (queryIndex == ProfilerParams::invalidQueryIndex)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    m_gpuFrames[m_gpuFrameIndex].m_queries[queryIndex].m_pending = true;
+    m_gpuScopeActive = false;
+}
+
+void Profiler::EndFrame()
+{
+    this->CollectThreadEvents();
+    this->CollectGPUEvents();
+
+    // Move on to the next frame of GPU queries, any queries in it which still haven't returned their results are dropped, 
+    // since waiting for them would stall the CPU
+    m_gpuFrameIndex = (m_gpuFrameIndex + 1) % gpuFrameLatency;
+
+    GPUFrame& gpuFrame = m_gpuFrames[m_gpuFrameIndex];
+    for (uint32_t queryIndex = 0; queryIndex < gpuFrame.m_usedQueryCount; queryIndex++)
+    {
+        if (gpuFrame.m_queries[queryIndex].m_pending)
+        {
+            gpuFrame.m_queries[queryIndex].m_pending = false;
+            ++m_droppedGPUQueryCount;
+        }
+    }
+
+    gpuFrame.m_usedQueryCount = 0;
+
+    // Finish the capture once enough frames have been recorded, and export it once the GPU has caught up
+    if (m_capturing.load(std::memory_order_relaxed) && --m_remainingCaptureFrames == 0)
+        m_capturing.store(false, std::memory_order_relaxed);
+
+    if (!m_capturing.load(std::memory_order_relaxed) && !m_traceFilePath.empty() && !this->HasPendingGPUQueries())
+    {
+        this->ExportChromeTrace(m_traceFilePath);
+
+        uint32_t droppedEventCount = m_droppedGPUQueryCount;
+        {
+            std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+            for (std::shared_ptr<ThreadBuffer>& threadBuffer : m_threadBuffers)
+                droppedEventCount += threadBuffer->m_droppedEventCount.exchange(0, std::memory_order_relaxed);
+        }
+
+        LOG_INFO("Exported profiler capture of %zu events (%u dropped) to: %s", m_capturedEvents.size(), droppedEventCount, 
+            m_traceFilePath.c_str());
+
+        m_capturedEvents.clear();
+        m_traceFilePath.clear();
+        m_droppedGPUQueryCount = 0;
+    }
+
+    // Start the requested capture once the previous one has been exported
+    if (m_traceFilePath.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_captureRequestMutex);
+        if (m_requestedCaptureFrames > 0)
+        {
+            m_capturedEvents.clear();
+            m_remainingCaptureFrames = m_requestedCaptureFrames;
+            m_traceFilePath = m_requestedTraceFilePath;
+            m_requestedCaptureFrames = 0;
+            m_capturing.store(true, std::memory_order_relaxed);
+
+            LOG_INFO("Started profiler capture of %u frames.", m_remainingCaptureFrames);
+        }
+    }
+}
+
+void Profiler::ExportChromeTrace(std::string_view filePath) const
+{
+    nlohmann::json traceEvents = nlohmann::json::array();
+
+    // The times in the trace event format are in microseconds
+    for (const Event& event : m_capturedEvents)
+    {
+        traceEvents.push_back({
+            { "name", event.m_name },
+            { "cat", event.m_threadIndex == ProfilerParams::gpuThreadIndex ? "GPU" : "CPU" },
+            { "ph", "X" },
+            { "ts", (double)event.m_startNanoseconds / 1000.0 },
+            { "dur", (double)event.m_durationNanoseconds / 1000.0 },
+            { "pid", 0 },
+            { "tid", event.m_threadIndex }
+        });
+    }
+
+    // Add metadata events which name the track of each thread
+    {
+        std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+        for (const std::shared_ptr<ThreadBuffer>& threadBuffer : m_threadBuffers)
+        {
+            traceEvents.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 0 }, { "tid", threadBuffer->m_threadIndex }, 
+                { "args", { { "name", threadBuffer->m_threadName } } } });
+        }
+    }
+
+    traceEvents.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 0 }, { "tid", ProfilerParams::gpuThreadIndex }, 
+        { "args", { { "name", "GPU" } } } });
+
+    std::ofstream traceFileStream(filePath.data());
+    if (traceFileStream.fail())
+        throw FormattedException("Failed to open the profiler trace file at path: %s", filePath.data());
+
+    traceFileStream << nlohmann::json({ { "traceEvents", traceEvents }, { "displayTimeUnit", "ms" } });
+}
+
+uint64_t Profiler::GetNanoseconds() const
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+Profiler& Profiler::GetInstance()
+{
+    static Profiler instance;
+    return instance;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ProfileScope::ProfileScope(const char* name) :
+    m_name(name), m_startNanoseconds(0), m_active(Profiler::GetInstance().IsCapturing())
+{
+    if (m_active)
+        m_startNanoseconds = Profiler::GetInstance().GetNanoseconds();
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (m_active)
+        Profiler::GetInstance().RecordEvent(m_name, m_startNanoseconds, Profiler::GetInstance().GetNanoseconds());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+GPUProfileScope::GPUProfileScope(const char* name) :
+    m_queryIndex(Profiler::GetInstance().BeginGPUScope(name))
+{}
+
+GPUProfileScope::~GPUProfileScope()
+{
+    Profiler::GetInstance().EndGPUScope(m_queryIndex);
+}
@@ -0,0 +1,186 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <util/spsc_ring_buffer.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Records how long scopes of code take to run on the CPU and GPU over a number of captured frames, which can then be exported
+// as a Chrome trace (viewable in chrome://tracing or Perfetto).
+// Each thread records its CPU events into its own lock-free buffer, which the thread that owns the OpenGL context collects
+// from once per frame. GPU timings come from GL_TIME_ELAPSED queries kept in a ring spanning several frames, and are only read
+// once their results are available, so the CPU never waits on the GPU.
+// Outside of a capture, profiled scopes only cost a single atomic load.
+class Profiler
+{
+public:
+	struct Event
+	{
+		const char* m_name; // Must be a string literal, as only the pointer is kept
+		uint64_t m_startNanoseconds, m_durationNanoseconds;
+		uint32_t m_threadIndex;
+	};
+private:
+	static constexpr uint32_t gpuFrameLatency = 4; // The number of frames a GPU query has to return its result
+	static constexpr uint32_t maxGPUScopesPerFrame = 32;
+
+	// The buffer which a single thread records its events into, which is freed once the thread has exited and its events have
+	// been collected.
+	struct ThreadBuffer
+	{
+		SPSCRingBuffer<Event> m_events;
+		std::atomic<uint32_t> m_droppedEventCount;
+		std::atomic<bool> m_abandoned; // Set once the thread has exited
+		uint32_t m_threadIndex;
+		std::string m_threadName;
+
+		ThreadBuffer(size_t capacity, uint32_t threadIndex);
+	};
+
+	// Held by each thread which has recorded an event, marks the thread's buffer as abandoned when the thread exits.
+	struct ThreadBufferOwner
+	{
+		std::shared_ptr<ThreadBuffer> m_buffer;
+
+		~ThreadBufferOwner();
+	};
+
+	// A timer query which was issued for a GPU scope, and is waiting for its result.
+	struct GPUQuery
+	{
+		uint32_t m_id;
+		const char* m_name;
+		uint64_t m_startNanoseconds; // The CPU time when the query began, used to place the GPU event on the trace
+		bool m_pending;
+	};
+
+	// The timer queries issued during a single frame.
+	struct GPUFrame
+	{
+		std::array<GPUQuery, maxGPUScopesPerFrame> m_queries;
+		uint32_t m_usedQueryCount;
+	};
+
+	const std::chrono::steady_clock::time_point m_startTime;
+
+	mutable std::mutex m_threadBuffersMutex; // Only locked when a thread first records an event, or when the buffers are collected
+	std::vector<std::shared_ptr<ThreadBuffer>> m_threadBuffers;
+	uint32_t m_nextThreadIndex; // Threads are never given the index of an exited thread, so their tracks aren't merged
+
+	std::atomic<bool> m_capturing;
+	uint32_t m_remainingCaptureFrames;
+	std::string m_traceFilePath;
+
+	// A capture requested by BeginCapture(), which is started by the thread calling EndFrame() so it can be requested from any thread
+	std::mutex m_captureRequestMutex;
+	uint32_t m_requestedCaptureFrames;
+	std::string m_requestedTraceFilePath;
+	std::vector<Event> m_capturedEvents;
+
+	std::array<GPUFrame, gpuFrameLatency> m_gpuFrames;
+	uint32_t m_gpuFrameIndex;
+	bool m_gpuQueriesCreated, m_gpuScopeActive;
+	uint32_t m_droppedGPUQueryCount;
+
+	Profiler();
+
+	// Returns the event buffer of the calling thread, creating it the first time it's called on the thread.
+	ThreadBuffer& GetThreadBuffer();
+
+	// Moves the events recorded by every thread into the captured events, or discards them if there isn't a capture running.
+	// The buffers of exited threads are freed once they're empty, unless a capture still needs their thread names.
+	void CollectThreadEvents();
+
+	// Reads the results of any GPU queries which have become available, without waiting for the rest.
+	void CollectGPUEvents();
+
+	// Returns TRUE if any GPU queries issued during the capture are still waiting for their results.
+	bool HasPendingGPUQueries() const;
+public:
+	~Profiler() = default;
+
+	// Sets the name which the calling thread is shown with in exported traces.
+	void SetThreadName(std::string_view name);
+
+	// Starts recording events for the given number of frames, from the next call to EndFrame(). Once they have been recorded, 
+	// the captured events are exported as a Chrome trace to the file path given. If a capture is already running, the new one
+	// starts once it has been exported. This can be called from any thread.
+	void BeginCapture(uint32_t frameCount, std::string_view traceFilePath);
+
+	// Returns TRUE if events are currently being recorded.
+	bool IsCapturing() const;
+
+	// Records an event which ran between the two times given (from GetNanoseconds()) on the calling thread.
+	// This can be called from any thread.
+	void RecordEvent(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds);
+
+	// Begins timing the GPU commands issued until EndGPUScope() is called with the index returned.
+	// GPU scopes can't be nested, so 0xFFFFFFFF is returned if another GPU scope is active (or there isn't a capture running).
+	// This must only be called on the thread which owns the OpenGL context.
+	uint32_t BeginGPUScope(const char* name);
+
+	// Ends the GPU scope with the index given.
+	void EndGPUScope(uint32_t queryIndex);
+
+	// Collects the events recorded during the frame, and exports the capture if it has finished.
+	// This must be called once per frame on the thread which owns the OpenGL context.
+	void EndFrame();
+
+	// Writes the captured events to the specified file in the Chrome trace event format.
+	void ExportChromeTrace(std::string_view filePath) const;
+
+	// Returns the number of nanoseconds since the profiler was created.
+	uint64_t GetNanoseconds() const;
+
+	// Returns singleton instance of the class.
+	static Profiler& GetInstance();
+};
+
+// Records the time between its creation and destruction as an event, if a capture is running when it's created.
+class ProfileScope
+{
+private:
+	const char* m_name;
+	uint64_t m_startNanoseconds;
+	bool m_active;
+public:
+	explicit ProfileScope(const char* name);
+	ProfileScope(const ProfileScope& other) = delete;
+
+	~ProfileScope();
+
+	ProfileScope& operator=(const ProfileScope& other) = delete;
+};
+
+// Records the GPU time taken by the commands issued between its creation and destruction.
+class GPUProfileScope
+{
+private:
+	uint32_t m_queryIndex;
+public:
+	explicit GPUProfileScope(const char* name);
+	GPUProfileScope(const GPUProfileScope& other) = delete;
+
+	~GPUProfileScope();
+
+	GPUProfileScope& operator=(const GPUProfileScope& other) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Profiles the CPU time of the enclosing scope, the name must be a string literal.
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+// Profiles the GPU time of the commands issued in the enclosing scope, the name must be a string literal.
+#define PROFILE_GPU_SCOPE(name) GPUProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// A fixed capacity, lock-free queue for passing values from exactly one producer thread to exactly one consumer thread.
+// The capacity is rounded up to a power of two. Pushing to a full buffer fails instead of blocking, so the producer never waits.
+template<typename T>
+class SPSCRingBuffer
+{
+private:
+	std::unique_ptr<T[]> m_elements;
+	size_t m_mask;
+
+	// The read and write positions are kept on separate cache lines, so the two threads don't contend on the same line
+	alignas(64) std::atomic<size_t> m_writePosition;
+	alignas(64) std::atomic<size_t> m_readPosition;
+public:
+	explicit SPSCRingBuffer(size_t capacity);
+	SPSCRingBuffer(const SPSCRingBuffer& other) = delete;
+
+	~SPSCRingBuffer() = default;
+
+	SPSCRingBuffer& operator=(const SPSCRingBuffer& other) = delete;
+
+	// Adds the value to the back of the buffer, this must only be called by the producer thread.
+	// Returns FALSE, without adding the value, if the buffer is full.
+	bool TryPush(const T& value);
+
+	// Removes the value at the front of the buffer, this must only be called by the consumer thread.
+	// Returns FALSE if the buffer is empty.
+	bool TryPop(T& value);
+
+	// Returns the number of values in the buffer.
+	// The result is only approximate if either thread is using the buffer at the same time.
+	size_t GetSize() const;
+
+	// Returns the maximum number of values the buffer can hold.
+	size_t GetCapacity() const;
+};
+
+#include <util/spsc_ring_buffer.tpp>
+
+#endif
@@ -0,0 +1,50 @@
+template<typename T>
+SPSCRingBuffer<T>::SPSCRingBuffer(size_t capacity) :
+    m_writePosition(0), m_readPosition(0)
+{
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity)
+        roundedCapacity *= 2;
+
+    m_elements = std::make_unique<T[]>(roundedCapacity);
+    m_mask = roundedCapacity - 1;
+}
+
+template<typename T>
+bool SPSCRingBuffer<T>::TryPush(const T& value)
+{
+    // The positions only ever increase, so the number of values in the buffer is their difference
+    const size_t writePosition = m_writePosition.load(std::memory_order_relaxed);
+    if (writePosition - m_readPosition.load(std::memory_order_acquire) > m_mask)
+        return false;
+
+    m_elements[writePosition & m_mask] = value;
+    m_writePosition.store(writePosition + 1, std::memory_order_release); // Publishes the value to the consumer
+
+    return true;
+}
+
+template<typename T>
+bool SPSCRingBuffer<T>::TryPop(T& value)
+{
+    const size_t readPosition = m_readPosition.load(std::memory_order_relaxed);
+    if (readPosition == m_writePosition.load(std::memory_order_acquire))
+        return false;
+
+    value = std::move(m_elements[readPosition & m_mask]);
+    m_readPosition.store(readPosition + 1, std::memory_order_release); // Hands the slot back to the producer
+
+    return true;
+}
+
+template<typename T>
+size_t SPSCRingBuffer<T>::GetSize() const
+{
+    return m_writePosition.load(std::memory_order_acquire) - m_readPosition.load(std::memory_order_acquire);
+}
+
+template<typename T>
+size_t SPSCRingBuffer<T>::GetCapacity() const
+{
+    return m_mask + 1;
+}
@@ -1,26 +1,41 @@
 #include <util/time.h>
 
-#include <GLFW/glfw3.h>
+#include <chrono>
 #include <ctime>
 
+namespace Time
+{
+	// The time the application started, which the time since the epoch is measured from.
+	static const std::chrono::steady_clock::time_point epochTime = std::chrono::steady_clock::now();
+}
+
 std::string Time::GetCurrentTimestamp()
 {
-	time_t rawTime;
+	return Time::FormatTimestamp(std::time(nullptr));
+}
+
+std::string Time::FormatTimestamp(std::time_t time)
+{
 	struct tm timeData;
+#ifdef _PLATFORM_WINDOWS
+	localtime_s(&timeData, &time);
+#else
+	localtime_r(&time, &timeData);
+#endif
 
-	time(&rawTime);
-	localtime_s(&timeData, &rawTime);
-	char* timeInfo = new char[50];
-	asctime_s(timeInfo, 50, &timeData);
+	// Formatted the same way as asctime(), without the newline at the end
+	char timeInfo[32];
+	std::strftime(timeInfo, sizeof(timeInfo), "%a %b %e %H:%M:%S %Y", &timeData);
 
-	std::string currentTimeStr = timeInfo;
-	currentTimeStr.pop_back(); // Remove the '\n' from the end of the string
-	delete[] timeInfo;
+	return "[" + std::string(timeInfo) + "]";
+}
 
-	return "[" + currentTimeStr + "]";
+uint64_t Time::GetNanosecondsSinceEpoch()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Time::epochTime).count();
 }
 
-float Time::GetSecondsSinceEpoch()
+double Time::GetSecondsSinceEpoch()
 {
-    return (float)glfwGetTime();
+	return (double)Time::GetNanosecondsSinceEpoch() / 1e9;
 }
@@ -2,14 +2,22 @@
 #define TIME_H
 
 #include <string>
+#include <ctime>
+#include <cstdint>
 
 namespace Time
 {
 	// Returns the current date and time as a string.
 	extern std::string GetCurrentTimestamp();
 
-	// Returns the amount of seconds passed since startup of the application.
-	extern float GetSecondsSinceEpoch();
+	// Returns the given date and time (in seconds since the UNIX epoch) as a string, in the local time zone.
+	extern std::string FormatTimestamp(std::time_t time);
+
+	// Returns the amount of nanoseconds passed since startup of the application, measured by a monotonic clock.
+	extern uint64_t GetNanosecondsSinceEpoch();
+
+	// Returns the amount of seconds passed since startup of the application, measured by a monotonic clock.
+	extern double GetSecondsSinceEpoch();
 }
 
 #endif
@@ -0,0 +1,50 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Three copies of a value which let exactly one producer thread hand the latest copy to exactly one consumer thread without 
+// locks. The producer writes into its own back copy and publishes it by swapping it with the middle copy, the consumer then 
+// acquires the middle copy by swapping it with the front copy it reads from. Neither thread ever touches the copy the other
+// thread is using, so a copy can't be torn, and publishing never blocks (an unread copy is simply replaced).
+template<typename T>
+class TripleBuffer
+{
+private:
+	// The middle state holds the index of the middle copy, with this bit set if it was published and hasn't been acquired yet
+	static constexpr uint32_t pendingBit = 0x4;
+	static constexpr uint32_t indexMask = 0x3;
+
+	T m_values[3];
+	uint32_t m_backIndex, m_frontIndex; // Only accessed by the producer and consumer thread respectively
+	alignas(64) std::atomic<uint32_t> m_middleState;
+public:
+	TripleBuffer();
+	TripleBuffer(const TripleBuffer& other) = delete;
+
+	~TripleBuffer() = default;
+
+	TripleBuffer& operator=(const TripleBuffer& other) = delete;
+
+	// Returns the copy the producer is writing into, this must only be called by the producer thread.
+	T& GetBack();
+
+	// Hands the back copy over to the consumer, this must only be called by the producer thread.
+	// If the consumer hasn't acquired the previously published copy yet, it's replaced and becomes the new back copy.
+	void Publish();
+
+	// Returns TRUE if a published copy is waiting to be acquired by the consumer.
+	bool IsPending() const;
+
+	// Takes the most recently published copy as the front copy, this must only be called by the consumer thread.
+	// Returns FALSE, leaving the front copy as it was, if nothing new has been published since the last call.
+	bool Acquire();
+
+	// Returns the copy the consumer is reading from, this must only be called by the consumer thread.
+	const T& GetFront() const;
+};
+
+#include <util/triple_buffer.tpp>
+
+#endif
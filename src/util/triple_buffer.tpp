@@ -0,0 +1,43 @@
+template<typename T>
+TripleBuffer<T>::TripleBuffer() :
+    m_backIndex(0), m_frontIndex(1), m_middleState(2)
+{}
+
+template<typename T>
+T& TripleBuffer<T>::GetBack()
+{
+    return m_values[m_backIndex];
+}
+
+template<typename T>
+void TripleBuffer<T>::Publish()
+{
+    // The release makes the writes to the back copy visible to the consumer, the acquire does the same for the consumer's reads 
+    // of the copy being taken back, so the producer can't overwrite it while it's still being read
+    const uint32_t previousState = m_middleState.exchange(m_backIndex | TripleBuffer::pendingBit, std::memory_order_acq_rel);
+    m_backIndex = previousState & TripleBuffer::indexMask;
+}
+
+template<typename T>
+bool TripleBuffer<T>::IsPending() const
+{
+    return (m_middleState.load(std::memory_order_acquire) & TripleBuffer::pendingBit) != 0;
+}
+
+template<typename T>
+bool TripleBuffer<T>::Acquire()
+{
+    if (!this->IsPending())
+        return false;
+
+    const uint32_t previousState = m_middleState.exchange(m_frontIndex, std::memory_order_acq_rel);
+    m_frontIndex = previousState & TripleBuffer::indexMask;
+
+    return true;
+}
+
+template<typename T>
+const T& TripleBuffer<T>::GetFront() const
+{
+    return m_values[m_frontIndex];
+}
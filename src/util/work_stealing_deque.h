@@ -0,0 +1,48 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// A fixed capacity Chase-Lev work-stealing deque of pointers.
+// The thread which owns the deque pushes and pops at the bottom (last in, first out) without contention, while any other 
+// thread can steal from the top (first in, first out). Only the owner and thieves competing for the last element ever contend.
+// Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen and Zappa Nardelli, 2013).
+template<typename T>
+class WorkStealingDeque
+{
+private:
+	std::unique_ptr<std::atomic<T*>[]> m_elements;
+	int64_t m_mask;
+
+	alignas(64) std::atomic<int64_t> m_top; // Where elements are stolen from
+	alignas(64) std::atomic<int64_t> m_bottom; // Where the owner pushes and pops elements
+public:
+	explicit WorkStealingDeque(size_t capacity);
+	WorkStealingDeque(const WorkStealingDeque& other) = delete;
+
+	~WorkStealingDeque() = default;
+
+	WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+
+	// Adds the element to the bottom of the deque, this must only be called by the owner thread.
+	// Returns FALSE, without adding the element, if the deque is full.
+	bool Push(T* element);
+
+	// Removes and returns the element at the bottom of the deque, this must only be called by the owner thread.
+	// Returns nullptr if the deque is empty.
+	T* Pop();
+
+	// Removes and returns the element at the top of the deque, this can be called by any thread.
+	// Returns nullptr if the deque is empty or another thread took the element first.
+	T* Steal();
+
+	// Returns TRUE if the deque appears to be empty, the result is only approximate if other threads are using the deque.
+	bool IsEmpty() const;
+};
+
+#include <util/work_stealing_deque.tpp>
+
+#endif
@@ -0,0 +1,78 @@
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t capacity) :
+    m_top(0), m_bottom(0)
+{
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity)
+        roundedCapacity *= 2;
+
+    m_elements = std::make_unique<std::atomic<T*>[]>(roundedCapacity);
+    m_mask = (int64_t)roundedCapacity - 1;
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::Push(T* element)
+{
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const int64_t top = m_top.load(std::memory_order_acquire);
+
+    if (bottom - top > m_mask)
+        return false;
+
+    m_elements[bottom & m_mask].store(element, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // The element must be visible before thieves can see the new bottom
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+template<typename T>
+T* WorkStealingDeque<T>::Pop()
+{
+    // Reserve the bottom element before checking whether any thieves have taken it
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom) // The deque was empty
+    {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    T* element = m_elements[bottom & m_mask].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // This is the last element, so race any thieves for it by advancing the top
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            element = nullptr;
+
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return element;
+}
+
+template<typename T>
+T* WorkStealingDeque<T>::Steal()
+{
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom)
+        return nullptr;
+
+    T* element = m_elements[top & m_mask].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr; // Lost the race to the owner or another thief
+
+    return element;
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::IsEmpty() const
+{
+    return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed);
+}
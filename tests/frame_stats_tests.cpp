@@ -0,0 +1,35 @@
+#include <test_registry.h>
+
+#include <util/frame_stats.h>
+
+TEST_CASE(FrameStatsAttributesRenderTimeToThePacketsFrame)
+{
+    FrameStats& frameStats = FrameStats::GetInstance();
+    frameStats.SetFrameBudget(0.001);
+
+    const uint64_t renderHitchCount = frameStats.GetHitchCount(FrameStats::Subsystem::RENDER);
+    const uint64_t frameNumber = frameStats.GetFrameCount();
+
+    // The first frame goes over budget, but its packet is only rendered once the simulation has moved on to the next frame
+    frameStats.RecordSubsystemTime(FrameStats::Subsystem::SIMULATION, 1000000);
+    frameStats.SetFrameIndex(100);
+    frameStats.EndFrame(4000000);
+
+    frameStats.RecordSubsystemTime(FrameStats::Subsystem::RENDER, 3000000, 100);
+    frameStats.RecordSubsystemTime(FrameStats::Subsystem::SIMULATION, 2000000);
+    frameStats.SetFrameIndex(101);
+    frameStats.EndFrame(500000);
+
+    // Nothing is attributed until the render thread is done with the frame
+    TEST_CHECK(frameStats.GetHitchCount(FrameStats::Subsystem::RENDER) == renderHitchCount);
+
+    frameStats.EndFrame(500000);
+    frameStats.EndFrame(500000);
+
+    const std::vector<FrameStats::Hitch> hitches = frameStats.GetRecentHitches();
+    TEST_CHECK(!hitches.empty());
+    TEST_CHECK(hitches.back().m_frameIndex == frameNumber);
+    TEST_CHECK(hitches.back().m_subsystem == FrameStats::Subsystem::RENDER);
+    TEST_CHECK(hitches.back().m_subsystemNanoseconds[(size_t)FrameStats::Subsystem::SIMULATION] == 1000000);
+    TEST_CHECK(frameStats.GetHitchCount(FrameStats::Subsystem::RENDER) == renderHitchCount + 1);
+}
@@ -0,0 +1,126 @@
+#include <test_registry.h>
+
+#include <core/job_system.h>
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+
+namespace JobSystemTestParams
+{
+    // The number of jobs in each dependency chain, each depending on the one before it.
+    constexpr uint32_t chainLength = 64;
+
+    // The number of worker threads used by the tests with workers.
+    constexpr uint32_t workerCount = 3;
+}
+
+// Submits a chain of jobs in which each job depends on the one submitted before it. The first job doesn't finish until the whole
+// chain has been submitted, so every other job is submitted while its dependency is still incomplete. Each job records its 
+// position in the chain in the order the jobs ran.
+static void RunDependencyChain(uint32_t workerCount)
+{
+    JobSystem& jobSystem = JobSystem::GetInstance();
+    jobSystem.Shutdown();
+    jobSystem.Init(workerCount);
+
+    std::vector<JobCounter> counters(JobSystemTestParams::chainLength);
+    std::vector<uint32_t> runOrder(JobSystemTestParams::chainLength, UINT32_MAX);
+    std::atomic<uint32_t> runCount(0);
+    std::atomic<bool> chainSubmitted(false);
+
+    jobSystem.Submit([&runOrder, &runCount, &chainSubmitted]()
+    {
+        while (!chainSubmitted.load())
+            std::this_thread::yield();
+
+        runOrder[runCount.fetch_add(1)] = 0;
+    }, &counters[0]);
+
+    for (uint32_t link = 1; link < JobSystemTestParams::chainLength; link++)
+    {
+        jobSystem.Submit([&runOrder, &runCount, link]() { runOrder[runCount.fetch_add(1)] = link; }, &counters[link], 
+            &counters[link - 1]);
+    }
+
+    chainSubmitted.store(true);
+    jobSystem.Wait(counters.back());
+    jobSystem.Shutdown();
+
+    // The chain is serialized by its dependencies, so the order is fixed however many threads run it
+    TEST_CHECK(runCount.load() == JobSystemTestParams::chainLength);
+    for (uint32_t link = 0; link < JobSystemTestParams::chainLength; link++)
+        TEST_CHECK(runOrder[link] == link);
+}
+
+TEST_CASE(JobSystemRunsDependencyChainWithoutWorkers)
+{
+    RunDependencyChain(0);
+}
+
+TEST_CASE(JobSystemRunsDependencyChainWithWorkers)
+{
+    RunDependencyChain(JobSystemTestParams::workerCount);
+}
+
+TEST_CASE(JobSystemRunsDependentJobsAfterAllTheirDependencies)
+{
+    JobSystem& jobSystem = JobSystem::GetInstance();
+    jobSystem.Shutdown();
+    jobSystem.Init(JobSystemTestParams::workerCount);
+
+    // Many jobs fan out from a dependency made up of many jobs, every dependent job must see all of them finished. The
+    // dependency's jobs are held back until the dependent jobs have been submitted, so that they're all parked
+    constexpr uint32_t jobCount = 1000;
+    std::atomic<uint32_t> finishedCount(0), earlyCount(0);
+    std::atomic<bool> dependentsSubmitted(false);
+    JobCounter dependency, dependents;
+
+    for (uint32_t index = 0; index < jobCount; index++)
+    {
+        jobSystem.Submit([&finishedCount, &dependentsSubmitted]()
+        {
+            while (!dependentsSubmitted.load())
+                std::this_thread::yield();
+
+            finishedCount.fetch_add(1);
+        }, &dependency);
+    }
+
+    for (uint32_t index = 0; index < jobCount; index++)
+    {
+        jobSystem.Submit([&finishedCount, &earlyCount]()
+        {
+            if (finishedCount.load() != jobCount)
+                earlyCount.fetch_add(1);
+        }, &dependents, &dependency);
+    }
+
+    dependentsSubmitted.store(true);
+    jobSystem.Wait(dependents);
+    jobSystem.Shutdown();
+
+    TEST_CHECK(finishedCount.load() == jobCount);
+    TEST_CHECK(earlyCount.load() == 0);
+}
+
+TEST_CASE(JobSystemFinishesJobsWhichThrow)
+{
+    JobSystem& jobSystem = JobSystem::GetInstance();
+    jobSystem.Shutdown();
+    jobSystem.Init(JobSystemTestParams::workerCount);
+
+    // The exception is logged by the job system, the job's counter must still complete so that its dependents run
+    std::atomic<bool> dependentRan(false);
+    JobCounter dependency, dependent;
+
+    jobSystem.Submit([]() { throw std::runtime_error("Test exception thrown by a job."); }, &dependency);
+    jobSystem.Submit([&dependentRan]() { dependentRan.store(true); }, &dependent, &dependency);
+
+    jobSystem.Wait(dependent);
+    jobSystem.Shutdown();
+
+    TEST_CHECK(dependency.IsComplete());
+    TEST_CHECK(dependentRan.load());
+}
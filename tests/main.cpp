@@ -0,0 +1,14 @@
+#include <test_registry.h>
+
+#include <util/logging_system.h>
+#include <util/profiler.h>
+
+int main()
+{
+	Profiler::GetInstance().SetThreadName("Main");
+
+	const uint32_t failedCount = TestRegistry::GetInstance().RunAll();
+	LoggingSystem::GetInstance().Flush();
+
+	return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,46 @@
+#include <test_registry.h>
+
+#include <util/logging_system.h>
+#include <util/time.h>
+
+#include <exception>
+
+bool TestRegistry::Register(const char* name, TestFunction function)
+{
+    m_tests.push_back({ name, function });
+    return true;
+}
+
+uint32_t TestRegistry::RunAll() const
+{
+    uint32_t failedCount = 0;
+    for (const TestCase& test : m_tests)
+    {
+        const double startSeconds = Time::GetSecondsSinceEpoch();
+        try
+        {
+            test.m_function();
+            LOG_INFO("Passed %s (%.1f ms).", test.m_name, (Time::GetSecondsSinceEpoch() - startSeconds) * 1000.0);
+        }
+        catch (FormattedException& e)
+        {
+            LOG_WARNING("Failed %s:", test.m_name);
+            LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::WARNING, e.GetArgs());
+            ++failedCount;
+        }
+        catch (std::exception& e)
+        {
+            LOG_WARNING("Failed %s: %s", test.m_name, e.what());
+            ++failedCount;
+        }
+    }
+
+    LOG_INFO("%zu of %zu tests passed.", m_tests.size() - failedCount, m_tests.size());
+    return failedCount;
+}
+
+TestRegistry& TestRegistry::GetInstance()
+{
+    static TestRegistry instance;
+    return instance;
+}
@@ -0,0 +1,52 @@
+#ifndef TEST_REGISTRY_H
+#define TEST_REGISTRY_H
+
+#include <util/formatted_exception.h>
+
+#include <vector>
+#include <cstdint>
+
+// Holds every test linked into the test runner. Tests register themselves before main() is entered, using the TEST_CASE macro.
+class TestRegistry
+{
+public:
+	using TestFunction = void(*)();
+private:
+	struct TestCase
+	{
+		const char* m_name;
+		TestFunction m_function;
+	};
+
+	std::vector<TestCase> m_tests;
+
+	TestRegistry() = default;
+public:
+	~TestRegistry() = default;
+
+	// Adds the test to the registry, returning TRUE so that it can be used to initialize a static variable.
+	bool Register(const char* name, TestFunction function);
+
+	// Runs every registered test, logging the ones which fail.
+	// Returns the number of tests which failed.
+	uint32_t RunAll() const;
+
+	// Returns singleton instance of the class.
+	static TestRegistry& GetInstance();
+};
+
+// Defines a test function and registers it with the test registry.
+#define TEST_CASE(name) \
+	static void name(); \
+	static const bool name##Registered = TestRegistry::GetInstance().Register(#name, name); \
+	static void name()
+
+// Fails the running test if the condition is FALSE. This must only be used on the thread running the test.
+#define TEST_CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+			throw FormattedException("Check failed at %s:%d: %s", __FILE__, __LINE__, #condition); \
+	} while (false)
+
+#endif
@@ -0,0 +1,143 @@
+#include <test_registry.h>
+
+#include <graphics/frame_packet.h>
+#include <util/triple_buffer.h>
+
+#include <atomic>
+#include <thread>
+
+namespace TripleBufferTestParams
+{
+    // The number of packets the producer publishes.
+    constexpr uint64_t packetCount = 200000;
+
+    // The draw command count of each packet cycles up to this many, so the vectors regrow and shrink as packets are reused.
+    constexpr uint64_t maxDrawCommandCount = 37;
+}
+
+// Returns the value of a field of the given draw command in the packet with the given frame index, which is exactly
+// representable as a float.
+static float GetPacketValue(uint64_t frameIndex, uint64_t commandIndex, uint32_t field)
+{
+    return (float)(((frameIndex * TripleBufferTestParams::maxDrawCommandCount + commandIndex) * 4 + field) % (1u << 24));
+}
+
+// Fills the packet with a payload derived entirely from the frame index, the way the simulation thread records a frame.
+static void WritePacket(FramePacket& packet, uint64_t frameIndex)
+{
+    packet.m_frameIndex = frameIndex;
+    packet.m_camera.SetPosition({ GetPacketValue(frameIndex, 0, 0), GetPacketValue(frameIndex, 0, 1), 0.0f });
+    packet.m_clearColor = glm::vec4(GetPacketValue(frameIndex, 0, 2));
+    packet.m_drawCommands.clear();
+
+    const uint64_t commandCount = frameIndex % TripleBufferTestParams::maxDrawCommandCount + 1;
+    for (uint64_t commandIndex = 0; commandIndex < commandCount; commandIndex++)
+    {
+        DrawCommand command = {};
+        command.m_modelMatrix = glm::mat4(GetPacketValue(frameIndex, commandIndex, 0));
+        command.m_diffuseColor = glm::vec4(GetPacketValue(frameIndex, commandIndex, 1));
+        command.m_localBounds = { glm::vec3(-GetPacketValue(frameIndex, commandIndex, 2)),
+            glm::vec3(GetPacketValue(frameIndex, commandIndex, 2)) };
+
+        command.m_geometryData.m_allocation.m_firstIndex = (uint32_t)(frameIndex + commandIndex);
+        command.m_diffuseLayer = (uint32_t)commandIndex;
+        command.m_count = (uint32_t)(frameIndex ^ commandIndex);
+        command.m_shaderFeatures = (uint32_t)(frameIndex & 0x7);
+
+        packet.m_drawCommands.push_back(command);
+    }
+}
+
+// Returns TRUE if every field of the packet matches the payload written for its frame index.
+static bool IsPacketIntact(const FramePacket& packet)
+{
+    const uint64_t frameIndex = packet.m_frameIndex;
+    if (packet.m_camera.GetPosition() != glm::vec3(GetPacketValue(frameIndex, 0, 0), GetPacketValue(frameIndex, 0, 1), 0.0f) ||
+        packet.m_clearColor != glm::vec4(GetPacketValue(frameIndex, 0, 2)) ||
+        packet.m_drawCommands.size() != frameIndex % TripleBufferTestParams::maxDrawCommandCount + 1)
+    {
+        return false;
+    }
+
+    for (uint64_t commandIndex = 0; commandIndex < packet.m_drawCommands.size(); commandIndex++)
+    {
+        const DrawCommand& command = packet.m_drawCommands[commandIndex];
+        if (command.m_modelMatrix != glm::mat4(GetPacketValue(frameIndex, commandIndex, 0)) ||
+            command.m_diffuseColor != glm::vec4(GetPacketValue(frameIndex, commandIndex, 1)) ||
+            command.m_localBounds.m_min != glm::vec3(-GetPacketValue(frameIndex, commandIndex, 2)) ||
+            command.m_localBounds.m_max != glm::vec3(GetPacketValue(frameIndex, commandIndex, 2)) ||
+            command.m_geometryData.m_allocation.m_firstIndex != (uint32_t)(frameIndex + commandIndex) ||
+            command.m_diffuseLayer != (uint32_t)commandIndex || command.m_count != (uint32_t)(frameIndex ^ commandIndex) ||
+            command.m_shaderFeatures != (uint32_t)(frameIndex & 0x7))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Publishes packets from one thread while another acquires and checks them, with the producer either waiting for each packet
+// to be taken (as the render thread's simulation side does) or replacing packets which haven't been taken yet.
+static void StressFramePackets(bool waitForConsumer)
+{
+    TripleBuffer<FramePacket> packets;
+    std::atomic<uint64_t> tornCount(0), outOfOrderCount(0), acquiredCount(0);
+
+    std::thread consumerThread([&]()
+    {
+        uint64_t previousFrameIndex = 0;
+        while (previousFrameIndex < TripleBufferTestParams::packetCount)
+        {
+            if (!packets.Acquire())
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Check the packet twice, the second time after giving the producer a chance to write into it if it could
+            const FramePacket& packet = packets.GetFront();
+            const bool intact = IsPacketIntact(packet);
+            std::this_thread::yield();
+
+            if (!intact || !IsPacketIntact(packet))
+                tornCount.fetch_add(1);
+
+            if (packet.m_frameIndex <= previousFrameIndex)
+                outOfOrderCount.fetch_add(1);
+
+            previousFrameIndex = packet.m_frameIndex;
+            acquiredCount.fetch_add(1);
+        }
+    });
+
+    for (uint64_t frameIndex = 1; frameIndex <= TripleBufferTestParams::packetCount; frameIndex++)
+    {
+        WritePacket(packets.GetBack(), frameIndex);
+
+        while (waitForConsumer && packets.IsPending())
+            std::this_thread::yield();
+
+        packets.Publish();
+    }
+
+    consumerThread.join();
+
+    TEST_CHECK(tornCount.load() == 0);
+    TEST_CHECK(outOfOrderCount.load() == 0);
+    TEST_CHECK(acquiredCount.load() > 0);
+
+    // Every packet reaches the consumer when the producer waits for it, otherwise only the latest is guaranteed to
+    if (waitForConsumer)
+        TEST_CHECK(acquiredCount.load() == TripleBufferTestParams::packetCount);
+}
+
+TEST_CASE(TripleBufferHandsOverWholePacketsInOrder)
+{
+    StressFramePackets(true);
+}
+
+TEST_CASE(TripleBufferReplacesUnreadPacketsWithoutTearing)
+{
+    StressFramePackets(false);
+}
@@ -0,0 +1,212 @@
+// Builds an asset pack (.mpak) from individual asset files.
+// Usage: motorway-pack <output.mpak> [--compress] <files or directories...>
+// Each file is stored under its path as given on the command line (directories are searched recursively), which must match the
+// path the game loads it with, so the tool should be run from the game's working directory.
+#include <util/asset_pack.h>
+#include <util/formatted_exception.h>
+#include <util/logging_system.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace PackParams
+{
+	// Files are only stored compressed if that saves at least this fraction of their size, since compressed files have to be
+	// decompressed into memory rather than read in place.
+	constexpr double minimumCompressionSaving = 0.1;
+
+	// The zlib compression level, between 0 and 9.
+	constexpr int compressionQuality = 8;
+}
+
+// A file to be stored in the pack.
+struct PackedFile
+{
+	std::string m_path; // The normalized path the file is stored under
+	std::string m_sourceFilePath;
+	AssetPack::Entry m_entry;
+};
+
+// Returns the contents of the file at the given path.
+static std::vector<uint8_t> ReadFile(const std::string& filePath)
+{
+	FILE* file = std::fopen(filePath.c_str(), "rb");
+	if (!file)
+		throw FormattedException("Failed to open the file at path: %s.", filePath.c_str());
+
+	std::vector<uint8_t> contents;
+	std::fseek(file, 0, SEEK_END);
+	const long fileSize = std::ftell(file);
+	std::fseek(file, 0, SEEK_SET);
+
+	if (fileSize > 0)
+	{
+		contents.resize((size_t)fileSize);
+		contents.resize(std::fread(contents.data(), 1, contents.size(), file));
+	}
+
+	std::fclose(file);
+	return contents;
+}
+
+// Writes zeros to the file until its size is a multiple of the alignment.
+static void PadFile(FILE* file, uint64_t& fileOffset, uint64_t alignment)
+{
+	const uint8_t padding[16] = {};
+	while (fileOffset % alignment != 0)
+	{
+		const size_t paddingSize = (size_t)std::min<uint64_t>(alignment - fileOffset % alignment, sizeof(padding));
+		std::fwrite(padding, 1, paddingSize, file);
+		fileOffset += paddingSize;
+	}
+}
+
+// Builds the asset pack at the output path from the files and directories given.
+static void BuildPack(const std::string& outputFilePath, const std::vector<std::string>& inputPaths, bool compress)
+{
+	// Gather the files, searching through any directories given
+	std::vector<PackedFile> files;
+	for (const std::string& inputPath : inputPaths)
+	{
+		if (std::filesystem::is_directory(inputPath))
+		{
+			for (const auto& directoryEntry : std::filesystem::recursive_directory_iterator(inputPath))
+			{
+				if (directoryEntry.is_regular_file())
+					files.push_back({ AssetPack::NormalizePath(directoryEntry.path().generic_string()), directoryEntry.path().string() });
+			}
+		}
+		else
+			files.push_back({ AssetPack::NormalizePath(inputPath), inputPath });
+	}
+
+	for (PackedFile& file : files)
+	{
+		file.m_entry = {};
+		file.m_entry.m_pathHash = AssetPack::HashPath(file.m_path);
+	}
+
+	// The table of contents is sorted by the path hashes, which also makes any files given twice (or colliding hashes) adjacent
+	std::sort(files.begin(), files.end(), [](const PackedFile& lhs, const PackedFile& rhs)
+		{ return lhs.m_entry.m_pathHash < rhs.m_entry.m_pathHash; });
+
+	for (size_t fileIndex = 1; fileIndex < files.size(); fileIndex++)
+	{
+		if (files[fileIndex].m_entry.m_pathHash == files[fileIndex - 1].m_entry.m_pathHash)
+		{
+			throw FormattedException("The files \"%s\" and \"%s\" are the same or have the same path hash.",
+				files[fileIndex - 1].m_path.c_str(), files[fileIndex].m_path.c_str());
+		}
+	}
+
+	FILE* packFile = std::fopen(outputFilePath.c_str(), "wb");
+	if (!packFile)
+		throw FormattedException("Failed to create the asset pack file at path: %s.", outputFilePath.c_str());
+
+	// Leave space for the header, which is written once the location of the table of contents is known
+	AssetPack::Header header = {};
+	std::fwrite(&header, sizeof(header), 1, packFile);
+	uint64_t fileOffset = sizeof(header);
+
+	uint64_t totalSize = 0, totalStoredSize = 0;
+	for (PackedFile& file : files)
+	{
+		std::vector<uint8_t> contents = ReadFile(file.m_sourceFilePath);
+		file.m_entry.m_uncompressedSize = contents.size();
+		file.m_entry.m_compression = AssetPack::Compression::NONE;
+
+		if (compress && !contents.empty())
+		{
+			int compressedSize = 0;
+			uint8_t* compressedData = stbi_zlib_compress(contents.data(), (int)contents.size(), &compressedSize,
+				PackParams::compressionQuality);
+
+			if (compressedData && compressedSize < contents.size() * (1.0 - PackParams::minimumCompressionSaving))
+			{
+				contents.assign(compressedData, compressedData + compressedSize);
+				file.m_entry.m_compression = AssetPack::Compression::ZLIB;
+			}
+
+			STBIW_FREE(compressedData);
+		}
+
+		PadFile(packFile, fileOffset, AssetPack::dataAlignment);
+		file.m_entry.m_offset = fileOffset;
+		file.m_entry.m_size = contents.size();
+
+		if (std::fwrite(contents.data(), 1, contents.size(), packFile) != contents.size())
+		{
+			std::fclose(packFile);
+			throw FormattedException("Failed to write to the asset pack file at path: %s.", outputFilePath.c_str());
+		}
+
+		fileOffset += contents.size();
+		totalSize += file.m_entry.m_uncompressedSize;
+		totalStoredSize += file.m_entry.m_size;
+
+		LOG_INFO("Packed %s (%llu -> %llu bytes).", file.m_path.c_str(), (unsigned long long)file.m_entry.m_uncompressedSize,
+			(unsigned long long)file.m_entry.m_size);
+	}
+
+	// Write the table of contents, then go back and fill in the header
+	PadFile(packFile, fileOffset, alignof(AssetPack::Entry));
+	header.m_tableOffset = fileOffset;
+	header.m_entryCount = files.size();
+	std::memcpy(header.m_magic, AssetPack::fileMagic, sizeof(header.m_magic));
+	header.m_version = AssetPack::fileVersion;
+
+	for (const PackedFile& file : files)
+		std::fwrite(&file.m_entry, sizeof(file.m_entry), 1, packFile);
+
+	std::fseek(packFile, 0, SEEK_SET);
+	std::fwrite(&header, sizeof(header), 1, packFile);
+
+	if (std::fclose(packFile) != 0)
+		throw FormattedException("Failed to write to the asset pack file at path: %s.", outputFilePath.c_str());
+
+	LOG_INFO("Wrote %zu files to %s (%llu -> %llu bytes).", files.size(), outputFilePath.c_str(), (unsigned long long)totalSize,
+		(unsigned long long)totalStoredSize);
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		if (argc < 3)
+			throw FormattedException("Usage: motorway-pack <output.mpak> [--compress] <files or directories...>");
+
+		bool compress = false;
+		std::vector<std::string> inputPaths;
+
+		for (int argIndex = 2; argIndex < argc; argIndex++)
+		{
+			if (std::strcmp(argv[argIndex], "--compress") == 0)
+				compress = true;
+			else
+				inputPaths.push_back(argv[argIndex]);
+		}
+
+		BuildPack(argv[1], inputPaths, compress);
+	}
+	catch (std::exception& e)
+	{
+		FormattedException* formattedException = dynamic_cast<FormattedException*>(&e); // Check if the exception thrown is formatted
+
+		if (formattedException)
+			LoggingSystem::GetInstance().Output(formattedException->what(), LoggingSystem::Severity::FATAL, formattedException->GetArgs());
+		else
+			LoggingSystem::GetInstance().Output(e.what(), LoggingSystem::Severity::FATAL);
+
+		return EXIT_FAILURE;
+	}
+
+	LoggingSystem::GetInstance().Flush();
+	return EXIT_SUCCESS;
+}